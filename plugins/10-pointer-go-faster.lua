@@ -9,14 +9,16 @@
 libinput:connect("new-evdev-device", function(device)
     local usages = device:usages()
     if usages[evdev.REL_X] then
-        device:connect("evdev-frame", function(device, frame, timestamp)
-            for _, v in ipairs(frame) do
-                if v.usage == evdev.REL_X or v.usage == evdev.REL_Y then
+        -- The frame view changes the frame in-place, there is no need to
+        -- return it
+        device:connect("evdev-frame-view", function(device, frame, timestamp)
+            for i = 1, #frame do
+                local usage = frame:usage(i)
+                if usage == evdev.REL_X or usage == evdev.REL_Y then
                     -- Multiply the relative motion by 3
-                    v.value = v.value * 3
+                    frame:set_value(i, frame:value(i) * 3)
                 end
             end
-            return frame
         end)
     end
 end)
@@ -415,6 +415,80 @@ evdev_event_from_input_event(const struct input_event *e, uint64_t *time)
 	};
 }
 
+/* Bit offsets of each event type in struct evdev_usage_bitmap */
+#define EVDEV_USAGE_BITMAP_ABS 0
+#define EVDEV_USAGE_BITMAP_REL 64
+#define EVDEV_USAGE_BITMAP_SW 80
+#define EVDEV_USAGE_BITMAP_KEY 128
+#define EVDEV_USAGE_BITMAP_NBITS (EVDEV_USAGE_BITMAP_KEY + KEY_MAX + 1)
+#define EVDEV_USAGE_BITMAP_WORDS ((EVDEV_USAGE_BITMAP_NBITS + 63) / 64)
+
+static_assert(ABS_MAX < EVDEV_USAGE_BITMAP_REL, "usage bitmap overlap");
+static_assert(EVDEV_USAGE_BITMAP_REL + REL_MAX < EVDEV_USAGE_BITMAP_SW,
+	      "usage bitmap overlap");
+static_assert(EVDEV_USAGE_BITMAP_SW + SW_MAX < EVDEV_USAGE_BITMAP_KEY,
+	      "usage bitmap overlap");
+
+/**
+ * One bit for every EV_ABS, EV_REL, EV_SW and EV_KEY code. Frames and
+ * struct evdev_mask use the same layout, so checking whether a frame
+ * contains any usage of a mask is a word-wise AND instead of a lookup per
+ * event. Other event types are not tracked.
+ */
+struct evdev_usage_bitmap {
+	uint64_t words[EVDEV_USAGE_BITMAP_WORDS];
+};
+
+/* Returns the bit for the usage or -1 if the usage is not tracked */
+static inline int
+evdev_usage_bitmap_bit(evdev_usage_t usage)
+{
+	unsigned int code = evdev_usage_code(usage);
+
+	switch (evdev_usage_type(usage)) {
+	case EV_ABS:
+		return code <= ABS_MAX ? EVDEV_USAGE_BITMAP_ABS + (int)code : -1;
+	case EV_REL:
+		return code <= REL_MAX ? EVDEV_USAGE_BITMAP_REL + (int)code : -1;
+	case EV_SW:
+		return code <= SW_MAX ? EVDEV_USAGE_BITMAP_SW + (int)code : -1;
+	case EV_KEY:
+		return code <= KEY_MAX ? EVDEV_USAGE_BITMAP_KEY + (int)code : -1;
+	default:
+		return -1;
+	}
+}
+
+static inline void
+evdev_usage_bitmap_set(struct evdev_usage_bitmap *bitmap, evdev_usage_t usage)
+{
+	int bit = evdev_usage_bitmap_bit(usage);
+
+	if (bit >= 0)
+		bitmap->words[bit / 64] |= 1ULL << (bit % 64);
+}
+
+static inline bool
+evdev_usage_bitmap_is_set(const struct evdev_usage_bitmap *bitmap,
+			  evdev_usage_t usage)
+{
+	int bit = evdev_usage_bitmap_bit(usage);
+
+	return bit >= 0 && (bitmap->words[bit / 64] & (1ULL << (bit % 64)));
+}
+
+static inline bool
+evdev_usage_bitmap_intersects(const struct evdev_usage_bitmap *a,
+			      const struct evdev_usage_bitmap *b)
+{
+	uint64_t any = 0;
+
+	for (size_t i = 0; i < EVDEV_USAGE_BITMAP_WORDS; i++)
+		any |= a->words[i] & b->words[i];
+
+	return any != 0;
+}
+
 /**
  * A wrapper around a SYN_REPORT-terminated set of input events.
  *
@@ -433,6 +507,9 @@ struct evdev_frame {
 	size_t max_size;
 	size_t count;
 	uint64_t time;
+	uint64_t read_time; /* when read from the fd, for latency stats */
+	/* All usages in this frame, maintained by the append helpers */
+	struct evdev_usage_bitmap usages;
 	struct evdev_event events[];
 };
 
@@ -458,6 +535,15 @@ evdev_frame_unref(struct evdev_frame *frame)
 	return NULL;
 }
 
+/**
+ * True if anyone but the caller holds a reference to this frame.
+ */
+static inline bool
+evdev_frame_is_shared(const struct evdev_frame *frame)
+{
+	return frame->refcount > 1;
+}
+
 DEFINE_UNREF_CLEANUP_FUNC(evdev_frame);
 
 static inline bool
@@ -496,10 +582,30 @@ evdev_frame_get_time(const struct evdev_frame *frame)
 	return frame->time;
 }
 
+static inline void
+evdev_frame_set_read_time(struct evdev_frame *frame, uint64_t read_time)
+{
+	frame->read_time = read_time;
+}
+
+/**
+ * The CLOCK_MONOTONIC time in us when this frame was read from the
+ * device, or 0 if unknown. This is only set while latency stats are
+ * enabled.
+ */
+static inline uint64_t
+evdev_frame_get_read_time(const struct evdev_frame *frame)
+{
+	return frame->read_time;
+}
+
 static inline int
 evdev_frame_reset(struct evdev_frame *frame)
 {
-	memset(frame->events, 0, frame->max_size * sizeof(*frame->events));
+	/* Everything past count is still zero from the last reset */
+	memset(frame->events, 0, frame->count * sizeof(*frame->events));
+	if (frame->count > 1)
+		memset(&frame->usages, 0, sizeof(frame->usages));
 	frame->count = 1; /* SYN_REPORT is always there */
 
 	return 0;
@@ -518,6 +624,32 @@ evdev_frame_new(size_t max_size)
 	return frame;
 }
 
+/**
+ * Return *frame in the same state as a newly allocated frame, for
+ * callers that keep a scratch frame around instead of allocating one
+ * each time. If *frame is NULL, too small for max_size events or
+ * referenced elsewhere it is replaced with a new frame.
+ *
+ * The returned frame is owned by *frame, the caller must not unref it.
+ */
+static inline struct evdev_frame *
+evdev_frame_reuse(struct evdev_frame **frame, size_t max_size)
+{
+	struct evdev_frame *f = *frame;
+
+	if (f && f->refcount == 1 && f->max_size >= max_size) {
+		evdev_frame_reset(f);
+		f->time = 0;
+		f->read_time = 0;
+		return f;
+	}
+
+	evdev_frame_unref(f);
+	*frame = evdev_frame_new(max_size);
+
+	return *frame;
+}
+
 /**
  * Append events to the event frame. nevents must be larger than 0
  * and specifies the number of elements in events. If any events in
@@ -564,6 +696,9 @@ evdev_frame_append(struct evdev_frame *frame,
 		       events,
 		       nevents * sizeof(*events));
 		frame->count += nevents;
+
+		for (size_t i = 0; i < nevents; i++)
+			evdev_usage_bitmap_set(&frame->usages, events[i].usage);
 	}
 
 	return 0;
@@ -581,6 +716,7 @@ evdev_frame_append_one(struct evdev_frame *frame, evdev_usage_t usage, int32_t v
 	struct evdev_event *e = &frame->events[frame->count - 1];
 	*e = (struct evdev_event){ .usage = usage, .value = value };
 	frame->count++;
+	evdev_usage_bitmap_set(&frame->usages, usage);
 	return 0;
 }
 
@@ -635,6 +771,7 @@ evdev_frame_clone(struct evdev_frame *frame)
 
 	evdev_frame_append(clone, events, nevents);
 	evdev_frame_set_time(clone, evdev_frame_get_time(frame));
+	evdev_frame_set_read_time(clone, evdev_frame_get_read_time(frame));
 
 	return clone;
 }
@@ -646,6 +783,9 @@ struct evdev_mask {
 	infmask_t key; /* < BTN_MISC */
 	infmask_t btn; /* >= BTN_MISC */
 	infmask_t abs;
+
+	/* The same usages as above, for evdev_mask_matches_frame() */
+	struct evdev_usage_bitmap usages;
 };
 
 static_assert(sizeof(bitmask_t) * 8 >= EV_MAX, "bitmask size too small");
@@ -661,6 +801,7 @@ evdev_mask_reset(struct evdev_mask *mask)
 	infmask_reset(&mask->key);
 	infmask_reset(&mask->btn);
 	infmask_reset(&mask->abs);
+	memset(&mask->usages, 0, sizeof(mask->usages));
 }
 
 static inline struct evdev_mask *
@@ -692,6 +833,7 @@ evdev_mask_set_usage(struct evdev_mask *mask, evdev_usage_t usage)
 		return;
 
 	bitmask_set_bit(&mask->ev, type);
+	evdev_usage_bitmap_set(&mask->usages, usage);
 
 	switch (type) {
 	case EV_ABS:
@@ -756,3 +898,15 @@ evdev_mask_is_set(const struct evdev_mask *mask, evdev_usage_t usage)
 
 	return isset;
 }
+
+/**
+ * Returns true if the frame contains at least one usage set in the mask.
+ * This is equivalent to calling evdev_mask_is_set() for every event in
+ * the frame but does not depend on the number of events.
+ */
+static inline bool
+evdev_mask_matches_frame(const struct evdev_mask *mask,
+			 const struct evdev_frame *frame)
+{
+	return evdev_usage_bitmap_intersects(&mask->usages, &frame->usages);
+}
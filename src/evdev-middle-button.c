@@ -685,6 +685,7 @@ evdev_init_middlebutton(struct evdev_device *device, bool enable, bool want_conf
 			    timer_name,
 			    evdev_middlebutton_handle_timeout,
 			    device);
+	libinput_timer_set_slack(&device->middlebutton.timer, TIMER_SLACK_INTERACTIVE);
 	device->middlebutton.enabled_default = enable;
 	device->middlebutton.want_enabled = enable;
 	device->middlebutton.enabled = enable;
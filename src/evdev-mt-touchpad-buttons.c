@@ -123,13 +123,15 @@ is_inside_top_middle_area(const struct tp_dispatch *tp, const struct tp_touch *t
 static void
 tp_button_set_enter_timer(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
-	libinput_timer_set(&t->button.timer, time + DEFAULT_BUTTON_ENTER_TIMEOUT);
+	libinput_timer_set(&tp_touch_cold(t)->button.timer,
+			   time + DEFAULT_BUTTON_ENTER_TIMEOUT);
 }
 
 static void
 tp_button_set_leave_timer(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
-	libinput_timer_set(&t->button.timer, time + DEFAULT_BUTTON_LEAVE_TIMEOUT);
+	libinput_timer_set(&tp_touch_cold(t)->button.timer,
+			   time + DEFAULT_BUTTON_LEAVE_TIMEOUT);
 }
 
 /*
@@ -143,7 +145,7 @@ tp_button_set_state(struct tp_dispatch *tp,
 		    enum button_event event,
 		    uint64_t time)
 {
-	libinput_timer_cancel(&t->button.timer);
+	libinput_timer_cancel(&tp_touch_cold(t)->button.timer);
 
 	t->button.state = new_state;
 
@@ -500,6 +502,8 @@ tp_button_handle_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
 
+	/* Not a dirty-only loop: a physical click must reach touches that
+	 * did not change in this frame */
 	tp_for_each_touch(tp, t) {
 		if (t->state == TOUCH_NONE || t->state == TOUCH_HOVERING)
 			continue;
@@ -1012,7 +1016,7 @@ tp_init_buttons(struct tp_dispatch *tp, struct evdev_device *device)
 			 evdev_device_get_sysname(device),
 			 i);
 		t->button.state = BUTTON_STATE_NONE;
-		libinput_timer_init(&t->button.timer,
+		libinput_timer_init(&tp_touch_cold(t)->button.timer,
 				    tp_libinput_context(tp),
 				    timer_name,
 				    tp_button_handle_timeout,
@@ -1026,8 +1030,8 @@ tp_remove_buttons(struct tp_dispatch *tp)
 	struct tp_touch *t;
 
 	tp_for_each_touch(tp, t) {
-		libinput_timer_cancel(&t->button.timer);
-		libinput_timer_destroy(&t->button.timer);
+		libinput_timer_cancel(&tp_touch_cold(t)->button.timer);
+		libinput_timer_destroy(&tp_touch_cold(t)->button.timer);
 	}
 }
 
@@ -97,7 +97,8 @@ tp_edge_scroll_set_timer(struct tp_dispatch *tp, struct tp_touch *t, uint64_t ti
 	if (tp->buttons.click_method == LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS)
 		return;
 
-	libinput_timer_set(&t->scroll.timer, time + DEFAULT_SCROLL_LOCK_TIMEOUT);
+	libinput_timer_set(&tp_touch_cold(t)->scroll.timer,
+			   time + DEFAULT_SCROLL_LOCK_TIMEOUT);
 }
 
 static void
@@ -106,7 +107,7 @@ tp_edge_scroll_set_state(struct tp_dispatch *tp,
 			 enum tp_edge_scroll_touch_state state,
 			 uint64_t time)
 {
-	libinput_timer_cancel(&t->scroll.timer);
+	libinput_timer_cancel(&tp_touch_cold(t)->scroll.timer);
 
 	t->scroll.edge_state = state;
 
@@ -329,7 +330,7 @@ tp_edge_scroll_init(struct tp_dispatch *tp, struct evdev_device *device)
 			 evdev_device_get_sysname(device),
 			 i);
 		t->scroll.direction = -1;
-		libinput_timer_init(&t->scroll.timer,
+		libinput_timer_init(&tp_touch_cold(t)->scroll.timer,
 				    tp_libinput_context(tp),
 				    timer_name,
 				    tp_edge_scroll_handle_timeout,
@@ -343,8 +344,8 @@ tp_remove_edge_scroll(struct tp_dispatch *tp)
 	struct tp_touch *t;
 
 	tp_for_each_touch(tp, t) {
-		libinput_timer_cancel(&t->scroll.timer);
-		libinput_timer_destroy(&t->scroll.timer);
+		libinput_timer_cancel(&tp_touch_cold(t)->scroll.timer);
+		libinput_timer_destroy(&tp_touch_cold(t)->scroll.timer);
 	}
 }
 
@@ -363,10 +364,7 @@ tp_edge_scroll_handle_state(struct tp_dispatch *tp, uint64_t time)
 		return;
 	}
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		switch (t->state) {
 		case TOUCH_NONE:
 		case TOUCH_HOVERING:
@@ -404,10 +402,7 @@ tp_edge_scroll_post_events(struct tp_dispatch *tp, uint64_t time)
 	struct normalized_coords normalized, tmp;
 	const struct normalized_coords zero = { 0.0, 0.0 };
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		if (t->palm.state != PALM_NONE || tp_thumb_ignored(tp, t))
 			continue;
 
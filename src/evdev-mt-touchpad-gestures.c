@@ -209,6 +209,7 @@ tp_gesture_post_pointer_motion(struct tp_dispatch *tp, uint64_t time)
 
 	raw = tp_get_raw_pointer_motion(tp);
 	delta = tp_filter_motion(tp, &raw, time);
+	delta = tp_prediction_apply(tp, &delta, time);
 
 	if (!normalized_is_zero(delta) || !device_float_is_zero(raw)) {
 		struct device_float_coords unaccel;
@@ -2221,6 +2222,7 @@ tp_init_gesture(struct tp_dispatch *tp)
 			    timer_name,
 			    tp_gesture_hold_timeout,
 			    tp);
+	libinput_timer_set_slack(&tp->gesture.hold_timer, TIMER_SLACK_INTERACTIVE);
 	snprintf(timer_name,
 		 sizeof(timer_name),
 		 "%s drag_3fg",
@@ -0,0 +1,225 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include "evdev-mt-touchpad.h"
+
+/* alpha-beta filter gains. Alpha is how much of the residual between
+ * the predicted and the real position is applied to the position
+ * estimate, beta how much of it is applied to the velocity. These are
+ * roughly critically damped (beta = alpha²/(2 - alpha)) so the estimate
+ * settles without overshooting after a change of direction */
+#define PREDICTION_ALPHA 0.5
+#define PREDICTION_BETA 0.15
+
+/* We predict one report interval ahead, but never more than this */
+#define PREDICTION_MAX_LEAD ms2us(12)
+
+/* A gap larger than this between two motion events restarts the filter,
+ * the previous velocity is meaningless by then */
+#define PREDICTION_TIMEOUT ms2us(50)
+
+static inline void
+tp_prediction_reset(struct tp_dispatch *tp)
+{
+	const struct normalized_coords zero = { 0.0, 0.0 };
+
+	tp->prediction.active = false;
+	tp->prediction.position = zero;
+	tp->prediction.estimate = zero;
+	tp->prediction.velocity = zero;
+	tp->prediction.offset = zero;
+}
+
+/**
+ * Feed the accelerated pointer delta into the alpha-beta filter and
+ * return the delta to send instead. That delta moves the pointer to the
+ * filter's estimate of where the finger will be one report interval from
+ * now. Whatever was sent ahead in the previous event is taken back,
+ * so the sum of all deltas never drifts from the real motion by more
+ * than the current prediction.
+ */
+struct normalized_coords
+tp_prediction_apply(struct tp_dispatch *tp,
+		    const struct normalized_coords *delta,
+		    uint64_t time)
+{
+	struct normalized_coords offset = { 0.0, 0.0 };
+	struct normalized_coords result;
+	uint64_t tdelta = time - tp->prediction.time;
+
+	if (!tp->prediction.enabled && !tp->prediction.active)
+		return *delta;
+
+	tp->prediction.position.x += delta->x;
+	tp->prediction.position.y += delta->y;
+
+	if (!tp->prediction.active || tdelta == 0 || tdelta > PREDICTION_TIMEOUT) {
+		/* (Re)start: no velocity yet, so nothing to predict */
+		tp->prediction.estimate = tp->prediction.position;
+		tp->prediction.velocity.x = 0.0;
+		tp->prediction.velocity.y = 0.0;
+	} else {
+		struct normalized_coords predicted, residual;
+
+		predicted.x = tp->prediction.estimate.x +
+			      tp->prediction.velocity.x * tdelta;
+		predicted.y = tp->prediction.estimate.y +
+			      tp->prediction.velocity.y * tdelta;
+		residual.x = tp->prediction.position.x - predicted.x;
+		residual.y = tp->prediction.position.y - predicted.y;
+
+		tp->prediction.estimate.x = predicted.x + PREDICTION_ALPHA * residual.x;
+		tp->prediction.estimate.y = predicted.y + PREDICTION_ALPHA * residual.y;
+		tp->prediction.velocity.x += PREDICTION_BETA * residual.x / tdelta;
+		tp->prediction.velocity.y += PREDICTION_BETA * residual.y / tdelta;
+
+		if (tp->prediction.enabled) {
+			uint64_t lead = min(tdelta, PREDICTION_MAX_LEAD);
+
+			offset.x = tp->prediction.estimate.x +
+				   tp->prediction.velocity.x * lead -
+				   tp->prediction.position.x;
+			offset.y = tp->prediction.estimate.y +
+				   tp->prediction.velocity.y * lead -
+				   tp->prediction.position.y;
+		}
+	}
+
+	result.x = delta->x + offset.x - tp->prediction.offset.x;
+	result.y = delta->y + offset.y - tp->prediction.offset.y;
+
+	tp->prediction.offset = offset;
+	tp->prediction.time = time;
+	tp->prediction.active = tp->prediction.enabled;
+	tp->prediction.applied = true;
+
+	if (!tp->prediction.active)
+		tp_prediction_reset(tp);
+
+	return result;
+}
+
+/**
+ * Take back whatever was sent ahead of the real position and reset the
+ * filter. This sends a motion event with no unaccelerated delta if the
+ * pointer is currently ahead.
+ */
+void
+tp_prediction_cancel(struct tp_dispatch *tp, uint64_t time)
+{
+	if (!tp->prediction.active)
+		return;
+
+	if (!normalized_is_zero(tp->prediction.offset)) {
+		const struct device_float_coords zero = { 0.0, 0.0 };
+		struct normalized_coords delta = {
+			.x = -tp->prediction.offset.x,
+			.y = -tp->prediction.offset.y,
+		};
+
+		pointer_notify_motion(&tp->device->base, time, &delta, &zero);
+	}
+
+	tp_prediction_reset(tp);
+}
+
+void
+tp_prediction_begin_frame(struct tp_dispatch *tp, uint64_t time)
+{
+	const enum touchpad_event buttons =
+		TOUCHPAD_EVENT_BUTTON_PRESS | TOUCHPAD_EVENT_BUTTON_RELEASE;
+
+	tp->prediction.applied = false;
+
+	/* Buttons and taps must happen where the finger really is, and
+	 * without motion there is no next event to correct the
+	 * prediction with. */
+	if (!(tp->queued & TOUCHPAD_EVENT_MOTION) || tp->queued & buttons ||
+	    tp->nfingers_down != tp->old_nfingers_down)
+		tp_prediction_cancel(tp, time);
+}
+
+void
+tp_prediction_end_frame(struct tp_dispatch *tp, uint64_t time)
+{
+	/* Motion went to scrolling, gestures, or was ignored */
+	if (!tp->prediction.applied)
+		tp_prediction_cancel(tp, time);
+}
+
+static int
+tp_prediction_config_is_available(struct libinput_device *device)
+{
+	return 1;
+}
+
+static enum libinput_config_status
+tp_prediction_config_set(struct libinput_device *device,
+			 enum libinput_config_pointer_prediction_state enable)
+{
+	struct evdev_device *evdev = evdev_device(device);
+	struct tp_dispatch *tp = (struct tp_dispatch *)evdev->dispatch;
+
+	switch (enable) {
+	case LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED:
+	case LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED:
+		break;
+	default:
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+	}
+
+	tp->prediction.enabled = (enable == LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED);
+
+	return LIBINPUT_CONFIG_STATUS_SUCCESS;
+}
+
+static enum libinput_config_pointer_prediction_state
+tp_prediction_config_get(struct libinput_device *device)
+{
+	struct evdev_device *evdev = evdev_device(device);
+	struct tp_dispatch *tp = (struct tp_dispatch *)evdev->dispatch;
+
+	return tp->prediction.enabled ? LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED
+				      : LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED;
+}
+
+static enum libinput_config_pointer_prediction_state
+tp_prediction_config_get_default(struct libinput_device *device)
+{
+	return LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED;
+}
+
+void
+tp_init_prediction(struct tp_dispatch *tp, struct evdev_device *device)
+{
+	tp->prediction.enabled = false;
+	tp_prediction_reset(tp);
+
+	tp->prediction.config.is_available = tp_prediction_config_is_available;
+	tp->prediction.config.set_enabled = tp_prediction_config_set;
+	tp->prediction.config.get_enabled = tp_prediction_config_get;
+	tp->prediction.config.get_default_enabled = tp_prediction_config_get_default;
+	device->base.config.pointer_prediction = &tp->prediction.config;
+}
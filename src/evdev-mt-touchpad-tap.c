@@ -24,6 +24,7 @@
 #include "config.h"
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 
@@ -46,6 +47,9 @@ enum tap_event {
 	TAP_EVENT_PALM_UP,
 };
 
+static_assert(TAP_EVENT_PALM_UP - TAP_EVENT_TOUCH + 1 == TAP_EVENT_COUNT,
+	      "TAP_EVENT_COUNT out of sync with enum tap_event");
+
 /*****************************************
  * DO NOT EDIT THIS FILE!
  *
@@ -137,12 +141,19 @@ tp_tap_notify(struct tp_dispatch *tp,
 
 	tp_gesture_cancel(tp, time);
 
+	/* Tap buttons may come from a timeout, outside of a frame, so
+	 * the pointer must be taken back to where the finger really is
+	 * here */
+	tp_prediction_cancel(tp, time);
+
 	button = button_map[tp->tap.map][nfingers - 1];
 
-	if (state == LIBINPUT_BUTTON_STATE_PRESSED)
+	if (state == LIBINPUT_BUTTON_STATE_PRESSED) {
 		tp->tap.buttons_pressed |= bit(nfingers);
-	else
+		tp_libinput_context(tp)->touchpad.taps++;
+	} else {
 		tp->tap.buttons_pressed &= ~bit(nfingers);
+	}
 
 	evdev_pointer_notify_button(tp->device,
 				    time,
@@ -1066,6 +1077,8 @@ tp_tap_handle_event(struct tp_dispatch *tp,
 
 	current = tp->tap.state;
 
+	tp->tap.events[current - TAP_STATE_IDLE][event - TAP_EVENT_TOUCH]++;
+
 	switch (tp->tap.state) {
 	case TAP_STATE_IDLE:
 		tp_tap_idle_handle_event(tp, t, event, time);
@@ -1156,6 +1169,12 @@ tp_tap_handle_event(struct tp_dispatch *tp,
 		break;
 	}
 
+	struct libinput *libinput = tp_libinput_context(tp);
+	if (event == TAP_EVENT_TIMEOUT)
+		libinput->touchpad.tap_timeouts++;
+	if (tp->tap.state == TAP_STATE_DEAD && current != TAP_STATE_DEAD)
+		libinput->touchpad.tap_cancels++;
+
 	if (tp->tap.state == TAP_STATE_IDLE || tp->tap.state == TAP_STATE_DEAD)
 		tp_tap_clear_timer(tp);
 
@@ -1220,8 +1239,8 @@ tp_tap_handle_state(struct tp_dispatch *tp, uint64_t time)
 	if (tp->buttons.is_clickpad && tp->queued & TOUCHPAD_EVENT_BUTTON_PRESS)
 		tp_tap_handle_event(tp, NULL, TAP_EVENT_BUTTON, time);
 
-	tp_for_each_touch(tp, t) {
-		if (!t->dirty || t->state == TOUCH_NONE)
+	tp_for_each_dirty_touch(tp, t) {
+		if (t->state == TOUCH_NONE)
 			continue;
 
 		if (tp->buttons.is_clickpad && tp->queued & TOUCHPAD_EVENT_BUTTON_PRESS)
@@ -1590,12 +1609,28 @@ tp_init_tap(struct tp_dispatch *tp)
 			    timer_name,
 			    tp_tap_handle_timeout,
 			    tp);
+	libinput_timer_set_slack(&tp->tap.timer, TIMER_SLACK_INTERACTIVE);
 }
 
 void
 tp_remove_tap(struct tp_dispatch *tp)
 {
 	libinput_timer_cancel(&tp->tap.timer);
+
+	for (size_t s = 0; s < TAP_STATE_COUNT; s++) {
+		for (size_t e = 0; e < TAP_EVENT_COUNT; e++) {
+			uint64_t count = tp->tap.events[s][e];
+
+			if (count == 0)
+				continue;
+
+			evdev_log_debug(tp->device,
+					"tap: %" PRIu64 " %s events in %s\n",
+					count,
+					tap_event_to_str(e + TAP_EVENT_TOUCH),
+					tap_state_to_str(s + TAP_STATE_IDLE));
+		}
+	}
 }
 
 void
@@ -43,6 +43,9 @@
 #define DEFAULT_KEYBOARD_ACTIVITY_TIMEOUT_1 ms2us(200)
 #define DEFAULT_KEYBOARD_ACTIVITY_TIMEOUT_2 ms2us(500)
 #define FAKE_FINGER_OVERFLOW bit(7)
+/* Compared against the fitted speed. At a constant speed the fit is
+ * the speed between any two events, an accelerating finger crosses
+ * the threshold about half a history length later */
 #define THUMB_IGNORE_SPEED_THRESHOLD 20 /* mm/s */
 
 enum notify {
@@ -53,12 +56,79 @@ enum notify {
 static inline struct tp_history_point *
 tp_motion_history_offset(struct tp_touch *t, int offset)
 {
-	int offset_index = (t->history.index - offset + TOUCHPAD_HISTORY_LENGTH) %
-			   TOUCHPAD_HISTORY_LENGTH;
+	unsigned int length = t->tp->history_length;
+	unsigned int offset_index = (t->history.index + length - offset) % length;
 
 	return &t->history.samples[offset_index];
 }
 
+static inline void
+tp_velocity_fit_add(struct tp_velocity_fit *fit,
+		    const struct tp_history_point *p,
+		    double weight)
+{
+	/* Signed so timestamps rewritten into the past still work */
+	double t = (int64_t)(p->time - fit->base_time) / 1000000.0;
+
+	fit->st += weight * t;
+	fit->stt += weight * t * t;
+	fit->sx += weight * p->point.x;
+	fit->sy += weight * p->point.y;
+	fit->stx += weight * t * p->point.x;
+	fit->sty += weight * t * p->point.y;
+}
+
+/* Recalculate the fit from scratch, relative to the oldest sample.
+ * Needed whenever the history timestamps are rewritten and
+ * occasionally to keep the times small enough to not lose precision
+ * in the running sums */
+static inline void
+tp_velocity_fit_rebuild(struct tp_touch *t)
+{
+	struct tp_velocity_fit *fit = &t->history.fit;
+
+	if (t->history.count == 0)
+		return;
+
+	*fit = (struct tp_velocity_fit){
+		.base_time = tp_motion_history_offset(t, t->history.count - 1)->time,
+	};
+
+	for (unsigned int i = 0; i < t->history.count; i++)
+		tp_velocity_fit_add(fit, tp_motion_history_offset(t, i), 1.0);
+}
+
+/**
+ * Least-squares fit of a straight line through the motion history,
+ * the slope of which is the velocity of the touch. The sums are
+ * updated on every push so this is O(1) regardless of the history
+ * length.
+ *
+ * @param t The touch point
+ * @param[out] velocity The velocity in device units per second
+ *
+ * @return false if the history is too short or all samples have the same
+ * timestamp, true otherwise
+ */
+static inline bool
+tp_motion_history_velocity(const struct tp_touch *t,
+			   struct device_float_coords *velocity)
+{
+	const struct tp_velocity_fit *fit = &t->history.fit;
+	double n = t->history.count;
+	double denom = n * fit->stt - fit->st * fit->st;
+
+	/* n² times the variance of the timestamps, anything below 1µs
+	 * spread is noise in the sums */
+	if (t->history.count < 2 || denom < n * n * 1e-12)
+		return false;
+
+	velocity->x = (n * fit->stx - fit->st * fit->sx) / denom;
+	velocity->y = (n * fit->sty - fit->st * fit->sy) / denom;
+
+	return true;
+}
+
 struct normalized_coords
 tp_filter_motion(struct tp_dispatch *tp,
 		 const struct device_float_coords *unaccelerated,
@@ -117,11 +187,8 @@ tp_filter_scroll(struct tp_dispatch *tp,
 static inline void
 tp_calculate_motion_speed(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
-	const struct tp_history_point *last;
-	struct device_coords delta;
+	struct device_float_coords velocity;
 	struct phys_coords mm;
-	double distance;
-	double speed;
 
 	/* Don't do this on single-touch or semi-mt devices */
 	if (!tp->has_mt || tp->semi_mt)
@@ -131,7 +198,8 @@ tp_calculate_motion_speed(struct tp_dispatch *tp, struct tp_touch *t, uint64_t t
 		return;
 
 	/* This doesn't kick in until we have at least 4 events in the
-	 * motion history. As a side-effect, this automatically handles the
+	 * motion history, or a full history on devices configured with a
+	 * shorter one. As a side-effect, this automatically handles the
 	 * 2fg scroll where a finger is down and moving fast before the
 	 * other finger comes down for the scroll.
 	 *
@@ -139,34 +207,42 @@ tp_calculate_motion_speed(struct tp_dispatch *tp, struct tp_touch *t, uint64_t t
 	 * is reset whenever a new finger is down, so we'd be resetting the
 	 * speed and failing.
 	 */
-	if (t->history.count < 4)
+	if (t->history.count < min(4U, tp->history_length))
 		return;
 
-	/* TODO: we probably need a speed history here so we can average
-	 * across a few events */
-	last = tp_motion_history_offset(t, 1);
-	delta.x = abs(t->point.x - last->point.x);
-	delta.y = abs(t->point.y - last->point.y);
-	mm = evdev_device_unit_delta_to_mm(tp->device, &delta);
-
-	distance = length_in_mm(mm);
-	speed = distance / (time - last->time); /* mm/us */
-	speed *= 1000000;                       /* mm/s */
+	/* The least-squares fit averages across the whole history, so a
+	 * single noisy event doesn't cause a speed spike */
+	if (!tp_motion_history_velocity(t, &velocity))
+		return;
 
-	t->speed.last_speed = speed;
+	mm = tp_phys_delta(tp, velocity);
+	t->speed.last_speed = length_in_mm(mm); /* mm/s */
 }
 
 static inline void
 tp_motion_history_push(struct tp_touch *t, uint64_t time)
 {
-	int motion_index = (t->history.index + 1) % TOUCHPAD_HISTORY_LENGTH;
+	unsigned int length = t->tp->history_length;
+	unsigned int motion_index = (t->history.index + 1) % length;
+	struct tp_history_point *p = &t->history.samples[motion_index];
+	struct tp_velocity_fit *fit = &t->history.fit;
 
-	if (t->history.count < TOUCHPAD_HISTORY_LENGTH)
+	if (t->history.count == 0)
+		*fit = (struct tp_velocity_fit){ .base_time = time };
+	else if (t->history.count == length)
+		tp_velocity_fit_add(fit, p, -1.0); /* drop the oldest sample */
+
+	if (t->history.count < length)
 		t->history.count++;
 
-	t->history.samples[motion_index].point = t->point;
-	t->history.samples[motion_index].time = time;
+	p->point = t->point;
+	p->time = time;
 	t->history.index = motion_index;
+
+	if (time - fit->base_time > s2us(1))
+		tp_velocity_fit_rebuild(t);
+	else
+		tp_velocity_fit_add(fit, p, 1.0);
 }
 
 /* Idea: if we got a tuple of *very* quick moves like {Left, Right,
@@ -345,7 +421,7 @@ tp_new_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 	 * don't know if it's a touch down or not. And BTN_TOUCH may happen
 	 * after ABS_MT_TRACKING_ID */
 	tp_motion_history_reset(t);
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 	t->has_ended = false;
 	t->was_down = false;
 	t->palm.state = PALM_NONE;
@@ -360,7 +436,7 @@ tp_new_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 static inline void
 tp_begin_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 {
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 	t->state = TOUCH_BEGIN;
 	t->initial_time = time;
 	t->was_down = true;
@@ -407,7 +483,7 @@ tp_maybe_end_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 		t->state = TOUCH_NONE;
 	}
 
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 }
 
 /**
@@ -417,7 +493,7 @@ tp_maybe_end_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 static inline void
 tp_recover_ended_touch(struct tp_dispatch *tp, struct tp_touch *t)
 {
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 	t->state = TOUCH_UPDATE;
 	tp->nfingers_down++;
 }
@@ -437,7 +513,7 @@ tp_end_touch(struct tp_dispatch *tp, struct tp_touch *t, uint64_t time)
 		return;
 	}
 
-	t->dirty = true;
+	tp_touch_set_dirty(tp, t);
 	t->palm.state = PALM_NONE;
 	t->state = TOUCH_END;
 	t->pinned.is_pinned = false;
@@ -513,13 +589,13 @@ tp_process_absolute(struct tp_dispatch *tp, const struct evdev_event *e, uint64_
 	case EVDEV_ABS_MT_POSITION_X:
 		evdev_device_check_abs_axis_range(tp->device, e->usage, e->value);
 		t->point.x = rotated(tp, e->usage, e->value);
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case EVDEV_ABS_MT_POSITION_Y:
 		evdev_device_check_abs_axis_range(tp->device, e->usage, e->value);
 		t->point.y = rotated(tp, e->usage, e->value);
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case EVDEV_ABS_MT_SLOT:
@@ -536,22 +612,22 @@ tp_process_absolute(struct tp_dispatch *tp, const struct evdev_event *e, uint64_
 		break;
 	case EVDEV_ABS_MT_PRESSURE:
 		t->pressure = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	case EVDEV_ABS_MT_TOOL_TYPE:
 		t->is_tool_palm = e->value == MT_TOOL_PALM;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	case EVDEV_ABS_MT_TOUCH_MAJOR:
 		t->major = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	case EVDEV_ABS_MT_TOUCH_MINOR:
 		t->minor = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	default:
@@ -570,18 +646,18 @@ tp_process_absolute_st(struct tp_dispatch *tp,
 	case EVDEV_ABS_X:
 		evdev_device_check_abs_axis_range(tp->device, e->usage, e->value);
 		t->point.x = rotated(tp, e->usage, e->value);
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case EVDEV_ABS_Y:
 		evdev_device_check_abs_axis_range(tp->device, e->usage, e->value);
 		t->point.y = rotated(tp, e->usage, e->value);
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_MOTION;
 		break;
 	case EVDEV_ABS_PRESSURE:
 		t->pressure = e->value;
-		t->dirty = true;
+		tp_touch_set_dirty(tp, t);
 		tp->queued |= TOUCHPAD_EVENT_OTHERAXIS;
 		break;
 	default:
@@ -1227,20 +1303,17 @@ tp_unhover_size(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
 	int low = tp->touch_size.low, high = tp->touch_size.high;
-	int i;
 
 	/* We require 5 slots for size handling, so we don't need to care
 	 * about fake touches here */
 
-	for (i = 0; i < (int)tp->num_slots; i++) {
-		t = tp_get_touch(tp, i);
+	tp_for_each_dirty_touch(tp, t) {
+		if (t->index >= tp->num_slots)
+			break;
 
 		if (t->state == TOUCH_NONE)
 			continue;
 
-		if (!t->dirty)
-			continue;
-
 		if (t->state == TOUCH_HOVERING) {
 			if ((t->major > high && t->minor > low) ||
 			    (t->major > low && t->minor > high)) {
@@ -1363,8 +1436,8 @@ tp_position_fake_touches(struct tp_dispatch *tp)
 
 		t->point = topmost->point;
 		t->pressure = topmost->pressure;
-		if (!t->dirty)
-			t->dirty = topmost->dirty;
+		if (topmost->dirty)
+			tp_touch_set_dirty(tp, t);
 	}
 }
 
@@ -1516,6 +1589,8 @@ tp_motion_history_fix_last(struct tp_dispatch *tp,
 		p = tp_motion_history_offset(t, i);
 		p->time = time - jumping_interval - normal_interval * i;
 	}
+
+	tp_velocity_fit_rebuild(t);
 }
 
 static void
@@ -1612,7 +1687,8 @@ tp_pre_process_state(struct tp_dispatch *tp, uint64_t time)
 	tp_process_fake_touches(tp, time);
 	tp_unhover_touches(tp, time);
 
-	tp_for_each_touch(tp, t) {
+	/* Touches in TOUCH_MAYBE_END and TOUCH_END are always dirty */
+	tp_for_each_dirty_touch(tp, t) {
 		if (t->state == TOUCH_MAYBE_END)
 			tp_end_touch(tp, t, time);
 
@@ -1739,11 +1815,7 @@ tp_post_process_state(struct tp_dispatch *tp, uint64_t time)
 {
 	struct tp_touch *t;
 
-	tp_for_each_touch(tp, t) {
-
-		if (!t->dirty)
-			continue;
-
+	tp_for_each_dirty_touch(tp, t) {
 		if (t->state == TOUCH_END) {
 			if (t->has_ended)
 				t->state = TOUCH_NONE;
@@ -1755,6 +1827,13 @@ tp_post_process_state(struct tp_dispatch *tp, uint64_t time)
 
 		t->dirty = false;
 	}
+	tp->dirty_touches = 0;
+
+	struct libinput *libinput = tp_libinput_context(tp);
+	libinput->touchpad.touch_visits += tp->dirty_stats.visits;
+	libinput->touchpad.touch_skips += tp->dirty_stats.skips;
+	tp->dirty_stats.visits = 0;
+	tp->dirty_stats.skips = 0;
 
 	tp->old_nfingers_down = tp->nfingers_down;
 	tp->buttons.old_state = tp->buttons.state;
@@ -1824,7 +1903,9 @@ tp_handle_state(struct tp_dispatch *tp, uint64_t time)
 {
 	tp_pre_process_state(tp, time);
 	tp_process_state(tp, time);
+	tp_prediction_begin_frame(tp, time);
 	tp_post_events(tp, time);
+	tp_prediction_end_frame(tp, time);
 	tp_post_process_state(tp, time);
 
 	tp_clickpad_middlebutton_apply_config(tp->device);
@@ -1970,6 +2051,8 @@ tp_interface_destroy(struct evdev_dispatch *dispatch)
 	libinput_timer_destroy(&tp->gesture.hold_timer);
 	libinput_timer_destroy(&tp->gesture.drag_3fg_timer);
 	free(tp->touches);
+	free(tp->touches_cold);
+	free(tp->history_samples);
 	free(tp);
 }
 
@@ -1986,6 +2069,9 @@ tp_clear_state(struct tp_dispatch *tp)
 	struct tp_touch *t;
 
 	/* Unroll the touchpad state.
+	 * Take back any pointer prediction so the buttons are released
+	 * where the finger really is.
+	 *
 	 * Release buttons first. If tp is a clickpad, the button event
 	 * must come before the touch up. If it isn't, the order doesn't
 	 * matter anyway
@@ -1998,6 +2084,7 @@ tp_clear_state(struct tp_dispatch *tp)
 	 * Then reset thumb state.
 	 *
 	 */
+	tp_prediction_cancel(tp, now);
 	tp_release_all_buttons(tp, now);
 	tp_release_all_taps(tp, now);
 
@@ -2808,6 +2895,7 @@ tp_init_touch(struct tp_dispatch *tp, struct tp_touch *t, unsigned int index)
 	t->tp = tp;
 	t->has_ended = true;
 	t->index = index;
+	t->history.samples = &tp->history_samples[index * tp->history_length];
 }
 
 static inline void
@@ -2886,6 +2974,9 @@ tp_init_slots(struct tp_dispatch *tp, struct evdev_device *device)
 
 	tp->ntouches = max(tp->num_slots, n_btn_tool_touches);
 	tp->touches = zalloc(tp->ntouches * sizeof(struct tp_touch));
+	tp->touches_cold = zalloc(tp->ntouches * sizeof(struct tp_touch_cold));
+	tp->history_samples = zalloc(tp->ntouches * tp->history_length *
+				     sizeof(struct tp_history_point));
 
 	for (i = 0; i < tp->ntouches; i++)
 		tp_init_touch(tp, &tp->touches[i], i);
@@ -3423,6 +3514,7 @@ tp_init_sendevents(struct tp_dispatch *tp, struct evdev_device *device)
 			    timer_name,
 			    tp_trackpoint_timeout,
 			    tp);
+	libinput_timer_set_slack(&tp->palm.trackpoint_timer, TIMER_SLACK_BACKGROUND);
 
 	snprintf(timer_name,
 		 sizeof(timer_name),
@@ -3433,6 +3525,7 @@ tp_init_sendevents(struct tp_dispatch *tp, struct evdev_device *device)
 			    timer_name,
 			    tp_keyboard_timeout,
 			    tp);
+	libinput_timer_set_slack(&tp->dwt.keyboard_timer, TIMER_SLACK_BACKGROUND);
 }
 
 static bool
@@ -3609,6 +3702,31 @@ tp_init_touch_size(struct tp_dispatch *tp, struct evdev_device *device)
 	return true;
 }
 
+static void
+tp_init_motion_history(struct tp_dispatch *tp, struct evdev_device *device)
+{
+	uint32_t length = TOUCHPAD_HISTORY_LENGTH;
+
+	/* Devices with high report rates cover only a few ms with the
+	 * default length, this allows for a longer window to smoothen
+	 * the speed estimate */
+	_unref_(quirks) *q = libinput_device_get_quirks(&device->base);
+	if (q && quirks_get_uint32(q, QUIRK_ATTR_TOUCHPAD_HISTORY_LENGTH, &length)) {
+		if (length < 2 || length > TOUCHPAD_HISTORY_MAX_LENGTH) {
+			evdev_log_bug_libinput(device,
+					       "Invalid motion history length %u\n",
+					       length);
+			length = TOUCHPAD_HISTORY_LENGTH;
+		} else {
+			evdev_log_debug(device,
+					"using a motion history of %u events\n",
+					length);
+		}
+	}
+
+	tp->history_length = length;
+}
+
 static void
 tp_init_pressurepad(struct tp_dispatch *tp, struct evdev_device *device)
 {
@@ -3645,6 +3763,7 @@ tp_init(struct tp_dispatch *tp, struct evdev_device *device)
 
 	tp_init_default_resolution(tp, device);
 	tp_init_pressurepad(tp, device);
+	tp_init_motion_history(tp, device);
 
 	if (!tp_init_slots(tp, device))
 		return false;
@@ -3676,6 +3795,7 @@ tp_init(struct tp_dispatch *tp, struct evdev_device *device)
 	tp_init_scroll(tp, device);
 	tp_init_gesture(tp);
 	tp_init_thumb(tp);
+	tp_init_prediction(tp, device);
 
 	/* Lenovo X1 Gen6 buffers the events in a weird way, making jump
 	 * detection impossible. See
@@ -30,6 +30,8 @@
 #include "timer.h"
 
 #define TOUCHPAD_HISTORY_LENGTH 4
+#define TOUCHPAD_HISTORY_MAX_LENGTH 16
+#define TOUCHPAD_DIRTY_MASK_TOUCHES 64
 #define TOUCHPAD_MIN_SAMPLES 4
 
 /* Convert mm to a distance normalized to DEFAULT_MOUSE_DPI */
@@ -134,6 +136,9 @@ enum tp_tap_state {
 	TAP_STATE_DEAD, /**< finger count exceeded */
 };
 
+#define TAP_STATE_COUNT (TAP_STATE_DEAD - TAP_STATE_IDLE + 1)
+#define TAP_EVENT_COUNT 8 /* see enum tap_event */
+
 enum tp_tap_touch_state {
 	TAP_TOUCH_STATE_IDLE = 16, /**< not in touch */
 	TAP_TOUCH_STATE_TOUCH,     /**< touching, may tap */
@@ -187,6 +192,11 @@ enum tp_jump_state {
 	JUMP_STATE_EXPECT_DELAY,
 };
 
+struct tp_history_point {
+	uint64_t time;
+	struct device_coords point;
+};
+
 struct tp_touch {
 	struct tp_dispatch *tp;
 	unsigned int index;
@@ -212,12 +222,19 @@ struct tp_touch {
 	} quirks;
 
 	struct {
-		struct tp_history_point {
-			uint64_t time;
-			struct device_coords point;
-		} samples[TOUCHPAD_HISTORY_LENGTH];
 		unsigned int index;
 		unsigned int count;
+		/* Running sums for the least-squares velocity fit over all
+		 * samples in the history, times are in s relative to
+		 * base_time */
+		struct tp_velocity_fit {
+			uint64_t base_time;
+			double st, stt;
+			double sx, sy;
+			double stx, sty;
+		} fit;
+		/* tp->history_length entries in tp->history_samples */
+		struct tp_history_point *samples;
 	} history;
 
 	struct {
@@ -238,12 +255,11 @@ struct tp_touch {
 		struct device_coords center;
 	} pinned;
 
-	/* Software-button state and timeout if applicable */
+	/* Software-button state, the timeout is in struct tp_touch_cold */
 	struct {
 		enum button_state state;
 		/* We use button_event here so we can use == on events */
 		enum button_event current;
-		struct libinput_timer timer;
 		struct device_coords initial;
 		bool has_moved; /* has moved more than threshold */
 		uint64_t initial_time;
@@ -260,7 +276,6 @@ struct tp_touch {
 		enum tp_edge_scroll_touch_state edge_state;
 		uint32_t edge;
 		int direction;
-		struct libinput_timer timer;
 		struct device_coords initial;
 	} scroll;
 
@@ -280,6 +295,25 @@ struct tp_touch {
 	} speed;
 };
 
+/* Per-touch state that is only used on state transitions. This is kept
+ * out of struct tp_touch so the per-frame loops over tp->touches touch
+ * fewer cache lines, see tp_touch_cold().
+ *
+ * Only the timers live here: they are by far the largest members and
+ * are never read while processing a frame. Everything else in struct
+ * tp_touch is read on every frame while the touch is in the matching
+ * state, so moving it here would only add an indirection.
+ */
+struct tp_touch_cold {
+	struct {
+		struct libinput_timer timer;
+	} button;
+
+	struct {
+		struct libinput_timer timer;
+	} scroll;
+};
+
 enum suspend_trigger {
 	SUSPEND_NO_FLAG = 0x0,
 	SUSPEND_EXTERNAL_MOUSE = 0x1,
@@ -308,7 +342,18 @@ struct tp_dispatch {
 	unsigned int nactive_slots; /* number of active slots */
 	unsigned int num_slots;     /* number of slots */
 	unsigned int ntouches;      /* no slots inc. fakes */
+	unsigned int history_length; /* motion history samples per touch */
 	struct tp_touch *touches;   /* len == ntouches */
+	struct tp_touch_cold *touches_cold; /* len == ntouches */
+	struct tp_history_point *history_samples; /* len == ntouches * history_length */
+
+	/* Bitmask of the touches with t->dirty set, unused if ntouches
+	 * exceeds TOUCHPAD_DIRTY_MASK_TOUCHES, see tp_for_each_dirty_touch() */
+	uint64_t dirty_touches;
+	struct {
+		uint64_t visits;
+		uint64_t skips;
+	} dirty_stats; /* flushed into the context once per frame */
 	/* bit 0: BTN_TOUCH
 	 * bit 1: BTN_TOOL_FINGER
 	 * bit 2: BTN_TOOL_DOUBLETAP
@@ -446,6 +491,10 @@ struct tp_dispatch {
 
 		unsigned int nfingers_down; /* number of fingers down for tapping (excl.
 					       thumb/palm) */
+
+		/* number of events handled in each state, for profiling
+		 * only */
+		uint64_t events[TAP_STATE_COUNT][TAP_EVENT_COUNT];
 	} tap;
 
 	struct {
@@ -454,6 +503,21 @@ struct tp_dispatch {
 		size_t want_nfingers;
 	} drag_3fg;
 
+	struct {
+		struct libinput_device_config_pointer_prediction config;
+		bool enabled;
+
+		/* alpha-beta filter state. Positions are the sum of the
+		 * accelerated deltas since the prediction started */
+		bool active;
+		bool applied; /* in the current frame */
+		uint64_t time;
+		struct normalized_coords position;
+		struct normalized_coords estimate;
+		struct normalized_coords velocity; /* per µs */
+		struct normalized_coords offset; /* sent ahead of position */
+	} prediction;
+
 	struct {
 		struct libinput_device_config_dwtp config;
 		bool dwtp_enabled;
@@ -565,6 +629,52 @@ tp_dispatch(struct evdev_dispatch *dispatch)
 #define tp_for_each_touch(_tp, _t) \
 	for (unsigned int _i = 0; _i < (_tp)->ntouches && (_t = &(_tp)->touches[_i]); _i++)
 
+static inline void
+tp_touch_set_dirty(struct tp_dispatch *tp, struct tp_touch *t)
+{
+	t->dirty = true;
+	if (t->index < TOUCHPAD_DIRTY_MASK_TOUCHES)
+		tp->dirty_touches |= 1ULL << t->index;
+}
+
+/* Return the index of the next dirty touch at or after index, or
+ * tp->ntouches if there is none */
+static inline unsigned int
+tp_next_dirty_touch(struct tp_dispatch *tp, unsigned int index)
+{
+	unsigned int next = index;
+
+	if (tp->ntouches > TOUCHPAD_DIRTY_MASK_TOUCHES) {
+		while (next < tp->ntouches && !tp->touches[next].dirty)
+			next++;
+	} else {
+		uint64_t mask = index < TOUCHPAD_DIRTY_MASK_TOUCHES
+					? tp->dirty_touches >> index
+					: 0;
+		next = mask ? index + __builtin_ctzll(mask) : tp->ntouches;
+	}
+
+	tp->dirty_stats.skips += next - index;
+	if (next < tp->ntouches)
+		tp->dirty_stats.visits++;
+
+	return next;
+}
+
+/* Like tp_for_each_touch() but skips all touches that did not change in
+ * this frame. The mask is re-read on each step, so touches that become
+ * dirty during the loop are visited if they come after the current one */
+#define tp_for_each_dirty_touch(_tp, _t)                                  \
+	for (unsigned int _i = tp_next_dirty_touch(_tp, 0);                \
+	     _i < (_tp)->ntouches && (_t = &(_tp)->touches[_i]);           \
+	     _i = tp_next_dirty_touch(_tp, _i + 1))
+
+static inline struct tp_touch_cold *
+tp_touch_cold(struct tp_touch *t)
+{
+	return &t->tp->touches_cold[t->index];
+}
+
 static inline struct libinput *
 tp_libinput_context(const struct tp_dispatch *tp)
 {
@@ -776,4 +886,21 @@ tp_thumb_get_touch(struct tp_dispatch *tp);
 void
 tp_3fg_drag_apply_config(struct evdev_device *device);
 
+void
+tp_init_prediction(struct tp_dispatch *tp, struct evdev_device *device);
+
+struct normalized_coords
+tp_prediction_apply(struct tp_dispatch *tp,
+		    const struct normalized_coords *delta,
+		    uint64_t time);
+
+void
+tp_prediction_cancel(struct tp_dispatch *tp, uint64_t time);
+
+void
+tp_prediction_begin_frame(struct tp_dispatch *tp, uint64_t time);
+
+void
+tp_prediction_end_frame(struct tp_dispatch *tp, uint64_t time);
+
 #endif
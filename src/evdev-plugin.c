@@ -47,8 +47,24 @@ evdev_device_dispatch_frame(struct libinput_plugin *plugin,
 			    struct evdev_frame *frame)
 {
 	struct evdev_device *device = evdev_device(libinput_device);
+	struct libinput *libinput = evdev_libinput_context(device);
 	uint64_t time = evdev_frame_get_time(frame);
+
+	if (libinput->latency_stats) {
+		uint64_t now = libinput_now(libinput);
+		uint64_t read_time = evdev_frame_get_read_time(frame);
+
+		if (read_time)
+			libinput_device_note_latency(
+				libinput_device,
+				LIBINPUT_LATENCY_STAGE_READ_TO_PLUGIN_EXIT,
+				read_time,
+				now);
+		libinput_device->latency.frame_exit_time = now;
+	}
+
 	evdev_process_frame(device, frame, time);
+	libinput_device->latency.frame_exit_time = 0;
 
 	/* Discard event to make the plugin system aware we're done */
 	evdev_frame_reset(frame);
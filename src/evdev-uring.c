@@ -0,0 +1,340 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <liburing.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "util-list.h"
+#include "util-mem.h"
+
+#include "evdev-uring.h"
+#include "evdev.h"
+#include "libinput-private.h"
+
+/* Each device uses two entries, a poll linked to a read */
+#define EVDEV_URING_QUEUE_DEPTH 128
+#define EVDEV_URING_READ_LEN 64
+
+/* Stored in the low bits of the user_data, struct evdev_uring_read is
+ * sufficiently aligned */
+enum evdev_uring_op {
+	EVDEV_URING_OP_POLL = 0,
+	EVDEV_URING_OP_READ = 1,
+	EVDEV_URING_OP_CANCEL = 2,
+};
+#define EVDEV_URING_OP_MASK 0x3
+
+struct evdev_uring_read {
+	struct list link;
+	/* NULL once the device was removed, the read is freed once the
+	 * kernel is done with the buffer */
+	struct evdev_device *device;
+	int fd;
+	struct input_event buf[EVDEV_URING_READ_LEN];
+};
+
+struct evdev_uring {
+	struct libinput *libinput;
+	struct io_uring ring;
+	int eventfd;
+	struct libinput_source *source;
+	struct list reads;
+	uint64_t submissions;
+};
+
+static inline uint64_t
+evdev_uring_user_data(struct evdev_uring_read *read, enum evdev_uring_op op)
+{
+	return (uint64_t)(uintptr_t)read | op;
+}
+
+static void
+evdev_uring_submit(struct evdev_uring *uring)
+{
+	int rc;
+
+	if (io_uring_sq_ready(&uring->ring) == 0)
+		return;
+
+	uring->submissions++;
+	rc = io_uring_submit(&uring->ring);
+	if (rc < 0)
+		log_bug_libinput(uring->libinput,
+				 "io_uring: failed to submit (%s)\n",
+				 strerror(-rc));
+}
+
+static struct io_uring_sqe *
+evdev_uring_get_sqe(struct evdev_uring *uring)
+{
+	struct io_uring_sqe *sqe = io_uring_get_sqe(&uring->ring);
+
+	/* Submission queue full, flush it and try again */
+	if (!sqe) {
+		evdev_uring_submit(uring);
+		sqe = io_uring_get_sqe(&uring->ring);
+	}
+
+	return sqe;
+}
+
+static bool
+evdev_uring_queue_read(struct evdev_uring *uring, struct evdev_uring_read *read)
+{
+	struct io_uring_sqe *sqe;
+
+	/* Both entries must be in the same submission for the link */
+	if (io_uring_sq_space_left(&uring->ring) < 2)
+		evdev_uring_submit(uring);
+
+	/* The fd is O_NONBLOCK so a plain read would complete with
+	 * -EAGAIN, wait for POLLIN first */
+	sqe = evdev_uring_get_sqe(uring);
+	if (!sqe)
+		return false;
+	io_uring_prep_poll_add(sqe, read->fd, POLLIN);
+	io_uring_sqe_set_data64(sqe,
+				evdev_uring_user_data(read, EVDEV_URING_OP_POLL));
+	io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+
+	sqe = evdev_uring_get_sqe(uring);
+	if (!sqe)
+		return false;
+	io_uring_prep_read(sqe, read->fd, read->buf, sizeof(read->buf), 0);
+	io_uring_sqe_set_data64(sqe,
+				evdev_uring_user_data(read, EVDEV_URING_OP_READ));
+
+	return true;
+}
+
+static void
+evdev_uring_read_destroy(struct evdev_uring_read *read)
+{
+	list_remove(&read->link);
+	free(read);
+}
+
+static void
+evdev_uring_handle_read(struct evdev_uring *uring,
+			struct evdev_uring_read *read,
+			int res)
+{
+	struct evdev_device *device = read->device;
+
+	if (!device) {
+		evdev_uring_read_destroy(read);
+		return;
+	}
+
+	if (res == -ENODEV) {
+		evdev_device_remove(device);
+	} else if (res > 0) {
+		evdev_device_process_events(device,
+					    device->frame,
+					    read->buf,
+					    res / sizeof(struct input_event));
+	} else if (res < 0 && res != -EAGAIN && res != -EINTR &&
+		   res != -ECANCELED) {
+		/* Same as the epoll path, the device stays but we stop
+		 * reading from it */
+		evdev_log_error(device,
+				"io_uring: read failed (%s)\n",
+				strerror(-res));
+		evdev_uring_remove_device(uring, device);
+	}
+
+	/* The device may have been removed by now */
+	if (!read->device) {
+		evdev_uring_read_destroy(read);
+		return;
+	}
+
+	if (!evdev_uring_queue_read(uring, read)) {
+		evdev_log_bug_libinput(device,
+				       "io_uring: failed to queue read\n");
+		evdev_uring_remove_device(uring, device);
+		evdev_uring_read_destroy(read);
+	}
+}
+
+static void
+evdev_uring_dispatch(void *data)
+{
+	struct evdev_uring *uring = data;
+	struct io_uring_cqe *cqe;
+	eventfd_t count;
+
+	eventfd_read(uring->eventfd, &count);
+
+	/* Completions are consumed one at a time because handling one may
+	 * submit new requests */
+	while (io_uring_peek_cqe(&uring->ring, &cqe) == 0) {
+		uint64_t user_data = io_uring_cqe_get_data64(cqe);
+		int res = cqe->res;
+		struct evdev_uring_read *read =
+			(struct evdev_uring_read *)(uintptr_t)(user_data &
+							       ~EVDEV_URING_OP_MASK);
+
+		io_uring_cqe_seen(&uring->ring, cqe);
+
+		if ((user_data & EVDEV_URING_OP_MASK) == EVDEV_URING_OP_READ)
+			evdev_uring_handle_read(uring, read, res);
+	}
+
+	/* All follow-up reads go out in a single syscall */
+	evdev_uring_submit(uring);
+}
+
+bool
+evdev_uring_add_device(struct evdev_uring *uring, struct evdev_device *device)
+{
+	struct evdev_uring_read *read = zalloc(sizeof(*read));
+
+	read->device = device;
+	read->fd = device->fd;
+	list_append(&uring->reads, &read->link);
+
+	if (!evdev_uring_queue_read(uring, read)) {
+		evdev_uring_read_destroy(read);
+		return false;
+	}
+	evdev_uring_submit(uring);
+
+	device->uring_read = read;
+
+	return true;
+}
+
+void
+evdev_uring_remove_device(struct evdev_uring *uring, struct evdev_device *device)
+{
+	struct evdev_uring_read *read = device->uring_read;
+	struct io_uring_sqe *sqe;
+
+	device->uring_read = NULL;
+	read->device = NULL;
+
+	/* Cancelling the poll also cancels the linked read, the read's
+	 * completion frees it. The cancel is submitted now because the
+	 * caller is about to close the fd. */
+	sqe = evdev_uring_get_sqe(uring);
+	if (sqe) {
+		io_uring_prep_cancel64(sqe,
+				       evdev_uring_user_data(read,
+							     EVDEV_URING_OP_POLL),
+				       0);
+		io_uring_sqe_set_data64(
+			sqe,
+			evdev_uring_user_data(read, EVDEV_URING_OP_CANCEL));
+	}
+	evdev_uring_submit(uring);
+}
+
+uint64_t
+evdev_uring_get_submissions(struct evdev_uring *uring)
+{
+	return uring->submissions;
+}
+
+int
+evdev_uring_new(struct libinput *libinput, struct evdev_uring **uring_out)
+{
+	struct evdev_uring *uring = zalloc(sizeof(*uring));
+	int rc;
+
+	uring->libinput = libinput;
+	uring->eventfd = -1;
+	list_init(&uring->reads);
+
+	rc = io_uring_queue_init(EVDEV_URING_QUEUE_DEPTH, &uring->ring, 0);
+	if (rc < 0) {
+		free(uring);
+		return rc;
+	}
+
+	uring->eventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (uring->eventfd == -1) {
+		rc = -errno;
+		goto err;
+	}
+
+	rc = io_uring_register_eventfd(&uring->ring, uring->eventfd);
+	if (rc < 0)
+		goto err;
+
+	uring->source = libinput_add_fd(libinput,
+					uring->eventfd,
+					evdev_uring_dispatch,
+					uring);
+	if (!uring->source) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	*uring_out = uring;
+
+	return 0;
+
+err:
+	if (uring->eventfd != -1)
+		close(uring->eventfd);
+	io_uring_queue_exit(&uring->ring);
+	free(uring);
+	return rc;
+}
+
+void
+evdev_uring_destroy(struct evdev_uring *uring)
+{
+	struct evdev_uring_read *read;
+	struct io_uring_cqe *cqe;
+
+	if (!uring)
+		return;
+
+	/* All devices are gone by now, but the kernel may still write
+	 * into the buffers until the cancelled reads complete */
+	while (!list_empty(&uring->reads) &&
+	       io_uring_wait_cqe(&uring->ring, &cqe) == 0) {
+		uint64_t user_data = io_uring_cqe_get_data64(cqe);
+
+		io_uring_cqe_seen(&uring->ring, cqe);
+		if ((user_data & EVDEV_URING_OP_MASK) != EVDEV_URING_OP_READ)
+			continue;
+
+		read = (struct evdev_uring_read *)(uintptr_t)(user_data &
+							      ~EVDEV_URING_OP_MASK);
+		evdev_uring_read_destroy(read);
+	}
+
+	libinput_remove_source(uring->libinput, uring->source);
+	io_uring_queue_exit(&uring->ring);
+	close(uring->eventfd);
+	free(uring);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "evdev.h"
+#include "libinput-private.h"
+
+/* Reads device fds through io_uring instead of one epoll source and
+ * several read() calls per device. Each device has one poll+read request
+ * in flight, all completions are handled in a single libinput source and
+ * the follow-up reads are submitted in one batch. */
+struct evdev_uring;
+
+int
+evdev_uring_new(struct libinput *libinput, struct evdev_uring **uring_out);
+
+void
+evdev_uring_destroy(struct evdev_uring *uring);
+
+bool
+evdev_uring_add_device(struct evdev_uring *uring, struct evdev_device *device);
+
+void
+evdev_uring_remove_device(struct evdev_uring *uring, struct evdev_device *device);
+
+uint64_t
+evdev_uring_get_submissions(struct evdev_uring *uring);
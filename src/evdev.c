@@ -52,8 +52,14 @@
 #include <libwacom/libwacom.h>
 #endif
 
+#ifdef HAVE_LIBURING
+#include "evdev-uring.h"
+#endif
+
 #define DEFAULT_WHEEL_CLICK_ANGLE 15
 #define DEFAULT_BUTTON_SCROLL_TIMEOUT ms2us(200)
+#define EVDEV_BULK_READ_LEN 64
+#define EVDEV_MIN_FRAME_SIZE 64
 
 enum evdev_device_udev_tags {
 	EVDEV_UDEV_TAG_NONE = 0,
@@ -967,24 +973,37 @@ evdev_read_switch_reliability_prop(struct evdev_device *device)
 	return r;
 }
 
+/* Kernel timestamps are CLOCK_MONOTONIC, convert them to libinput's clock,
+ * see libinput_now() */
+static inline uint64_t
+evdev_kernel_time(struct libinput *libinput, uint64_t time)
+{
+	return time + libinput_clock_offset(libinput);
+}
+
+/* Dispatch a frame read from the kernel */
 static inline void
 evdev_device_dispatch_frame(struct libinput *libinput,
 			    struct evdev_device *device,
 			    struct evdev_frame *frame)
 {
+	evdev_frame_set_time(frame,
+			     evdev_kernel_time(libinput, evdev_frame_get_time(frame)));
 	libinput_plugin_system_notify_evdev_frame(&libinput->plugin_system,
 						  &device->base,
 						  frame);
 }
 
+/* Dispatch an injected frame, its time is already in libinput's clock */
 static inline void
 libinput_device_dispatch_frame(struct libinput_device *device,
 			       struct evdev_frame *frame)
 {
 	struct libinput *libinput = libinput_device_get_context(device);
-	struct evdev_device *dev = evdev_device(device);
 
-	evdev_device_dispatch_frame(libinput, dev, frame);
+	libinput_plugin_system_notify_evdev_frame(&libinput->plugin_system,
+						  device,
+						  frame);
 }
 
 static int
@@ -992,19 +1011,20 @@ evdev_sync_device(struct libinput *libinput, struct evdev_device *device)
 {
 	struct input_event ev;
 	int rc;
-	const size_t maxevents = 256;
-	_unref_(evdev_frame) *frame = evdev_frame_new(maxevents);
+	struct evdev_frame *frame = device->sync_frame;
 
 	do {
 		rc = libevdev_next_event(device->evdev, LIBEVDEV_READ_FLAG_SYNC, &ev);
 		if (rc < 0)
 			break;
 
-		/* No ENOMEM check here because >maxevents really should never happen */
+		/* No ENOMEM check here, the frame is large enough for every
+		 * event code of the device */
 		evdev_frame_append_input_event(frame, &ev);
 	} while (rc == LIBEVDEV_READ_STATUS_SYNC);
 
 	evdev_device_dispatch_frame(libinput, device, frame);
+	evdev_frame_reset(frame);
 
 	return rc == -EAGAIN ? 0 : rc;
 }
@@ -1014,7 +1034,7 @@ evdev_note_time_delay(struct evdev_device *device, const struct input_event *ev)
 {
 	struct libinput *libinput = evdev_libinput_context(device);
 	uint32_t tdelta;
-	uint64_t eventtime = input_event_time(ev);
+	uint64_t eventtime = evdev_kernel_time(libinput, input_event_time(ev));
 
 	/* if we have a current libinput_dispatch() snapshot, compare our
 	 * event time with the one from the snapshot. If we have more than
@@ -1035,6 +1055,236 @@ evdev_note_time_delay(struct evdev_device *device, const struct input_event *ev)
 	}
 }
 
+/* Called for every SYN_REPORT */
+static inline void
+evdev_device_dispatch_complete_frame(struct libinput *libinput,
+				     struct evdev_device *device,
+				     struct evdev_frame *frame)
+{
+	if (libinput->latency_stats) {
+		uint64_t now = libinput_now(libinput);
+
+		libinput_device_note_latency(
+			&device->base,
+			LIBINPUT_LATENCY_STAGE_KERNEL_TO_READ,
+			evdev_kernel_time(libinput, evdev_frame_get_time(frame)),
+			now);
+		evdev_frame_set_read_time(frame, now);
+	}
+	evdev_device_dispatch_frame(libinput, device, frame);
+	evdev_frame_reset(frame);
+}
+
+static void
+evdev_device_dispatch_syn_dropped(struct libinput *libinput,
+				  struct evdev_device *device,
+				  struct evdev_frame *frame,
+				  struct input_event *ev)
+{
+	evdev_log_info_ratelimit(
+		device,
+		&device->syn_drop_limit,
+		"SYN_DROPPED event - some input events have been lost.\n");
+
+	/* send one more sync event so we handle all
+	   currently pending events before we sync up
+	   to the current state */
+	ev->code = SYN_REPORT;
+
+	if (evdev_frame_append_input_event(frame, ev) == -ENOMEM) {
+		evdev_log_bug_libinput(device,
+				       "event frame overflow, discarding events.\n");
+	}
+	evdev_device_dispatch_frame(libinput, device, frame);
+	evdev_frame_reset(frame);
+}
+
+/**
+ * Update libevdev's view of the device for an event that was read from
+ * the fd without going through libevdev_next_event(). Returns false if
+ * libevdev would have discarded the event, e.g. because the event code
+ * was disabled.
+ */
+static inline bool
+evdev_device_update_libevdev_state(struct evdev_device *device,
+				   const struct input_event *ev)
+{
+	switch (ev->type) {
+	case EV_SYN:
+		return true;
+	case EV_KEY:
+	case EV_ABS:
+	case EV_SW:
+	case EV_LED:
+		return libevdev_set_event_value(device->evdev,
+						ev->type,
+						ev->code,
+						ev->value) == 0;
+	default:
+		return libevdev_has_event_code(device->evdev, ev->type, ev->code);
+	}
+}
+
+/* Process what libevdev has queued after a sync until the fd is drained.
+ * libevdev may read from the fd during the sync and those events are no
+ * longer visible to a read() on the fd. */
+static size_t
+evdev_device_drain_libevdev(struct libinput *libinput,
+			    struct evdev_device *device,
+			    struct evdev_frame *frame)
+{
+	struct input_event ev;
+	size_t nframes = 0;
+	int rc;
+
+	while (true) {
+		rc = libevdev_next_event(device->evdev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+		if (rc == LIBEVDEV_READ_STATUS_SYNC) {
+			evdev_device_dispatch_syn_dropped(libinput,
+							  device,
+							  frame,
+							  &ev);
+			evdev_sync_device(libinput, device);
+			continue;
+		} else if (rc != LIBEVDEV_READ_STATUS_SUCCESS) {
+			break;
+		}
+
+		if (evdev_frame_append_input_event(frame, &ev) == -ENOMEM) {
+			evdev_log_bug_libinput(
+				device,
+				"event frame overflow, discarding events.\n");
+		}
+
+		if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+			evdev_device_dispatch_complete_frame(libinput,
+							     device,
+							     frame);
+			nframes++;
+		}
+	}
+
+	return nframes;
+}
+
+size_t
+evdev_device_process_events(struct evdev_device *device,
+			    struct evdev_frame *frame,
+			    struct input_event *events,
+			    size_t nevents)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+	size_t nframes = 0;
+
+	if (nevents == 0)
+		return 0;
+
+	evdev_note_time_delay(device, &events[0]);
+
+	for (size_t i = 0; i < nevents; i++) {
+		struct input_event *ev = &events[i];
+
+		if (ev->type == EV_SYN && ev->code == SYN_DROPPED) {
+			struct input_event sync_ev;
+
+			evdev_device_dispatch_syn_dropped(libinput,
+							  device,
+							  frame,
+							  ev);
+
+			/* The rest of our buffer predates the state we
+			 * sync to, discard it */
+			libevdev_next_event(device->evdev,
+					    LIBEVDEV_READ_FLAG_FORCE_SYNC,
+					    &sync_ev);
+			evdev_sync_device(libinput, device);
+
+			return nframes + evdev_device_drain_libevdev(libinput,
+								     device,
+								     frame);
+		}
+
+		if (!evdev_device_update_libevdev_state(device, ev))
+			continue;
+
+		if (evdev_frame_append_input_event(frame, ev) == -ENOMEM) {
+			evdev_log_bug_libinput(
+				device,
+				"event frame overflow, discarding events.\n");
+		}
+
+		if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+			evdev_device_dispatch_complete_frame(libinput,
+							     device,
+							     frame);
+			nframes++;
+		}
+	}
+
+	return nframes;
+}
+
+/* Fast path for libinput_set_bulk_read_enabled(): read() as many events
+ * as fit into the device's read buffer and process them in one go
+ * instead of pulling them one-by-one through libevdev_next_event().
+ */
+static void
+evdev_device_dispatch_bulk(void *data)
+{
+	struct evdev_device *device = data;
+	struct libinput *libinput = evdev_libinput_context(device);
+	unsigned int budget = libinput->dispatch.budget;
+	size_t nframes = 0;
+	const size_t bufsize = EVDEV_BULK_READ_LEN * sizeof(*device->read_buf);
+	ssize_t len;
+	struct evdev_frame *frame = device->frame;
+
+	while (true) {
+		len = read(device->fd, device->read_buf, bufsize);
+		if (len < 0) {
+			len = -errno;
+			break;
+		}
+
+		nframes += evdev_device_process_events(
+			device,
+			frame,
+			device->read_buf,
+			len / sizeof(*device->read_buf));
+
+		/* A short read means we drained the fd */
+		if ((size_t)len < bufsize)
+			break;
+
+		/* Give other devices a turn, but only between frames */
+		if (budget > 0 && nframes >= budget &&
+		    evdev_frame_get_count(frame) <= 1) {
+			libinput->dispatch.budget_hits++;
+			libinput_source_set_pending(libinput, device->source);
+			return;
+		}
+	}
+
+	if (len == -ENODEV) {
+		evdev_device_remove(device);
+		return;
+	}
+
+	/* This should never happen, the kernel flushes only on SYN_REPORT */
+	if (evdev_frame_get_count(frame) > 1) {
+		evdev_log_bug_kernel(
+			device,
+			"event frame missing SYN_REPORT, forcing frame.\n");
+		evdev_device_dispatch_frame(libinput, device, frame);
+		evdev_frame_reset(frame);
+	}
+
+	if (len < 0 && len != -EAGAIN && len != -EINTR) {
+		libinput_remove_source(libinput, device->source);
+		device->source = NULL;
+	}
+}
+
 static void
 evdev_device_dispatch(void *data)
 {
@@ -1043,7 +1293,9 @@ evdev_device_dispatch(void *data)
 	struct input_event ev;
 	int rc;
 	bool once = false;
-	_unref_(evdev_frame) *frame = evdev_frame_new(64);
+	unsigned int budget = libinput->dispatch.budget;
+	unsigned int nframes = 0;
+	struct evdev_frame *frame = device->frame;
 
 	/* If the compositor is repainting, this function is called only once
 	 * per frame and we have to process all the events available on the
@@ -1051,23 +1303,10 @@ evdev_device_dispatch(void *data)
 	do {
 		rc = libevdev_next_event(device->evdev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
 		if (rc == LIBEVDEV_READ_STATUS_SYNC) {
-			evdev_log_info_ratelimit(
-				device,
-				&device->syn_drop_limit,
-				"SYN_DROPPED event - some input events have been lost.\n");
-
-			/* send one more sync event so we handle all
-			   currently pending events before we sync up
-			   to the current state */
-			ev.code = SYN_REPORT;
-
-			if (evdev_frame_append_input_event(frame, &ev) == -ENOMEM) {
-				evdev_log_bug_libinput(
-					device,
-					"event frame overflow, discarding events.\n");
-			}
-			evdev_device_dispatch_frame(libinput, device, frame);
-			evdev_frame_reset(frame);
+			evdev_device_dispatch_syn_dropped(libinput,
+							  device,
+							  frame,
+							  &ev);
 
 			rc = evdev_sync_device(libinput, device);
 			if (rc == 0)
@@ -1084,8 +1323,19 @@ evdev_device_dispatch(void *data)
 					"event frame overflow, discarding events.\n");
 			}
 			if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
-				evdev_device_dispatch_frame(libinput, device, frame);
-				evdev_frame_reset(frame);
+				evdev_device_dispatch_complete_frame(libinput,
+								     device,
+								     frame);
+
+				/* Give other devices a turn, libinput_dispatch()
+				 * calls us again for the rest */
+				if (budget > 0 && ++nframes >= budget &&
+				    libevdev_has_event_pending(device->evdev) > 0) {
+					libinput->dispatch.budget_hits++;
+					libinput_source_set_pending(libinput,
+								    device->source);
+					return;
+				}
 			}
 		} else if (rc == -ENODEV) {
 			evdev_device_remove(device);
@@ -1099,6 +1349,7 @@ evdev_device_dispatch(void *data)
 			device,
 			"event frame missing SYN_REPORT, forcing frame.\n");
 		evdev_device_dispatch_frame(libinput, device, frame);
+		evdev_frame_reset(frame);
 	}
 
 	if (rc != -EAGAIN && rc != -EINTR) {
@@ -1107,6 +1358,81 @@ evdev_device_dispatch(void *data)
 	}
 }
 
+/* Upper bound for the number of events in a single frame: every event
+ * code of the device once, the multitouch axes once per slot */
+static size_t
+evdev_device_frame_size(struct evdev_device *device)
+{
+	struct libevdev *evdev = device->evdev;
+	int nslots = max(libevdev_get_num_slots(evdev), 1);
+	size_t size = 1; /* SYN_REPORT */
+
+	for (unsigned int type = EV_KEY; type < EV_CNT; type++) {
+		int max_code = libevdev_event_type_get_max(type);
+
+		if (max_code < 0 || !libevdev_has_event_type(evdev, type))
+			continue;
+
+		for (int code = 0; code <= max_code; code++) {
+			if (!libevdev_has_event_code(evdev, type, code))
+				continue;
+
+			if (type == EV_ABS && code >= ABS_MT_SLOT &&
+			    code <= ABS_MT_TOOL_Y)
+				size += nslots;
+			else
+				size++;
+		}
+	}
+
+	return max(size, (size_t)EVDEV_MIN_FRAME_SIZE);
+}
+
+static bool
+evdev_device_add_source(struct evdev_device *device)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+
+#ifdef HAVE_LIBURING
+	if (libinput->io_uring_enabled &&
+	    evdev_uring_add_device(libinput->uring, device))
+		return true;
+#endif
+
+	if (libinput->bulk_read_enabled) {
+		if (!device->read_buf)
+			device->read_buf = zalloc(EVDEV_BULK_READ_LEN *
+						  sizeof(*device->read_buf));
+		device->source = libinput_add_fd(libinput,
+						 device->fd,
+						 evdev_device_dispatch_bulk,
+						 device);
+	} else {
+		device->source = libinput_add_fd(libinput,
+						 device->fd,
+						 evdev_device_dispatch,
+						 device);
+	}
+
+	return device->source != NULL;
+}
+
+static void
+evdev_device_remove_source(struct evdev_device *device)
+{
+	struct libinput *libinput = evdev_libinput_context(device);
+
+#ifdef HAVE_LIBURING
+	if (device->uring_read)
+		evdev_uring_remove_device(libinput->uring, device);
+#endif
+
+	if (device->source) {
+		libinput_remove_source(libinput, device->source);
+		device->source = NULL;
+	}
+}
+
 static inline bool
 evdev_init_accel(struct evdev_device *device, enum libinput_config_accel_profile which)
 {
@@ -2352,8 +2678,11 @@ evdev_device_create(struct libinput_seat *seat, struct udev_device *udev_device)
 	    device->seat_caps == EVDEV_DEVICE_NO_CAPABILITIES)
 		goto err_notify;
 
-	device->source = libinput_add_fd(libinput, fd, evdev_device_dispatch, device);
-	if (!device->source)
+	size_t frame_size = evdev_device_frame_size(device);
+	device->frame = evdev_frame_new(frame_size);
+	device->sync_frame = evdev_frame_new(frame_size);
+
+	if (!evdev_device_add_source(device))
 		goto err_notify;
 
 	if (!evdev_set_device_group(device, udev_device))
@@ -2854,10 +3183,7 @@ evdev_device_suspend(struct evdev_device *device)
 	if (device->dispatch->interface->suspend)
 		device->dispatch->interface->suspend(device->dispatch, device);
 
-	if (device->source) {
-		libinput_remove_source(libinput, device->source);
-		device->source = NULL;
-	}
+	evdev_device_remove_source(device);
 
 	if (device->fd != -1) {
 		close_restricted(libinput, device->fd);
@@ -2910,8 +3236,7 @@ evdev_device_resume(struct evdev_device *device)
 					     &ev);
 	} while (status == LIBEVDEV_READ_STATUS_SYNC);
 
-	device->source = libinput_add_fd(libinput, fd, evdev_device_dispatch, device);
-	if (!device->source)
+	if (!evdev_device_add_source(device))
 		return -ENOMEM;
 
 	evdev_notify_resumed_device(device);
@@ -2958,6 +3283,8 @@ evdev_device_destroy(struct evdev_device *device)
 {
 	struct evdev_dispatch *dispatch;
 
+	evdev_device_remove_source(device);
+
 	dispatch = device->dispatch;
 	if (dispatch)
 		dispatch->interface->destroy(dispatch);
@@ -2965,6 +3292,9 @@ evdev_device_destroy(struct evdev_device *device)
 	if (device->base.group)
 		libinput_device_group_unref(device->base.group);
 
+	free(device->read_buf);
+	evdev_frame_unref(device->frame);
+	evdev_frame_unref(device->sync_frame);
 	free(device->log_prefix_name);
 	free(device->sysname);
 	free(device->output_name);
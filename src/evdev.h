@@ -169,6 +169,14 @@ struct evdev_device {
 	struct libinput_device base;
 
 	struct libinput_source *source;
+	/* Set instead of source if the device is read via io_uring */
+	struct evdev_uring_read *uring_read;
+	/* EVDEV_BULK_READ_LEN events, only used with bulk reads */
+	struct input_event *read_buf;
+	/* Reused for every frame read from the device, sized from the
+	 * device's capabilities */
+	struct evdev_frame *frame;
+	struct evdev_frame *sync_frame;
 
 	struct evdev_dispatch *dispatch;
 	struct libevdev *evdev;
@@ -541,6 +549,12 @@ evdev_device_transform_y(struct evdev_device *device, double y, uint32_t height)
 void
 evdev_device_suspend(struct evdev_device *device);
 
+size_t
+evdev_device_process_events(struct evdev_device *device,
+			    struct evdev_frame *frame,
+			    struct input_event *events,
+			    size_t nevents);
+
 int
 evdev_device_resume(struct evdev_device *device);
 
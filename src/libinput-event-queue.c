@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2013 Jonas Ådahl
+ * Copyright © 2013-2018 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "libinput-private.h"
+
+/**
+ * Merge a motion event into the most recently queued event if that is a
+ * motion event from the same device.
+ *
+ * @return true if the event was merged and must be discarded by the
+ * caller, false if the event must be queued
+ */
+static bool
+libinput_coalesce_motion(struct libinput *libinput,
+			 struct libinput_event *event,
+			 bool force)
+{
+	if ((!libinput->coalesce_motion && !force) ||
+	    event->type != LIBINPUT_EVENT_POINTER_MOTION ||
+	    libinput->events_count == 0)
+		return false;
+
+	size_t last = (libinput->events_in + libinput->events_len - 1) %
+		      libinput->events_len;
+	struct libinput_event *queued = libinput->events[last];
+
+	if (queued->type != LIBINPUT_EVENT_POINTER_MOTION ||
+	    queued->device != event->device)
+		return false;
+
+	struct libinput_event_pointer *prev =
+		libinput_event_get_pointer_event(queued);
+	struct libinput_event_pointer *next =
+		libinput_event_get_pointer_event(event);
+
+	if (prev->nmerged == 0)
+		prev->first_time = prev->time;
+	prev->time = next->time;
+	prev->delta.x += next->delta.x;
+	prev->delta.y += next->delta.y;
+	prev->delta_raw.x += next->delta_raw.x;
+	prev->delta_raw.y += next->delta_raw.y;
+	prev->nmerged++;
+
+	return true;
+}
+
+/**
+ * Called when the event queue is empty. Shrink the ring buffer if it is
+ * much larger than what was needed since the queue was last empty, e.g.
+ * after the caller stalled once.
+ */
+static void
+libinput_shrink_event_queue(struct libinput *libinput)
+{
+	size_t len = LIBINPUT_EVENT_QUEUE_MIN_LEN;
+
+	assert(libinput->events_count == 0);
+
+	while (len < libinput->events_recent_peak)
+		len *= 2;
+	libinput->events_recent_peak = 0;
+
+	if (libinput->events_len <= 4 * len)
+		return;
+
+	struct libinput_event **events =
+		realloc(libinput->events, len * sizeof(*events));
+	if (!events)
+		return;
+
+	libinput->events = events;
+	libinput->events_len = len;
+	libinput->events_in = 0;
+	libinput->events_out = 0;
+}
+
+bool
+libinput_event_queue_append(struct libinput *libinput,
+			    struct libinput_event *event)
+{
+	struct libinput_event **events = libinput->events;
+	size_t events_len = libinput->events_len;
+	size_t events_count = libinput->events_count;
+	size_t move_len;
+	size_t new_out;
+
+	events_count++;
+	if (events_count > events_len) {
+		void *tmp;
+
+		events_len *= 2;
+		tmp = realloc(events, events_len * sizeof *events);
+		if (!tmp) {
+			log_error(libinput,
+				  "Failed to reallocate event ring buffer. "
+				  "Events may be discarded\n");
+			return false;
+		}
+
+		events = tmp;
+
+		if (libinput->events_count > 0 && libinput->events_in == 0) {
+			libinput->events_in = libinput->events_len;
+		} else if (libinput->events_count > 0 &&
+			   libinput->events_out >= libinput->events_in) {
+			move_len = libinput->events_len - libinput->events_out;
+			new_out = events_len - move_len;
+			memmove(events + new_out,
+				events + libinput->events_out,
+				move_len * sizeof *events);
+			libinput->events_out = new_out;
+		}
+
+		libinput->events = events;
+		libinput->events_len = events_len;
+	}
+
+	libinput->events_count = events_count;
+	events[libinput->events_in] = event;
+	libinput->events_in = (libinput->events_in + 1) % libinput->events_len;
+
+	libinput->events_peak = max(libinput->events_peak, events_count);
+	libinput->events_recent_peak =
+		max(libinput->events_recent_peak, events_count);
+
+	return true;
+}
+
+bool
+libinput_event_queue_push(struct libinput *libinput, struct libinput_event *event)
+{
+	size_t events_count = libinput->events_count;
+
+	if (libinput_coalesce_motion(libinput, event, false))
+		return false;
+
+	/* On overflow, merge motion events even if motion coalescing is
+	 * disabled and drop anything else. Device added/removed events are
+	 * never dropped, callers rely on them for their device
+	 * references. */
+	if (libinput->events_max > 0 && events_count >= libinput->events_max &&
+	    event->type != LIBINPUT_EVENT_DEVICE_ADDED &&
+	    event->type != LIBINPUT_EVENT_DEVICE_REMOVED) {
+		if (!libinput_coalesce_motion(libinput, event, true)) {
+			libinput->events_dropped++;
+			log_bug_client_ratelimit(
+				libinput,
+				&libinput->events_overflow_limit,
+				"event queue full (%zu events), dropping events\n",
+				events_count);
+		}
+		return false;
+	}
+
+	if (!libinput_event_queue_append(libinput, event))
+		return false;
+
+	if (event->device)
+		libinput_device_ref(event->device);
+
+	return true;
+}
+
+struct libinput_event *
+libinput_event_queue_peek(struct libinput *libinput)
+{
+	if (libinput->events_count == 0)
+		return NULL;
+
+	return libinput->events[libinput->events_out];
+}
+
+size_t
+libinput_event_queue_pop(struct libinput *libinput,
+			 struct libinput_event **events,
+			 size_t max_events)
+{
+	size_t count = min(max_events, libinput->events_count);
+
+	if (count == 0)
+		return 0;
+
+	/* The ring buffer may wrap, copy in up to two chunks */
+	size_t first = min(count, libinput->events_len - libinput->events_out);
+	memcpy(events,
+	       libinput->events + libinput->events_out,
+	       first * sizeof(*events));
+	memcpy(events + first, libinput->events, (count - first) * sizeof(*events));
+
+	libinput->events_out = (libinput->events_out + count) % libinput->events_len;
+	libinput->events_count -= count;
+	if (libinput->events_count == 0)
+		libinput_shrink_event_queue(libinput);
+
+	return count;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_event_queue_limit(struct libinput *libinput, size_t max_events)
+{
+	libinput->events_max = max_events;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_get_event_queue_limit(struct libinput *libinput)
+{
+	return libinput->events_max;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_motion_coalescing_enabled(struct libinput *libinput, int enabled)
+{
+	libinput->coalesce_motion = !!enabled;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_motion_coalescing_enabled(struct libinput *libinput)
+{
+	return libinput->coalesce_motion;
+}
+
+LIBINPUT_EXPORT void
+libinput_events_destroy(struct libinput_event **events, size_t nevents)
+{
+	for (size_t i = 0; i < nevents; i++)
+		libinput_event_destroy(events[i]);
+}
@@ -144,6 +144,9 @@ struct plugin_device {
 
 	struct libinput_plugin_timer *timer;
 	struct libinput_plugin_timer *timer_short;
+
+	/* Scratch frame for debounce_plugin_handle_frame() */
+	struct evdev_frame *filtered_frame;
 };
 
 static void
@@ -157,6 +160,7 @@ plugin_device_destroy(void *d)
 	libinput_plugin_timer_cancel(device->timer_short);
 	libinput_plugin_timer_unref(device->timer_short);
 	libinput_device_unref(device->device);
+	evdev_frame_unref(device->filtered_frame);
 
 	free(device);
 }
@@ -281,14 +285,17 @@ debounce_notify_button(struct plugin_device *device,
 			       state == LIBINPUT_BUTTON_STATE_PRESSED ? 1 : 0);
 	evdev_frame_set_time(frame, device->button_time);
 
-	libinput_plugin_prepend_evdev_frame(device->parent->plugin,
-					    device->device,
-					    frame);
-
 	/* If we used the original frame, reset it to avoid re-sending any
-	 * non-button events that may be present in this frame */
-	if (button_frame == NULL)
+	 * non-button events that may be present in this frame. Queued
+	 * frames are not copied, so we queue a copy instead. */
+	if (button_frame == NULL) {
+		button_frame = evdev_frame_clone(frame);
 		evdev_frame_reset(frame);
+	}
+
+	libinput_plugin_prepend_evdev_frame(device->parent->plugin,
+					    device->device,
+					    button_frame);
 }
 
 static void
@@ -647,7 +654,8 @@ debounce_plugin_handle_frame(struct plugin_device *device,
 	 * We allow for a max of 16 buttons to be appended, if you press more
 	 * than 16 buttons within the same frame good luck to you.
 	 */
-	_unref_(evdev_frame) *filtered_frame = evdev_frame_new(nevents + 16);
+	struct evdev_frame *filtered_frame =
+		evdev_frame_reuse(&device->filtered_frame, nevents + 16);
 	for (size_t i = 0; i < nevents; i++) {
 		struct evdev_event *e = &events[i];
 		if (!evdev_usage_is_button(e->usage)) {
@@ -804,6 +812,8 @@ debounce_plugin_device_added(struct libinput_plugin *libinput_plugin,
 						    timer2_name,
 						    debounce_timeout_short,
 						    pd);
+	libinput_plugin_timer_set_slack(pd->timer, TIMER_SLACK_INTERACTIVE);
+	libinput_plugin_timer_set_slack(pd->timer_short, TIMER_SLACK_INTERACTIVE);
 
 	list_take_append(&plugin->devices, pd, link);
 }
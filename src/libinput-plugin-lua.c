@@ -24,11 +24,17 @@
 #include "config.h"
 
 #include <assert.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <lauxlib.h>
 #include <libevdev/libevdev.h>
 #include <lua.h>
 #include <lualib.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include "util-files.h"
 #include "util-mem.h"
 #include "util-strings.h"
 
@@ -44,6 +50,15 @@ const uint32_t LIBINPUT_PLUGIN_VERSION = 1U;
 
 #define PLUGIN_METATABLE "LibinputPlugin"
 #define EVDEV_DEVICE_METATABLE "EvdevDevice"
+#define EVDEV_FRAME_METATABLE "EvdevFrame"
+
+/* A single call into a plugin may use this much CPU time before it is
+ * aborted. The budget hook checks the thread's CPU time every
+ * LUA_BUDGET_HOOK_INSTRUCTIONS instructions, a plugin that exceeds the
+ * budget LUA_MAX_BUDGET_OVERRUNS times is unloaded */
+#define LUA_CALL_BUDGET_US ms2us(5)
+#define LUA_BUDGET_HOOK_INSTRUCTIONS 1000
+#define LUA_MAX_BUDGET_OVERRUNS 3
 
 static const char libinput_lua_plugin_key = 'p'; /* key to lua registry */
 static const char libinput_key = 'l';            /* key to lua registry */
@@ -96,12 +111,23 @@ typedef struct {
 
 	int device_removed_refid;
 	int frame_refid;
+	/* frame_refid was connected as "evdev-frame-view" */
+	bool frame_is_view;
 
 	/* Caches any disable_feature calls during device_new */
 	bool was_added;
 	bitmask_t disabled_features;
 } EvdevDevice;
 
+/* The view passed to "evdev-frame-view" callbacks. There is only one
+ * per plugin, it is reused for every frame and only valid during the
+ * callback */
+typedef struct {
+	struct evdev_frame *frame;
+	struct libevdev *evdev;
+	struct libinput_plugin *plugin;
+} EvdevFrame;
+
 struct libinput_lua_plugin {
 	struct libinput_plugin *parent;
 	lua_State *L;
@@ -116,6 +142,21 @@ struct libinput_lua_plugin {
 
 	struct libinput_plugin_timer *timer;
 	bool in_timer_func;
+
+	EvdevFrame *frame_view;
+	int frame_view_refid;
+
+	/* Deadline of the current call, 0 outside a call */
+	uint64_t budget_deadline;
+	bool budget_exceeded;
+	unsigned int budget_overruns;
+
+	/* Wraps the lua_State's default allocator to count allocations */
+	struct {
+		lua_Alloc func;
+		void *user_data;
+		size_t count;
+	} alloc;
 };
 
 static struct libinput_lua_plugin *
@@ -291,15 +332,57 @@ out:
 	lua_pop(L, 1);
 }
 
+static void
+libinput_lua_budget_hook(lua_State *L, lua_Debug *ar)
+{
+	struct libinput_lua_plugin *plugin = lua_get_libinput_lua_plugin(L);
+	uint64_t now;
+
+	if (plugin->budget_deadline == 0 || thread_cpu_time_in_us(&now) != 0 ||
+	    now < plugin->budget_deadline)
+		return;
+
+	/* A plugin may catch this with pcall() but we keep raising the
+	 * error until the call returns */
+	plugin->budget_exceeded = true;
+	luaL_error(L,
+		   "callback exceeded its CPU budget of %dms",
+		   (int)us2ms(LUA_CALL_BUDGET_US));
+}
+
 static bool
 libinput_lua_pcall(struct libinput_lua_plugin *plugin, int narg, int nres)
 {
 	lua_State *L = plugin->L;
+	uint64_t start = 0, end = 0;
+
+	thread_cpu_time_in_us(&start);
+	plugin->budget_deadline = start + LUA_CALL_BUDGET_US;
+	plugin->budget_exceeded = false;
 
 	int rc = lua_pcall(L, narg, nres, 0);
+
+	thread_cpu_time_in_us(&end);
+	plugin->budget_deadline = 0;
+	libinput_plugin_account_call(plugin->parent,
+				     end > start ? end - start : 0,
+				     plugin->budget_exceeded);
+
 	if (rc != LUA_OK) {
 		auto libinput_plugin = plugin->parent;
 		const char *errormsg = lua_tostring(L, -1);
+
+		if (plugin->budget_exceeded &&
+		    ++plugin->budget_overruns < LUA_MAX_BUDGET_OVERRUNS) {
+			plugin_log_bug(libinput_plugin,
+				       "%s, call aborted (overrun %u of %u)\n",
+				       errormsg,
+				       plugin->budget_overruns,
+				       LUA_MAX_BUDGET_OVERRUNS);
+			lua_pop(L, 1); /* pop error message */
+			return false;
+		}
+
 		if (strstr(errormsg, "@@unregistering@@") == NULL) {
 			plugin_log_bug(libinput_plugin,
 				       "unloading after error: %s\n",
@@ -339,8 +422,7 @@ remove_device(struct libinput_lua_plugin *plugin, EvdevDevice *evdev)
 		lua_rawgeti(plugin->L, LUA_REGISTRYINDEX, evdev->device_removed_refid);
 		lua_rawgeti(plugin->L, LUA_REGISTRYINDEX, evdev->refid);
 
-		if (!libinput_lua_pcall(plugin, 1, 0))
-			return;
+		libinput_lua_pcall(plugin, 1, 0);
 	}
 	luaL_unref(plugin->L, evdev->refid, LUA_REGISTRYINDEX);
 	evdev->refid = LUA_NOREF;
@@ -405,6 +487,28 @@ libinput_lua_plugin_evdev_frame(struct libinput_plugin *libinput_plugin,
 		if (evdev->frame_refid == LUA_NOREF)
 			continue;
 
+		if (evdev->frame_is_view) {
+			EvdevFrame *view = plugin->frame_view;
+
+			lua_rawgeti(plugin->L, LUA_REGISTRYINDEX, evdev->frame_refid);
+			lua_rawgeti(plugin->L, LUA_REGISTRYINDEX, evdev->refid);
+			lua_rawgeti(plugin->L,
+				    LUA_REGISTRYINDEX,
+				    plugin->frame_view_refid);
+			lua_pushinteger(plugin->L, evdev_frame_get_time(frame));
+
+			/* The view modifies the frame in-place, the return
+			 * value is ignored */
+			view->frame = frame;
+			view->evdev = evdev->evdev;
+			bool success = libinput_lua_pcall(plugin, 3, 0);
+			view->frame = NULL;
+			view->evdev = NULL;
+			if (!success)
+				return;
+			continue;
+		}
+
 		lua_rawgeti(plugin->L, LUA_REGISTRYINDEX, evdev->frame_refid);
 		lua_rawgeti(plugin->L, LUA_REGISTRYINDEX, evdev->refid);
 		lua_push_evdev_frame(plugin->L, frame);
@@ -896,12 +1000,14 @@ evdevdevice_connect(lua_State *L)
 
 	if (streq(name, "device-removed")) {
 		register_func(L, 3, &device->device_removed_refid);
-	} else if (streq(name, "evdev-frame")) {
+	} else if (streq(name, "evdev-frame") || streq(name, "evdev-frame-view")) {
 		struct libinput_lua_plugin *plugin = lua_get_libinput_lua_plugin(L);
 		libinput_plugin_enable_device_event_frame(plugin->parent,
 							  device->device,
 							  true);
+		/* Only one of the two can be connected at a time */
 		register_func(L, 3, &device->frame_refid);
+		device->frame_is_view = streq(name, "evdev-frame-view");
 	} else {
 		return luaL_error(L, "Unknown name: %s", name);
 	}
@@ -924,12 +1030,16 @@ evdevdevice_disconnect(lua_State *L)
 
 	if (streq(name, "device-removed")) {
 		unregister_func(L, &device->device_removed_refid);
-	} else if (streq(name, "evdev-frame")) {
+	} else if (streq(name, "evdev-frame") || streq(name, "evdev-frame-view")) {
+		if (device->frame_is_view != streq(name, "evdev-frame-view"))
+			return 0;
+
 		struct libinput_lua_plugin *plugin = lua_get_libinput_lua_plugin(L);
 		libinput_plugin_enable_device_event_frame(plugin->parent,
 							  device->device,
 							  false);
 		unregister_func(L, &device->frame_refid);
+		device->frame_is_view = false;
 	} else {
 		return luaL_error(L, "Unknown name: %s", name);
 	}
@@ -1075,6 +1185,153 @@ evdevdevice_init(lua_State *L)
 	luaL_setfuncs(L, evdevdevice_vtable, 0);
 }
 
+static EvdevFrame *
+evdevframe_check(lua_State *L)
+{
+	EvdevFrame *frame = luaL_checkudata(L, 1, EVDEV_FRAME_METATABLE);
+	luaL_argcheck(L, frame != NULL, 1, EVDEV_FRAME_METATABLE " expected");
+
+	if (!frame->frame)
+		luaL_error(L, "EvdevFrame used outside its evdev-frame-view callback");
+
+	return frame;
+}
+
+/* Returns the 0-based index of the event at the 1-based Lua index */
+static size_t
+evdevframe_check_index(lua_State *L, EvdevFrame *frame, int arg)
+{
+	lua_Integer index = luaL_checkinteger(L, arg);
+	size_t nevents = evdev_frame_get_count(frame->frame) - 1; /* SYN_REPORT */
+
+	luaL_argcheck(L,
+		      index >= 1 && (size_t)index <= nevents,
+		      arg,
+		      "index out of range");
+
+	return index - 1;
+}
+
+static int
+evdevframe_len(lua_State *L)
+{
+	EvdevFrame *frame = evdevframe_check(L);
+
+	lua_pushinteger(L, evdev_frame_get_count(frame->frame) - 1);
+
+	return 1;
+}
+
+static int
+evdevframe_usage(lua_State *L)
+{
+	EvdevFrame *frame = evdevframe_check(L);
+	size_t index = evdevframe_check_index(L, frame, 2);
+	struct evdev_event *events = evdev_frame_get_events(frame->frame, NULL);
+
+	lua_pushinteger(L, evdev_usage_as_uint32_t(events[index].usage));
+
+	return 1;
+}
+
+static int
+evdevframe_value(lua_State *L)
+{
+	EvdevFrame *frame = evdevframe_check(L);
+	size_t index = evdevframe_check_index(L, frame, 2);
+	struct evdev_event *events = evdev_frame_get_events(frame->frame, NULL);
+
+	lua_pushinteger(L, events[index].value);
+
+	return 1;
+}
+
+static int
+evdevframe_set_value(lua_State *L)
+{
+	EvdevFrame *frame = evdevframe_check(L);
+	size_t index = evdevframe_check_index(L, frame, 2);
+	int32_t value = luaL_checkinteger(L, 3);
+	struct evdev_event *events = evdev_frame_get_events(frame->frame, NULL);
+
+	events[index].value = value;
+
+	return 0;
+}
+
+static int
+evdevframe_append(lua_State *L)
+{
+	EvdevFrame *frame = evdevframe_check(L);
+	uint32_t usage_value = luaL_checkinteger(L, 2);
+	int32_t value = luaL_checkinteger(L, 3);
+
+	/* Like the table-based frames, usages the device doesn't have
+	 * are silently ignored */
+	evdev_usage_t usage = evdev_usage_from_uint32_t(usage_value);
+	if (!frame->evdev || !libevdev_has_event_code(frame->evdev,
+						      evdev_usage_type(usage),
+						      evdev_usage_code(usage)))
+		return 0;
+
+	if (evdev_frame_append_one(frame->frame, usage, value) == -ENOMEM)
+		plugin_log_bug(frame->plugin, "too many events in frame");
+
+	return 0;
+}
+
+static int
+evdevframe_clear(lua_State *L)
+{
+	EvdevFrame *frame = evdevframe_check(L);
+
+	evdev_frame_reset(frame->frame);
+
+	return 0;
+}
+
+static int
+evdevframe_events(lua_State *L)
+{
+	EvdevFrame *frame = evdevframe_check(L);
+
+	lua_push_evdev_frame(L, frame->frame);
+
+	return 1;
+}
+
+static const struct luaL_Reg evdevframe_vtable[] = {
+	{ "usage", evdevframe_usage },
+	{ "value", evdevframe_value },
+	{ "set_value", evdevframe_set_value },
+	{ "append", evdevframe_append },
+	{ "clear", evdevframe_clear },
+	{ "events", evdevframe_events },
+	{ "__len", evdevframe_len },
+	{ NULL, NULL }
+};
+
+static void
+evdevframe_init(lua_State *L)
+{
+	luaL_newmetatable(L, EVDEV_FRAME_METATABLE);
+	lua_pushstring(L, "__index");
+	lua_pushvalue(L, -2); /* push metatable */
+	lua_settable(L, -3);  /* metatable.__index = metatable */
+	luaL_setfuncs(L, evdevframe_vtable, 0);
+}
+
+static void *
+libinput_lua_alloc(void *user_data, void *ptr, size_t osize, size_t nsize)
+{
+	struct libinput_lua_plugin *plugin = user_data;
+
+	if (ptr == NULL && nsize > 0)
+		plugin->alloc.count++;
+
+	return plugin->alloc.func(plugin->alloc.user_data, ptr, osize, nsize);
+}
+
 static void
 libinput_lua_plugin_destroy(struct libinput_lua_plugin *plugin)
 {
@@ -1126,7 +1383,13 @@ libinput_lua_plugin_run(struct libinput_plugin *libinput_plugin)
 		return;
 	}
 
-	if (libinput_lua_pcall(plugin, 0, 0) && !plugin->register_called) {
+	if (!libinput_lua_pcall(plugin, 0, 0)) {
+		/* A budget overrun only aborts the call but a script that
+		 * never finished its top-level chunk is half set up */
+		if (plugin->timer)
+			libinput_plugin_timer_cancel(plugin->timer);
+		libinput_plugin_unregister(libinput_plugin);
+	} else if (!plugin->register_called) {
 		plugin_log_bug(libinput_plugin,
 			       "plugin never registered, unloading plugin\n");
 		libinput_plugin_unregister(libinput_plugin);
@@ -1211,6 +1474,13 @@ libinput_lua_plugin_init_lua(struct libinput *libinput,
 	if (!L)
 		return NULL;
 
+	plugin->alloc.func = lua_getallocf(L, &plugin->alloc.user_data);
+	lua_setallocf(L, libinput_lua_alloc, plugin);
+	lua_sethook(L,
+		    libinput_lua_budget_hook,
+		    LUA_MASKCOUNT,
+		    LUA_BUDGET_HOOK_INSTRUCTIONS);
+
 	/* This will be our _ENV later, see libinput_lua_pcall */
 	lua_newtable(L);
 	int sandbox_table_idx = lua_gettop(L);
@@ -1257,6 +1527,14 @@ libinput_lua_plugin_init_lua(struct libinput *libinput,
 	/* Our objects */
 	libinputplugin_init(L);
 	evdevdevice_init(L);
+	evdevframe_init(L);
+
+	/* The reusable frame view for evdev-frame-view callbacks */
+	plugin->frame_view = lua_newuserdata(L, sizeof(*plugin->frame_view));
+	*plugin->frame_view = (EvdevFrame){ .plugin = plugin->parent };
+	luaL_getmetatable(L, EVDEV_FRAME_METATABLE);
+	lua_setmetatable(L, -2);
+	plugin->frame_view_refid = luaL_ref(L, LUA_REGISTRYINDEX);
 
 	/* Our globals */
 	lua_newtable(L);
@@ -1281,8 +1559,179 @@ libinput_lua_plugin_init_lua(struct libinput *libinput,
 	return L;
 }
 
+/* Bump whenever the layout of the cache files changes */
+#define LUA_CACHE_MAGIC "libinput-lua-cache-1"
+
+static char *
+lua_cache_path(const char *cache_dir, const char *path)
+{
+	/* FNV-1a, collisions are harmless because the header contains
+	 * the full path */
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (const char *c = path; *c; c++) {
+		hash ^= (unsigned char)*c;
+		hash *= 0x100000001b3ULL;
+	}
+
+	return strdup_printf("%s/%016" PRIx64 ".luac", cache_dir, hash);
+}
+
+/**
+ * The header of a cache file, the cached chunk is only valid if this
+ * matches exactly.
+ */
+static char *
+lua_cache_header(const char *path, const struct stat *st)
+{
+	return strdup_printf("%s\n%s\n%lld.%09ld %lld\n%s\n",
+			     LUA_CACHE_MAGIC,
+			     LUA_VERSION_RELEASE,
+			     (long long)st->st_mtim.tv_sec,
+			     st->st_mtim.tv_nsec,
+			     (long long)st->st_size,
+			     path);
+}
+
+static bool
+lua_cache_load(struct libinput_lua_plugin *plugin,
+	       lua_State *L,
+	       const char *cache_dir,
+	       const char *path,
+	       const struct stat *st)
+{
+	_autofree_ char *cache_path = lua_cache_path(cache_dir, path);
+	_autofree_ char *header = lua_cache_header(path, st);
+	size_t header_len = strlen(header);
+
+	int fd = open(cache_path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	/* Bytecode is not verified when loaded, only trust files that
+	 * nobody but us could have written */
+	struct stat cache_st;
+	if (fstat(fd, &cache_st) < 0 || !S_ISREG(cache_st.st_mode) ||
+	    cache_st.st_uid != geteuid() || (cache_st.st_mode & (S_IWGRP | S_IWOTH)) ||
+	    (size_t)cache_st.st_size <= header_len) {
+		xclose(&fd);
+		return false;
+	}
+
+	size_t size = cache_st.st_size;
+	_autofree_ char *data = zalloc(size);
+	size_t nread = 0;
+	while (nread < size) {
+		ssize_t rc = read(fd, data + nread, size - nread);
+		if (rc <= 0)
+			break;
+		nread += rc;
+	}
+	xclose(&fd);
+
+	if (nread != size || memcmp(data, header, header_len) != 0)
+		return false;
+
+	/* Same chunkname as luaL_loadfile() so error messages are identical */
+	_autofree_ char *chunkname = strdup_printf("@%s", path);
+	if (luaL_loadbufferx(L,
+			     data + header_len,
+			     size - header_len,
+			     chunkname,
+			     "b") != LUA_OK) {
+		plugin_log_debug(plugin->parent,
+				 "ignoring cache file %s: %s\n",
+				 cache_path,
+				 lua_tostring(L, -1));
+		lua_pop(L, 1); /* the error message */
+		return false;
+	}
+
+	plugin_log_debug(plugin->parent, "loaded from cache %s\n", cache_path);
+
+	return true;
+}
+
+static int
+lua_cache_writer(lua_State *L, const void *p, size_t size, void *user_data)
+{
+	FILE *fp = user_data;
+
+	return fwrite(p, 1, size, fp) == size ? 0 : 1;
+}
+
+/**
+ * Write the chunk at the top of the stack to the cache. The file is
+ * written to a temporary file first so a concurrent reader never sees
+ * a partial file.
+ */
+static void
+lua_cache_store(struct libinput_lua_plugin *plugin,
+		lua_State *L,
+		const char *cache_dir,
+		const char *path,
+		const struct stat *st)
+{
+	if (mkdir_p(cache_dir) < 0)
+		return;
+
+	_autofree_ char *cache_path = lua_cache_path(cache_dir, path);
+	_autofree_ char *tmp_path = strdup_printf("%s.XXXXXX", cache_path);
+	_autofree_ char *header = lua_cache_header(path, st);
+
+	int fd = mkstemp(tmp_path);
+	if (fd < 0)
+		return;
+
+	FILE *fp = fdopen(fd, "w");
+	if (!fp) {
+		close(fd);
+		unlink(tmp_path);
+		return;
+	}
+
+	/* Don't strip debug information, it provides the line numbers in
+	 * error messages and the _ENV upvalue name for the sandbox */
+	bool success = fputs(header, fp) >= 0 &&
+		       lua_dump(L, lua_cache_writer, fp, 0) == 0;
+	success = (fclose(fp) == 0) && success;
+
+	if (!success || rename(tmp_path, cache_path) < 0) {
+		unlink(tmp_path);
+		return;
+	}
+
+	plugin_log_debug(plugin->parent, "stored in cache %s\n", cache_path);
+}
+
+/**
+ * Like luaL_loadfile() but uses the precompiled chunk in cache_dir where
+ * it is up-to-date and stores a newly compiled chunk there otherwise.
+ */
+static int
+lua_load_plugin_file(struct libinput_lua_plugin *plugin,
+		     lua_State *L,
+		     const char *path,
+		     const char *cache_dir)
+{
+	struct stat st;
+
+	if (!cache_dir || stat(path, &st) < 0)
+		return luaL_loadfile(L, path);
+
+	if (lua_cache_load(plugin, L, cache_dir, path, &st))
+		return LUA_OK;
+
+	int ret = luaL_loadfile(L, path);
+	if (ret == LUA_OK)
+		lua_cache_store(plugin, L, cache_dir, path, &st);
+
+	return ret;
+}
+
 struct libinput_plugin *
-libinput_lua_plugin_new_from_path(struct libinput *libinput, const char *path)
+libinput_lua_plugin_new_from_path(struct libinput *libinput,
+				  const char *path,
+				  const char *cache_dir)
 {
 	_destroy_(libinput_lua_plugin) *plugin = zalloc(sizeof(*plugin));
 	_autofree_ char *name = safe_strdup(safe_basename(path));
@@ -1298,6 +1747,7 @@ libinput_lua_plugin_new_from_path(struct libinput *libinput, const char *path)
 	plugin->version = LIBINPUT_PLUGIN_VERSION;
 	plugin->device_new_refid = LUA_NOREF;
 	plugin->timer_expired_refid = LUA_NOREF;
+	plugin->frame_view_refid = LUA_NOREF;
 	list_init(&plugin->evdev_devices);
 
 	_cleanup_(lua_closep) lua_State *L =
@@ -1310,7 +1760,7 @@ libinput_lua_plugin_new_from_path(struct libinput *libinput, const char *path)
 		return NULL;
 	}
 
-	int ret = luaL_loadfile(L, path);
+	int ret = lua_load_plugin_file(plugin, L, path, cache_dir);
 	if (ret == LUA_OK) {
 		plugin->L = steal(&L);
 
@@ -1356,3 +1806,12 @@ libinput_lua_plugin_new_from_path(struct libinput *libinput, const char *path)
 		return NULL;
 	}
 }
+
+size_t
+libinput_lua_plugin_get_allocations(struct libinput_plugin *libinput_plugin)
+{
+	struct libinput_lua_plugin *plugin =
+		libinput_plugin_get_user_data(libinput_plugin);
+
+	return plugin ? plugin->alloc.count : 0;
+}
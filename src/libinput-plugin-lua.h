@@ -28,5 +28,18 @@
 #include "libinput-plugin.h"
 #include "libinput.h"
 
+/**
+ * Load the plugin at path. If cache_dir is not NULL, the compiled chunk
+ * is cached in that directory and reused while the file is unchanged.
+ */
 struct libinput_plugin *
-libinput_lua_plugin_new_from_path(struct libinput *libinput, const char *path);
+libinput_lua_plugin_new_from_path(struct libinput *libinput,
+				  const char *path,
+				  const char *cache_dir);
+
+/**
+ * The number of allocations made by this plugin's Lua state since it
+ * was created. Used by the benchmarks to compare the frame protocols.
+ */
+size_t
+libinput_lua_plugin_get_allocations(struct libinput_plugin *plugin);
@@ -30,6 +30,29 @@
 #include "libinput-plugin.h"
 #include "src/evdev-frame.h"
 
+struct plugin_data {
+	/* Scratch frame for wheel_plugin_evdev_frame() */
+	struct evdev_frame *filtered_frame;
+};
+
+static void
+plugin_data_destroy(void *d)
+{
+	struct plugin_data *data = d;
+
+	evdev_frame_unref(data->filtered_frame);
+	free(data);
+}
+
+DEFINE_DESTROY_CLEANUP_FUNC(plugin_data);
+
+static void
+plugin_destroy(struct libinput_plugin *libinput_plugin)
+{
+	struct plugin_data *plugin = libinput_plugin_get_user_data(libinput_plugin);
+	plugin_data_destroy(plugin);
+}
+
 static void
 wheel_plugin_device_new(struct libinput_plugin *libinput_plugin,
 			struct libinput_device *device,
@@ -68,10 +91,12 @@ wheel_plugin_evdev_frame(struct libinput_plugin *libinput_plugin,
 			 struct libinput_device *device,
 			 struct evdev_frame *frame)
 {
+	struct plugin_data *plugin = libinput_plugin_get_user_data(libinput_plugin);
 	size_t nevents;
 	struct evdev_event *events = evdev_frame_get_events(frame, &nevents);
 
-	_unref_(evdev_frame) *filtered_frame = evdev_frame_new(nevents + 2);
+	struct evdev_frame *filtered_frame =
+		evdev_frame_reuse(&plugin->filtered_frame, nevents + 2);
 	for (size_t i = 0; i < nevents; i++) {
 		struct evdev_event *e = &events[i];
 
@@ -111,6 +136,7 @@ wheel_plugin_evdev_frame(struct libinput_plugin *libinput_plugin,
 }
 
 static const struct libinput_plugin_interface interface = {
+	.destroy = plugin_destroy,
 	.device_new = wheel_plugin_device_new,
 	.evdev_frame = wheel_plugin_evdev_frame,
 };
@@ -118,6 +144,9 @@ static const struct libinput_plugin_interface interface = {
 void
 libinput_mouse_plugin_wheel_lowres(struct libinput *libinput)
 {
-	_unref_(libinput_plugin) *p =
-		libinput_plugin_new(libinput, "mouse-wheel-lowres", &interface, NULL);
+	_destroy_(plugin_data) *plugin = zalloc(sizeof(*plugin));
+	_unref_(libinput_plugin) *p = libinput_plugin_new(libinput,
+							  "mouse-wheel-lowres",
+							  &interface,
+							  steal(&plugin));
 }
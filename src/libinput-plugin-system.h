@@ -38,8 +38,12 @@ enum libinput_feature;
 struct libinput;
 struct libinput_plugin;
 
+/* Limited by the bitmask_t of libinput_device.plugin_frame_callbacks */
+#define LIBINPUT_PLUGIN_MAX 32
+
 struct libinput_plugin_system {
 	char **directories; /* NULL once loaded == true */
+	char *cache_dir;    /* compiled Lua chunks, may be NULL */
 
 	bool loaded;
 	bool autoload;
@@ -48,6 +52,14 @@ struct libinput_plugin_system {
 	struct list removed_plugins;
 
 	size_t next_plugin_index; /* sequential index of all plugins */
+
+	/* Bumped whenever a plugin is registered or unregistered, see
+	 * libinput_device.plugin_pipeline */
+	uint64_t pipeline_generation;
+
+	/* Recycled struct plugin_queued_event, see plugin_queued_event_new() */
+	struct list free_events;
+	size_t nfree_events;
 };
 
 void
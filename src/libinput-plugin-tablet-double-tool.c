@@ -60,6 +60,9 @@ struct plugin_device {
 
 	int pen_value;
 	int eraser_value;
+
+	/* Scratch frame for double_tool_plugin_filter_frame() */
+	struct evdev_frame *frame_out;
 };
 
 struct plugin_data {
@@ -70,6 +73,7 @@ static void
 plugin_device_destroy(struct plugin_device *device)
 {
 	libinput_device_unref(device->device);
+	evdev_frame_unref(device->frame_out);
 	list_remove(&device->link);
 	free(device);
 }
@@ -96,8 +100,9 @@ plugin_destroy(struct libinput_plugin *libinput_plugin)
 	plugin_data_destroy(plugin);
 }
 
+/* Returns the device's scratch frame, only valid until the next call */
 static struct evdev_frame *
-double_tool_plugin_filter_frame(struct libinput_plugin *plugin,
+double_tool_plugin_filter_frame(struct plugin_device *device,
 				struct evdev_frame *frame_in,
 				enum tool_filter filter)
 {
@@ -105,7 +110,8 @@ double_tool_plugin_filter_frame(struct libinput_plugin *plugin,
 	struct evdev_event *events = evdev_frame_get_events(frame_in, &nevents);
 
 	/* +2 because we may add BTN_TOOL_PEN and BTN_TOOL_RUBBER */
-	struct evdev_frame *frame_out = evdev_frame_new(nevents + 2);
+	struct evdev_frame *frame_out =
+		evdev_frame_reuse(&device->frame_out, nevents + 2);
 	evdev_frame_set_time(frame_out, evdev_frame_get_time(frame_in));
 
 	for (size_t i = 0; i < nevents; i++) {
@@ -229,9 +235,9 @@ double_tool_plugin_device_handle_frame(struct libinput_plugin *libinput_plugin,
 	if (eraser_toggled) {
 		if (eraser_is_down && pen_is_down) {
 			if (!pen_toggled) {
-				_unref_(evdev_frame) *pen_out_of_prox =
+				struct evdev_frame *pen_out_of_prox =
 					double_tool_plugin_filter_frame(
-						libinput_plugin,
+						device,
 						frame,
 						SKIP_ERASER | PEN_OUT_OF_PROX);
 				libinput_plugin_prepend_evdev_frame(libinput_plugin,
@@ -239,11 +245,10 @@ double_tool_plugin_device_handle_frame(struct libinput_plugin *libinput_plugin,
 								    pen_out_of_prox);
 			}
 
-			_unref_(evdev_frame) *eraser_in_prox =
-				double_tool_plugin_filter_frame(libinput_plugin,
+			struct evdev_frame *eraser_in_prox =
+				double_tool_plugin_filter_frame(device,
 								frame,
-								SKIP_PEN |
-									ERASER_IN_PROX);
+								SKIP_PEN | ERASER_IN_PROX);
 
 			libinput_plugin_prepend_evdev_frame(libinput_plugin,
 							    device->device,
@@ -257,9 +262,9 @@ double_tool_plugin_device_handle_frame(struct libinput_plugin *libinput_plugin,
 
 			return;
 		} else if (!eraser_is_down) {
-			_unref_(evdev_frame) *eraser_out_of_prox =
+			struct evdev_frame *eraser_out_of_prox =
 				double_tool_plugin_filter_frame(
-					libinput_plugin,
+					device,
 					frame,
 					SKIP_PEN | ERASER_OUT_OF_PROX);
 
@@ -270,9 +275,9 @@ double_tool_plugin_device_handle_frame(struct libinput_plugin *libinput_plugin,
 			/* Only revert back to the pen if the pen was actually toggled
 			 * in this frame, otherwise it's just still set from before */
 			if (pen_toggled && pen_is_down) {
-				_unref_(evdev_frame) *pen_in_prox =
+				struct evdev_frame *pen_in_prox =
 					double_tool_plugin_filter_frame(
-						libinput_plugin,
+						device,
 						frame,
 						SKIP_ERASER | PEN_IN_PROX);
 				libinput_plugin_prepend_evdev_frame(libinput_plugin,
@@ -295,24 +300,24 @@ double_tool_plugin_device_handle_frame(struct libinput_plugin *libinput_plugin,
 	}
 
 	if (device->ignore_pen) {
-		_unref_(evdev_frame) *frame_out =
-			double_tool_plugin_filter_frame(libinput_plugin,
+		struct evdev_frame *frame_out =
+			double_tool_plugin_filter_frame(device,
 							frame,
 							SKIP_PEN);
 		size_t out_nevents;
 		evdev_frame_set(frame,
 				evdev_frame_get_events(frame_out, &out_nevents),
-				nevents);
+				out_nevents);
 		bitmask_set_bit(&device->tools_seen, TOOL_DOUBLE_TOOL);
 	} else if (pen_is_down) {
-		_unref_(evdev_frame) *frame_out =
-			double_tool_plugin_filter_frame(libinput_plugin,
+		struct evdev_frame *frame_out =
+			double_tool_plugin_filter_frame(device,
 							frame,
 							PEN_IN_PROX);
 		size_t out_nevents;
 		evdev_frame_set(frame,
 				evdev_frame_get_events(frame_out, &out_nevents),
-				nevents);
+				out_nevents);
 	}
 }
 
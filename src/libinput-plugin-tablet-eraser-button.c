@@ -91,6 +91,8 @@ struct plugin_device {
 	bool eraser_in_prox;
 
 	struct evdev_frame *last_frame;
+	/* Scratch frame for eraser_button_insert_frame() */
+	struct evdev_frame *frame_out;
 
 	enum libinput_config_eraser_button_mode mode;
 	/* The evdev code of the button to send */
@@ -111,6 +113,7 @@ plugin_device_destroy(struct plugin_device *device)
 	libinput_plugin_timer_unref(device->timer);
 	libinput_device_unref(device->device);
 	evdev_frame_unref(device->last_frame);
+	evdev_frame_unref(device->frame_out);
 	list_remove(&device->link);
 	free(device);
 }
@@ -188,7 +191,8 @@ eraser_button_insert_frame(struct plugin_device *device,
 	const struct evdev_event *events = evdev_frame_get_events(frame_in, &nevents);
 
 	/* +2 because we may add BTN_TOOL_PEN and BTN_TOOL_RUBBER */
-	_unref_(evdev_frame) *frame_out = evdev_frame_new(nevents + 2);
+	struct evdev_frame *frame_out =
+		evdev_frame_reuse(&device->frame_out, nevents + 2);
 
 	for (size_t i = 0; i < nevents; i++) {
 		struct evdev_event event = events[i];
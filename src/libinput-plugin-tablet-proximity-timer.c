@@ -260,6 +260,7 @@ proximity_timer_plugin_device_added(struct libinput_plugin *libinput_plugin,
 					  libinput_device_get_sysname(device),
 					  tablet_proximity_out_quirk_timer_func,
 					  pd);
+	libinput_plugin_timer_set_slack(pd->prox_out_timer, TIMER_SLACK_BACKGROUND);
 
 	list_take_append(&plugin->devices, pd, link);
 }
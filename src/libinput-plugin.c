@@ -64,9 +64,19 @@ struct libinput_plugin {
 	struct {
 		struct list *after;
 		struct list *before;
+		/* The frame passed to evdev_frame(), NULL in timers */
+		struct evdev_frame *current;
 	} event_queue;
 
 	struct evdev_mask *mask;
+
+	/* See libinput_plugin_account_call() */
+	struct {
+		uint64_t calls;
+		uint64_t total_us;
+		uint64_t max_us;
+		uint64_t overruns;
+	} stats;
 };
 
 struct libinput_plugin_timer {
@@ -118,8 +128,10 @@ libinput_plugin_new(struct libinput *libinput,
 	plugin->name = strdup(name);
 	list_init(&plugin->timers);
 
-	if (plugin->index >= 32) {
-		log_bug_libinput(libinput, "Too many plugins, maximum is 32\n");
+	if (plugin->index >= LIBINPUT_PLUGIN_MAX) {
+		log_bug_libinput(libinput,
+				 "Too many plugins, maximum is %d\n",
+				 LIBINPUT_PLUGIN_MAX);
 	}
 
 	libinput_plugin_system_register_plugin(&libinput->plugin_system, plugin);
@@ -186,6 +198,18 @@ libinput_plugin_get_name(struct libinput_plugin *plugin)
 	return plugin->name;
 }
 
+void
+libinput_plugin_account_call(struct libinput_plugin *plugin,
+			     uint64_t duration_us,
+			     bool budget_overrun)
+{
+	plugin->stats.calls++;
+	plugin->stats.total_us += duration_us;
+	plugin->stats.max_us = max(plugin->stats.max_us, duration_us);
+	if (budget_overrun)
+		plugin->stats.overruns++;
+}
+
 struct libinput *
 libinput_plugin_get_context(struct libinput_plugin *plugin)
 {
@@ -197,11 +221,22 @@ libinput_plugin_enable_device_event_frame(struct libinput_plugin *plugin,
 					  struct libinput_device *device,
 					  bool enable)
 {
+	if (plugin->index >= LIBINPUT_PLUGIN_MAX)
+		return;
+
+	if (bitmask_bit_is_set(device->plugin_frame_callbacks, plugin->index) ==
+	    enable)
+		return;
+
 	if (enable) {
 		bitmask_set_bit(&device->plugin_frame_callbacks, plugin->index);
 	} else {
 		bitmask_clear_bit(&device->plugin_frame_callbacks, plugin->index);
 	}
+
+	/* Rebuilding is cheap and this rarely changes, so invalidate all
+	 * pipelines rather than tracking this per device */
+	plugin->libinput->plugin_system.pipeline_generation++;
 }
 
 void
@@ -230,32 +265,86 @@ libinput_plugin_disable_device_feature(struct libinput_plugin *plugin,
 	bitmask_set_bit(&device->disabled_features, feature);
 }
 
+/* Upper bound of recycled queued events, more than this are only
+ * needed if plugins queue a lot of frames at once */
+#define PLUGIN_MAX_FREE_EVENTS 32
+
 struct plugin_queued_event {
 	struct list link;
 	struct evdev_frame *frame;      /* owns a ref */
 	struct libinput_device *device; /* owns a ref */
+	/* The frame was queued by a plugin that may still hold it, see
+	 * plugin_queued_event_unshare() */
+	bool shared;
 };
 
 static void
-plugin_queued_event_destroy(struct plugin_queued_event *event)
+plugin_queued_event_destroy(struct libinput_plugin_system *system,
+			    struct plugin_queued_event *event)
 {
 	evdev_frame_unref(event->frame);
 	libinput_device_unref(event->device);
 	list_remove(&event->link);
-	free(event);
+
+	if (system->nfree_events >= PLUGIN_MAX_FREE_EVENTS) {
+		free(event);
+		return;
+	}
+
+	list_append(&system->free_events, &event->link);
+	system->nfree_events++;
 }
 
+/**
+ * Every frame passes through one queued event per plugin, these are
+ * recycled so frame processing does not allocate.
+ */
 static inline struct plugin_queued_event *
-plugin_queued_event_new(struct evdev_frame *frame, struct libinput_device *device)
+plugin_queued_event_new(struct libinput_plugin_system *system,
+			struct evdev_frame *frame,
+			struct libinput_device *device)
 {
-	struct plugin_queued_event *event = zalloc(sizeof(*event));
+	struct plugin_queued_event *event;
+
+	if (system->nfree_events > 0) {
+		event = list_first_entry_by_type(&system->free_events,
+						 struct plugin_queued_event,
+						 link);
+		list_remove(&event->link);
+		system->nfree_events--;
+	} else {
+		event = zalloc(sizeof(*event));
+	}
 
 	event->frame = evdev_frame_ref(frame);
 	event->device = libinput_device_ref(device);
+	event->shared = false;
 
 	return event;
 }
 
+/**
+ * Plugins modify the frames they are passed. A frame queued by a plugin
+ * is not copied when queued but that plugin may keep it, e.g. as
+ * scratch frame, so it is replaced with a copy before the next plugin
+ * sees it if it is still referenced elsewhere.
+ */
+static inline void
+plugin_queued_event_unshare(struct plugin_queued_event *event)
+{
+	if (!event->shared)
+		return;
+
+	event->shared = false;
+
+	if (!evdev_frame_is_shared(event->frame))
+		return;
+
+	struct evdev_frame *clone = evdev_frame_clone(event->frame);
+	evdev_frame_unref(event->frame);
+	event->frame = clone;
+}
+
 static void
 libinput_plugin_queue_evdev_frame(struct list *queue,
 				  const char *func,
@@ -271,8 +360,20 @@ libinput_plugin_queue_evdev_frame(struct list *queue,
 		return;
 	}
 
-	_unref_(evdev_frame) *clone = evdev_frame_clone(frame);
-	struct plugin_queued_event *event = plugin_queued_event_new(clone, device);
+	struct libinput_plugin_system *system = &plugin->libinput->plugin_system;
+	struct plugin_queued_event *event;
+
+	/* Queued frames are only copied once the next plugin gets them
+	 * and only if this plugin still holds them. The current frame is
+	 * the exception, it is queued again once the plugin returns and the
+	 * plugin may still modify it. */
+	if (frame == plugin->event_queue.current) {
+		_unref_(evdev_frame) *clone = evdev_frame_clone(frame);
+		event = plugin_queued_event_new(system, clone, device);
+	} else {
+		event = plugin_queued_event_new(system, frame, device);
+		event->shared = true;
+	}
 	list_take_append(queue, event, link);
 }
 
@@ -374,6 +475,19 @@ libinput_plugin_system_append_path(struct libinput *libinput, const char *path)
 	plugin_system_append_path(&libinput->plugin_system, path);
 }
 
+LIBINPUT_EXPORT void
+libinput_plugin_system_set_cache_directory(struct libinput *libinput,
+					   const char *path)
+{
+	if (libinput->plugin_system.loaded) {
+		log_bug_client(libinput, "plugin system already initialized\n");
+		return;
+	}
+
+	free(libinput->plugin_system.cache_dir);
+	libinput->plugin_system.cache_dir = path ? safe_strdup(path) : NULL;
+}
+
 LIBINPUT_EXPORT void
 libinput_plugin_system_append_default_paths(struct libinput *libinput)
 {
@@ -404,6 +518,50 @@ libinput_plugin_system_autoload(struct libinput *libinput)
 	}
 }
 
+static struct libinput_plugin *
+plugin_system_get_plugin(struct libinput_plugin_system *system, size_t index)
+{
+	struct libinput_plugin *plugin;
+	list_for_each(plugin, &system->plugins, link) {
+		if (index-- == 0)
+			return plugin;
+	}
+	return NULL;
+}
+
+LIBINPUT_EXPORT const char *
+libinput_plugin_system_get_plugin_name(struct libinput *libinput, size_t index)
+{
+	struct libinput_plugin *plugin =
+		plugin_system_get_plugin(&libinput->plugin_system, index);
+
+	return plugin ? plugin->name : NULL;
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_plugin_system_get_plugin_stat(struct libinput *libinput,
+				       size_t index,
+				       enum libinput_plugin_stat stat)
+{
+	struct libinput_plugin *plugin =
+		plugin_system_get_plugin(&libinput->plugin_system, index);
+	if (!plugin)
+		return 0;
+
+	switch (stat) {
+	case LIBINPUT_PLUGIN_STAT_CALLS:
+		return plugin->stats.calls;
+	case LIBINPUT_PLUGIN_STAT_TIME_TOTAL_US:
+		return plugin->stats.total_us;
+	case LIBINPUT_PLUGIN_STAT_TIME_MAX_US:
+		return plugin->stats.max_us;
+	case LIBINPUT_PLUGIN_STAT_BUDGET_OVERRUNS:
+		return plugin->stats.overruns;
+	}
+
+	return 0;
+}
+
 LIBINPUT_EXPORT int
 libinput_plugin_system_load_plugins(struct libinput *libinput,
 				    enum libinput_plugin_system_flags flags)
@@ -421,7 +579,9 @@ libinput_plugin_system_load_plugins(struct libinput *libinput,
 	for (size_t i = 0; i < nfiles; i++) {
 		char *path = plugin_files[i];
 		log_debug(libinput, "Loading plugin from %s\n", path);
-		libinput_lua_plugin_new_from_path(libinput, path);
+		libinput_lua_plugin_new_from_path(libinput,
+						  path,
+						  libinput->plugin_system.cache_dir);
 	}
 #endif
 
@@ -453,6 +613,7 @@ libinput_plugin_system_register_plugin(struct libinput_plugin_system *system,
 {
 	libinput_plugin_ref(plugin);
 	list_append(&system->plugins, &plugin->link);
+	system->pipeline_generation++;
 }
 
 void
@@ -464,6 +625,7 @@ libinput_plugin_system_unregister_plugin(struct libinput_plugin_system *system,
 		if (p == plugin) {
 			list_remove(&plugin->link);
 			list_append(&system->removed_plugins, &plugin->link);
+			system->pipeline_generation++;
 			return;
 		}
 	}
@@ -491,6 +653,8 @@ libinput_plugin_system_init(struct libinput_plugin_system *system)
 #endif
 	list_init(&system->plugins);
 	list_init(&system->removed_plugins);
+	list_init(&system->free_events);
+	system->pipeline_generation = 1;
 }
 
 static void
@@ -530,7 +694,15 @@ libinput_plugin_system_destroy(struct libinput_plugin_system *system)
 
 	libinput_plugin_system_drop_unregistered_plugins(system);
 
+	struct plugin_queued_event *event;
+	list_for_each_safe(event, &system->free_events, link) {
+		list_remove(&event->link);
+		free(event);
+	}
+	system->nfree_events = 0;
+
 	strv_free(system->directories);
+	free(system->cache_dir);
 }
 
 void
@@ -629,23 +801,26 @@ libinput_plugin_process_frame(struct libinput_plugin *plugin,
 			      struct evdev_frame *frame,
 			      struct list *queued_events)
 {
+	struct libinput_plugin_system *system = &plugin->libinput->plugin_system;
 	struct list before_events = LIST_INIT(before_events);
 	struct list after_events = LIST_INIT(after_events);
 
 	plugin->event_queue.before = &before_events;
 	plugin->event_queue.after = &after_events;
+	plugin->event_queue.current = frame;
 
 	if (plugin->interface->evdev_frame)
 		plugin->interface->evdev_frame(plugin, device, frame);
 
 	plugin->event_queue.before = NULL;
 	plugin->event_queue.after = NULL;
+	plugin->event_queue.current = NULL;
 
 	list_chain(queued_events, &before_events);
 
 	if (!evdev_frame_is_empty(frame)) {
 		struct plugin_queued_event *event =
-			plugin_queued_event_new(frame, device);
+			plugin_queued_event_new(system, frame, device);
 		list_take_append(queued_events, event, link);
 	}
 
@@ -723,18 +898,47 @@ plugin_has_mask(struct libinput_plugin *plugin, struct evdev_frame *frame)
 	if (plugin->mask == NULL)
 		return true;
 
-	size_t nevents;
-	struct evdev_event *events = evdev_frame_get_events(frame, &nevents);
+	return evdev_mask_matches_frame(plugin->mask, frame);
+}
 
-	/* nevents - 1 because we don't check the SYN_REPORT */
-	for (size_t i = 0; i < nevents - 1; i++) {
-		struct evdev_event *e = &events[i];
+/**
+ * Rebuild the device's plugin pipeline if a plugin was (un)registered or
+ * changed its frame callbacks for this device since it was last built.
+ */
+static void
+plugin_pipeline_update(struct libinput_plugin_system *system,
+		       struct libinput_device *device)
+{
+	if (device->plugin_pipeline.generation == system->pipeline_generation)
+		return;
 
-		if (evdev_mask_is_set(plugin->mask, e->usage))
-			return true;
+	size_t nplugins = 0;
+	struct libinput_plugin *plugin;
+	list_for_each(plugin, &system->plugins, link) {
+		if (plugin->index < LIBINPUT_PLUGIN_MAX &&
+		    bitmask_bit_is_set(device->plugin_frame_callbacks, plugin->index))
+			device->plugin_pipeline.plugins[nplugins++] = plugin;
 	}
 
-	return false;
+	device->plugin_pipeline.nplugins = nplugins;
+	device->plugin_pipeline.generation = system->pipeline_generation;
+}
+
+/**
+ * Returns the position of the first plugin in the device's pipeline that
+ * comes after the plugin with the given index. Plugins are registered
+ * in index order so this is also the system's plugin order.
+ */
+static size_t
+plugin_pipeline_next(struct libinput_device *device, size_t index)
+{
+	size_t pos = 0;
+
+	while (pos < device->plugin_pipeline.nplugins &&
+	       device->plugin_pipeline.plugins[pos]->index <= index)
+		pos++;
+
+	return pos;
 }
 
 static void
@@ -751,25 +955,30 @@ plugin_system_notify_evdev_frame(struct libinput_plugin_system *system,
 	 * Each plugin then creates a new event list from each frame in the
 	 * queue.
 	 */
-	struct plugin_queued_event *our_event = plugin_queued_event_new(frame, device);
+	struct plugin_queued_event *our_event =
+		plugin_queued_event_new(system, frame, device);
 
 	struct list queued_events = LIST_INIT(queued_events);
 	list_take_insert(&queued_events, our_event, link);
 
 	uint64_t frame_time = evdev_frame_get_time(frame);
+	uint64_t read_time = evdev_frame_get_read_time(frame);
 
-	bool delay = !!sender_plugin;
+	plugin_pipeline_update(system, device);
 
-	struct libinput_plugin *plugin;
-	list_for_each_safe(plugin, &system->plugins, link) {
-		/* We start processing *after* the sender plugin. sender_plugin
-		 * is only set if we're queuing (not injecting) events from
-		 * a plugin timer func
-		 */
-		if (delay) {
-			delay = plugin != sender_plugin;
-			continue;
-		}
+	/* We start processing *after* the sender plugin. sender_plugin
+	 * is only set if we're queuing (not injecting) events from
+	 * a plugin timer func
+	 */
+	size_t pos = sender_plugin ? plugin_pipeline_next(device, sender_plugin->index)
+				   : 0;
+
+	while (pos < device->plugin_pipeline.nplugins) {
+		struct libinput_plugin *plugin = device->plugin_pipeline.plugins[pos];
+		/* The plugin may be gone once it returns, we only need its
+		 * index to find our position in the pipeline */
+		size_t index = plugin->index;
+		uint64_t generation = device->plugin_pipeline.generation;
 
 		/* The list of queued events for the *next* plugin */
 		struct list next_events = LIST_INIT(next_events);
@@ -784,12 +993,15 @@ plugin_system_notify_evdev_frame(struct libinput_plugin_system *system,
 		list_for_each_safe(event, &queued_events, link) {
 			struct list next = LIST_INIT(next);
 
+			plugin_queued_event_unshare(event);
+
 			if (evdev_frame_get_time(event->frame) == 0)
 				evdev_frame_set_time(event->frame, frame_time);
+			if (evdev_frame_get_read_time(event->frame) == 0)
+				evdev_frame_set_read_time(event->frame,
+							  read_time);
 
-			if (!bitmask_bit_is_set(device->plugin_frame_callbacks,
-						plugin->index) ||
-			    !plugin_has_mask(plugin, event->frame)) {
+			if (!plugin_has_mask(plugin, event->frame)) {
 				list_remove(&event->link);
 				list_append(&next_events, &event->link);
 				continue;
@@ -811,15 +1023,13 @@ plugin_system_notify_evdev_frame(struct libinput_plugin_system *system,
 						      &next);
 
 			list_chain(&next_events, &next);
-			plugin_queued_event_destroy(event);
+			plugin_queued_event_destroy(system, event);
 		}
 		assert(list_empty(&queued_events));
 		list_chain(&queued_events, &next_events);
 		if (list_empty(&queued_events)) {
 #ifdef EVENT_DEBUGGING
-			if (list_last_entry_by_type(&system->plugins,
-						    struct libinput_plugin,
-						    link) != plugin) {
+			if (pos + 1 < device->plugin_pipeline.nplugins) {
 				log_debug(
 					libinput_device_get_context(device),
 					"%s: --- empty frame queue - end of events ---\n",
@@ -829,6 +1039,14 @@ plugin_system_notify_evdev_frame(struct libinput_plugin_system *system,
 			/* No more events to process, stop here */
 			break;
 		}
+
+		/* The plugin may have changed which plugins see this device,
+		 * continue with whatever comes after it in the new pipeline */
+		plugin_pipeline_update(system, device);
+		if (device->plugin_pipeline.generation != generation)
+			pos = plugin_pipeline_next(device, index);
+		else
+			pos++;
 	}
 
 	/* Our own evdev plugin is last and discards the event for us */
@@ -870,11 +1088,12 @@ plugin_timer_func(uint64_t now, void *data)
 
 	struct plugin_queued_event *event;
 	list_for_each_safe(event, &before_events, link) {
+		plugin_queued_event_unshare(event);
 		plugin_system_notify_evdev_frame(&libinput->plugin_system,
 						 event->device,
 						 event->frame,
 						 plugin);
-		plugin_queued_event_destroy(event);
+		plugin_queued_event_destroy(&libinput->plugin_system, event);
 	}
 }
 
@@ -947,6 +1166,12 @@ libinput_plugin_timer_set(struct libinput_plugin_timer *timer, uint64_t expire)
 	libinput_timer_set(&timer->timer, expire);
 }
 
+void
+libinput_plugin_timer_set_slack(struct libinput_plugin_timer *timer, uint64_t slack)
+{
+	libinput_timer_set_slack(&timer->timer, slack);
+}
+
 void
 libinput_plugin_timer_cancel(struct libinput_plugin_timer *timer)
 {
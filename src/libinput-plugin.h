@@ -145,6 +145,16 @@ libinput_plugin_get_name(struct libinput_plugin *plugin);
 struct libinput *
 libinput_plugin_get_context(struct libinput_plugin *plugin);
 
+/**
+ * Account one call into this plugin that took duration_us, see
+ * libinput_plugin_system_get_plugin_stat(). This is used by plugins that
+ * run external code, built-in plugins are not accounted.
+ */
+void
+libinput_plugin_account_call(struct libinput_plugin *plugin,
+			     uint64_t duration_us,
+			     bool budget_overrun);
+
 void
 libinput_plugin_unregister(struct libinput_plugin *plugin);
 
@@ -293,6 +303,15 @@ libinput_plugin_inject_evdev_frame(struct libinput_plugin *libinput,
  * If both functions are used, all events from
  * libinput_plugin_prepend_evdev_frame() will be queued before
  * events from libinput_plugin_append_evdev_frame().
+ *
+ * The frame is not copied, the plugin system takes a reference. If the
+ * caller still holds a reference once the frame is passed to the next
+ * plugin, that plugin gets a copy instead, so later plugins never modify
+ * a frame the caller keeps. The caller must not modify the frame while
+ * it is queued. A plugin that re-uses a frame should obtain it through
+ * evdev_frame_reuse() which replaces the frame while it is still
+ * queued. The current frame passed to the evdev_frame() callback may be
+ * queued too, it is copied.
  */
 void
 libinput_plugin_append_evdev_frame(struct libinput_plugin *libinput,
@@ -351,6 +370,11 @@ DEFINE_UNREF_CLEANUP_FUNC(libinput_plugin_timer);
 void
 libinput_plugin_timer_set(struct libinput_plugin_timer *timer, uint64_t expire);
 
+/* Allow the timer to fire up to slack us late to share a wakeup with
+ * other timers, see libinput_timer_set_slack() */
+void
+libinput_plugin_timer_set_slack(struct libinput_plugin_timer *timer, uint64_t slack);
+
 void
 libinput_plugin_timer_set_user_data(struct libinput_plugin_timer *timer,
 				    void *user_data);
@@ -72,3 +72,33 @@ libinput_device_config_gesture_get_hold_default_enabled(struct libinput_device *
 
 	return device->config.gesture->get_hold_default(device);
 }
+
+static void
+libinput_clock_advance_func(struct libinput *libinput, void *data)
+{
+	uint64_t usec = *(uint64_t *)data;
+
+	__atomic_store_n(&libinput->clock.offset,
+			 libinput->clock.offset + usec,
+			 __ATOMIC_RELAXED);
+	libinput->clock.advanced = true;
+}
+
+void
+libinput_clock_advance(struct libinput *libinput, uint64_t usec)
+{
+	/* With an input thread, the clock is only changed on that thread.
+	 * The expired timers have fired and their events are queued by the
+	 * time this returns, see libinput_input_thread_call() */
+	libinput_input_thread_call(libinput, libinput_clock_advance_func, &usec);
+}
+
+uint64_t
+libinput_clock_now(struct libinput *libinput)
+{
+	uint64_t now = 0;
+
+	now_in_us(&now);
+
+	return now + libinput_clock_offset(libinput);
+}
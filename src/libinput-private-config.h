@@ -108,4 +108,38 @@ libinput_device_config_gesture_get_hold_enabled(struct libinput_device *device);
 enum libinput_config_hold_state
 libinput_device_config_gesture_get_hold_default_enabled(struct libinput_device *device);
 
+/**
+ * @ingroup base
+ *
+ * Move the clock of this context forward by the given number of
+ * microseconds. libinput's clock is CLOCK_MONOTONIC plus the sum of all
+ * calls to this function, the timestamps of kernel events are adjusted
+ * accordingly.
+ *
+ * Timers that expire within the skipped time fire in order on the next
+ * call to libinput_dispatch(), before any new events are read. This
+ * allows the test suite to trigger timeouts without sleeping.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param usec The time to skip in microseconds
+ *
+ * @see libinput_clock_now
+ */
+void
+libinput_clock_advance(struct libinput *libinput, uint64_t usec);
+
+/**
+ * @ingroup base
+ *
+ * Return the current time of this context's clock in microseconds, i.e.
+ * the time used for event timestamps.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The current time in microseconds
+ *
+ * @see libinput_clock_advance
+ */
+uint64_t
+libinput_clock_now(struct libinput *libinput);
+
 #endif /* LIBINPUT_PRIVATE_CONFIG_H */
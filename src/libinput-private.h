@@ -184,6 +184,16 @@ struct phys_ellipsis {
 	double minor;
 };
 
+/* Initial and minimum number of entries in the event queue */
+#define LIBINPUT_EVENT_QUEUE_MIN_LEN 4
+
+/* Number of size classes in the per-context event pool */
+#define LIBINPUT_EVENT_POOL_NCLASSES 3
+
+/* Number of log2 buckets in the per-device latency histograms */
+#define LIBINPUT_LATENCY_NBUCKETS 24
+#define LIBINPUT_LATENCY_NSTAGES LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT
+
 struct libinput_interface_backend {
 	int (*resume)(struct libinput *libinput);
 	void (*suspend)(struct libinput *libinput);
@@ -199,19 +209,56 @@ struct libinput {
 	struct list seat_list;
 
 	struct {
-		struct list list;
+		/* Armed timers as binary min-heap, ordered by expiry */
+		struct libinput_timer **heap;
+		size_t heap_count;
+		size_t heap_size;
+		uint64_t seqno;
+
 		struct libinput_source *source;
 		int fd;
-		uint64_t next_expiry;
+		uint64_t next_expiry; /* timerfd wakeup, including slack */
+		uint64_t wakeups;
 
 		struct ratelimit expiry_in_past_limit;
 	} timer;
 
+	struct {
+		uint8_t snapshot_counter;
+		unsigned int budget; /* frames per source per round, 0 = off */
+		struct list pending; /* sources that exceeded their budget */
+		uint64_t budget_hits;
+	} dispatch;
+
+	struct {
+		uint64_t touch_visits;
+		uint64_t touch_skips;
+		uint64_t taps;
+		uint64_t tap_timeouts;
+		uint64_t tap_cancels;
+	} touchpad;
+
 	struct libinput_event **events;
 	size_t events_count;
 	size_t events_len;
 	size_t events_in;
 	size_t events_out;
+	size_t events_max; /* 0 for unlimited */
+	size_t events_peak;
+	size_t events_recent_peak; /* since the queue was last empty */
+	uint64_t events_dropped;
+	struct ratelimit events_overflow_limit;
+
+	/* Recycled event structs, one singly-linked freelist per size
+	 * class. See event_pool_alloc() */
+	struct {
+		void *free[LIBINPUT_EVENT_POOL_NCLASSES];
+		size_t nfree[LIBINPUT_EVENT_POOL_NCLASSES];
+		size_t in_use;
+		size_t high_water_mark;
+		uint64_t hits;
+		uint64_t misses;
+	} event_pool;
 
 	struct list tool_list;
 
@@ -228,6 +275,27 @@ struct libinput {
 	uint64_t last_event_time;
 	uint64_t dispatch_time;
 
+	/* libinput's clock is CLOCK_MONOTONIC plus this offset, see
+	 * libinput_clock_advance(). Both are only written by the thread
+	 * that dispatches, the offset is read with libinput_clock_offset()
+	 * because the caller's thread reads it too. */
+	struct {
+		uint64_t offset;
+		bool advanced;
+	} clock;
+
+	bool latency_stats;
+	bool coalesce_motion;
+
+	/* NULL unless libinput_input_thread_start() was called */
+	struct libinput_input_thread *thread;
+
+	/* Created on the first libinput_set_io_uring_enabled() */
+	struct evdev_uring *uring;
+	bool io_uring_enabled;
+
+	bool bulk_read_enabled;
+
 	bool quirks_initialized;
 	struct quirks_context *quirks;
 
@@ -244,6 +312,12 @@ struct libinput {
 #endif
 };
 
+static inline uint64_t
+libinput_clock_offset(struct libinput *libinput)
+{
+	return __atomic_load_n(&libinput->clock.offset, __ATOMIC_RELAXED);
+}
+
 typedef void (*libinput_seat_destroy_func)(struct libinput_seat *seat);
 
 struct libinput_seat {
@@ -482,6 +556,17 @@ struct libinput_device_config_dwtp {
 		struct libinput_device *device);
 };
 
+struct libinput_device_config_pointer_prediction {
+	int (*is_available)(struct libinput_device *device);
+	enum libinput_config_status (*set_enabled)(
+		struct libinput_device *device,
+		enum libinput_config_pointer_prediction_state enable);
+	enum libinput_config_pointer_prediction_state (*get_enabled)(
+		struct libinput_device *device);
+	enum libinput_config_pointer_prediction_state (*get_default_enabled)(
+		struct libinput_device *device);
+};
+
 struct libinput_device_config_rotation {
 	int (*is_available)(struct libinput_device *device);
 	enum libinput_config_status (*set_angle)(struct libinput_device *device,
@@ -513,6 +598,7 @@ struct libinput_device_config {
 	struct libinput_device_config_middle_emulation *middle_emulation;
 	struct libinput_device_config_dwt *dwt;
 	struct libinput_device_config_dwtp *dwtp;
+	struct libinput_device_config_pointer_prediction *pointer_prediction;
 	struct libinput_device_config_rotation *rotation;
 	struct libinput_device_config_gesture *gesture;
 	struct libinput_device_config_3fg_drag *drag_3fg;
@@ -538,8 +624,33 @@ struct libinput_device {
 	char* devname;
 	int fd;
 
+	/* Only updated while libinput->latency_stats is set */
+	struct {
+		/* All stages but the last, updated by the thread that
+		 * processes events */
+		uint64_t histogram[LIBINPUT_LATENCY_NSTAGES - 1]
+				  [LIBINPUT_LATENCY_NBUCKETS];
+		/* LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT, updated by the
+		 * thread that retrieves the events. With an input thread
+		 * running, this is not the thread that writes histogram */
+		uint64_t dequeue_histogram[LIBINPUT_LATENCY_NBUCKETS];
+		/* Time the frame currently processed left the plugin
+		 * chain, 0 outside of frame processing */
+		uint64_t frame_exit_time;
+	} latency;
+
 #if !defined(__OpenBSD__) && !defined(__NetBSD__)
 	bitmask_t plugin_frame_callbacks;
+	/**
+	 * The registered plugins set in plugin_frame_callbacks, in plugin
+	 * order. Rebuilt before the next frame whenever generation does
+	 * not match the plugin system's pipeline_generation.
+	 */
+	struct {
+		struct libinput_plugin *plugins[LIBINPUT_PLUGIN_MAX];
+		size_t nplugins;
+		uint64_t generation;
+	} plugin_pipeline;
 	/**
 	 * Lua plugins see the device before our internal
 	 * plugins do any calls need to be cached.
@@ -690,6 +801,28 @@ struct libinput_tablet_pad_mode_group {
 struct libinput_event {
 	enum libinput_event_type type;
 	struct libinput_device *device;
+	uint64_t queue_time; /* for latency stats, 0 if unset */
+	/* Link in the input thread's stack of events to destroy */
+	struct libinput_event *returned_next;
+};
+
+/* Shared with the event queue for motion coalescing */
+struct libinput_event_pointer {
+	struct libinput_event base;
+	uint64_t time;
+	struct normalized_coords delta;
+	struct device_float_coords delta_raw;
+	struct device_coords absolute;
+	struct discrete_coords discrete;
+	struct wheel_v120 v120;
+	uint32_t button;
+	uint32_t seat_button_count;
+	enum libinput_button_state state;
+	enum libinput_pointer_axis_source source;
+	uint32_t axes;
+	/* Motion coalescing, see libinput_event_queue_push() */
+	uint64_t first_time;
+	uint32_t nmerged;
 };
 
 struct libinput_event_listener {
@@ -720,6 +853,49 @@ libinput_add_fd(struct libinput *libinput,
 void
 libinput_remove_source(struct libinput *libinput, struct libinput_source *source);
 
+void
+libinput_source_set_pending(struct libinput *libinput,
+			    struct libinput_source *source);
+
+void
+libinput_drop_destroyed_sources(struct libinput *libinput);
+
+int
+libinput_dispatch_sources(struct libinput *libinput);
+
+/**
+ * Queue the event, merging it into the previous motion event if motion
+ * coalescing is enabled or the queue is full. Takes a reference to the
+ * event's device.
+ *
+ * @return true if the event was queued, false if it was merged or
+ * dropped and must be released by the caller
+ */
+bool
+libinput_event_queue_push(struct libinput *libinput, struct libinput_event *event);
+
+/**
+ * Append the event to the ring buffer, growing it if needed. This does not
+ * take a reference to the event's device.
+ */
+bool
+libinput_event_queue_append(struct libinput *libinput,
+			    struct libinput_event *event);
+
+struct libinput_event *
+libinput_event_queue_peek(struct libinput *libinput);
+
+/**
+ * Remove up to max_events events from the front of the queue and shrink
+ * the ring buffer once it is drained.
+ *
+ * @return the number of events stored in events
+ */
+size_t
+libinput_event_queue_pop(struct libinput *libinput,
+			 struct libinput_event **events,
+			 size_t max_events);
+
 int
 open_restricted(struct libinput *libinput, const char *path, int flags);
 
@@ -1132,6 +1308,68 @@ point_in_rect(const struct device_coords *point, const struct device_coord_rect
 		point->y >= rect->y && point->y < rect->y + rect->h);
 }
 
+/**
+ * Return the latency histogram bucket for the latency between start and
+ * end (in us). Bucket 0 counts latencies of 0us, bucket n counts
+ * latencies within [2^(n-1), 2^n)us and the last bucket counts everything
+ * above.
+ */
+static inline size_t
+libinput_latency_bucket(uint64_t start, uint64_t end)
+{
+	uint64_t latency = end > start ? end - start : 0;
+	size_t bucket = 0;
+
+	while (latency > 0 && bucket < LIBINPUT_LATENCY_NBUCKETS - 1) {
+		latency >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+/**
+ * Add the latency between start and end (in us) to the device's histogram
+ * for the given stage. Must only be called by the thread that processes
+ * events, see libinput_device_note_dequeue_latency() for the last stage.
+ */
+static inline void
+libinput_device_note_latency(struct libinput_device *device,
+			     enum libinput_latency_stage stage,
+			     uint64_t start,
+			     uint64_t end)
+{
+	assert(stage < LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT);
+
+	device->latency.histogram[stage - 1][libinput_latency_bucket(start, end)]++;
+}
+
+/**
+ * Add the latency between an event being queued and being retrieved to
+ * the device's LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT histogram. Must
+ * only be called by the thread that retrieves the events.
+ */
+static inline void
+libinput_device_note_dequeue_latency(struct libinput_device *device,
+				     uint64_t queue_time,
+				     uint64_t now)
+{
+	device->latency.dequeue_histogram[libinput_latency_bucket(queue_time, now)]++;
+}
+
+/**
+ * Return the device's latency histogram for the given, valid, stage.
+ */
+static inline const uint64_t *
+libinput_device_latency_histogram(struct libinput_device *device,
+				  enum libinput_latency_stage stage)
+{
+	if (stage == LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT)
+		return device->latency.dequeue_histogram;
+
+	return device->latency.histogram[stage - 1];
+}
+
 #ifdef HAVE_LIBWACOM
 WacomDeviceDatabase *
 libinput_libwacom_ref(struct libinput *li);
@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2013 Jonas Ådahl
+ * Copyright © 2013-2018 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+
+#include "libinput-private.h"
+#include "timer.h"
+
+struct libinput_source {
+	libinput_source_dispatch_t dispatch;
+	void *user_data;
+	int fd;
+	bool pending; /* link is in libinput->dispatch.pending */
+	struct list link;
+};
+
+struct libinput_source *
+libinput_add_fd(struct libinput *libinput,
+		int fd,
+		libinput_source_dispatch_t dispatch,
+		void *user_data)
+{
+	struct libinput_source *source;
+	struct epoll_event ep;
+
+	source = zalloc(sizeof *source);
+	source->dispatch = dispatch;
+	source->user_data = user_data;
+	source->fd = fd;
+
+	memset(&ep, 0, sizeof ep);
+	ep.events = EPOLLIN;
+	ep.data.ptr = source;
+
+	if (epoll_ctl(libinput->epoll_fd, EPOLL_CTL_ADD, fd, &ep) < 0) {
+		free(source);
+		return NULL;
+	}
+
+	return source;
+}
+
+void
+libinput_remove_source(struct libinput *libinput, struct libinput_source *source)
+{
+	epoll_ctl(libinput->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
+	source->fd = -1;
+	if (source->pending) {
+		list_remove(&source->link);
+		source->pending = false;
+	}
+	list_insert(&libinput->source_destroy_list, &source->link);
+}
+
+/**
+ * Mark a source as having more data available after it used up its
+ * dispatch budget. libinput_dispatch() calls the source's dispatch
+ * function again once all other ready sources had their turn.
+ */
+void
+libinput_source_set_pending(struct libinput *libinput,
+			    struct libinput_source *source)
+{
+	if (source->pending || source->fd == -1)
+		return;
+
+	source->pending = true;
+	list_append(&libinput->dispatch.pending, &source->link);
+}
+
+void
+libinput_drop_destroyed_sources(struct libinput *libinput)
+{
+	struct libinput_source *source;
+
+	list_for_each_safe(source, &libinput->source_destroy_list, link)
+		free(source);
+	list_init(&libinput->source_destroy_list);
+}
+
+int
+libinput_dispatch_sources(struct libinput *libinput)
+{
+	struct libinput_source *source;
+	struct epoll_event ep[32];
+	struct list round;
+	int i, count;
+
+	/* Fire the timers that expired when the clock was moved forward
+	 * before reading any later events */
+	if (libinput->clock.advanced) {
+		libinput->clock.advanced = false;
+		libinput_timer_clock_changed(libinput);
+	}
+
+	/* Every 10 calls to libinput_dispatch() we take the current time so
+	 * we can check the delay between our current time and the event
+	 * timestamps */
+	if ((++libinput->dispatch.snapshot_counter % 10) == 0)
+		libinput->dispatch_time = libinput_now(libinput);
+	else if (libinput->dispatch_time)
+		libinput->dispatch_time = 0;
+
+	/* Without a dispatch budget no source is ever pending and this
+	 * is a single round. Otherwise, sources that used up their budget
+	 * get another turn after all other ready sources, until none has
+	 * data left. */
+	do {
+		list_init(&round);
+		list_chain(&round, &libinput->dispatch.pending);
+
+		count = epoll_wait(libinput->epoll_fd, ep, ARRAY_LENGTH(ep), 0);
+		if (count < 0) {
+			int err = -errno;
+
+			list_chain(&libinput->dispatch.pending, &round);
+			return err;
+		}
+
+		for (i = 0; i < count; ++i) {
+			source = ep[i].data.ptr;
+			if (source->fd == -1 || source->pending)
+				continue;
+
+			source->dispatch(source->user_data);
+		}
+
+		/* A dispatch func may remove any source from this list, so
+		 * always take the first one */
+		while (!list_empty(&round)) {
+			source = list_first_entry_by_type(&round,
+							  struct libinput_source,
+							  link);
+			list_remove(&source->link);
+			source->pending = false;
+			source->dispatch(source->user_data);
+		}
+	} while (!list_empty(&libinput->dispatch.pending));
+
+	libinput_drop_destroyed_sources(libinput);
+
+	return 0;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_dispatch_budget(struct libinput *libinput, unsigned int max_frames)
+{
+	libinput->dispatch.budget = max_frames;
+}
+
+LIBINPUT_EXPORT unsigned int
+libinput_get_dispatch_budget(struct libinput *libinput)
+{
+	return libinput->dispatch.budget;
+}
@@ -27,15 +27,19 @@
 #include <assert.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 #include "util-input-event.h"
 #include "util-libinput.h"
+#include "util-spsc.h"
 
 #include "evdev.h"
 #include "libinput-feature.h"
@@ -44,6 +48,10 @@
 #include "quirks.h"
 #include "timer.h"
 
+#ifdef HAVE_LIBURING
+#include "evdev-uring.h"
+#endif
+
 #define require_event_type(li_, type_, retval_, ...)	\
 	if (type_ == LIBINPUT_EVENT_NONE) abort(); \
 	if (!check_event_type(li_, __func__, type_, __VA_ARGS__, -1)) \
@@ -81,6 +89,7 @@ ASSERT_INT_SIZE(enum libinput_config_middle_emulation_state);
 ASSERT_INT_SIZE(enum libinput_config_scroll_method);
 ASSERT_INT_SIZE(enum libinput_config_dwt_state);
 ASSERT_INT_SIZE(enum libinput_config_dwtp_state);
+ASSERT_INT_SIZE(enum libinput_config_pointer_prediction_state);
 
 static inline const char *
 event_type_to_str(enum libinput_event_type type)
@@ -161,13 +170,6 @@ check_event_type(struct libinput *libinput,
 	return rc;
 }
 
-struct libinput_source {
-	libinput_source_dispatch_t dispatch;
-	void *user_data;
-	int fd;
-	struct list link;
-};
-
 struct libinput_event_device_notify {
 	struct libinput_event base;
 };
@@ -180,21 +182,6 @@ struct libinput_event_keyboard {
 	enum libinput_key_state state;
 };
 
-struct libinput_event_pointer {
-	struct libinput_event base;
-	uint64_t time;
-	struct normalized_coords delta;
-	struct device_float_coords delta_raw;
-	struct device_coords absolute;
-	struct discrete_coords discrete;
-	struct wheel_v120 v120;
-	uint32_t button;
-	uint32_t seat_button_count;
-	enum libinput_button_state state;
-	enum libinput_pointer_axis_source source;
-	uint32_t axes;
-};
-
 struct libinput_event_touch {
 	struct libinput_event base;
 	uint64_t time;
@@ -375,6 +362,75 @@ libinput_device_group_destroy(struct libinput_device_group *group);
 static void
 libinput_post_event(struct libinput *libinput, struct libinput_event *event);
 
+#define LIBINPUT_INPUT_THREAD_QUEUE_LEN 256
+
+struct libinput_input_thread {
+	pthread_t thread;
+	bool stop; /* atomic */
+
+	int wake_fd;  /* eventfd, caller to input thread */
+	int event_fd; /* eventfd, input thread to caller */
+
+	/* Events handed to the caller, the input thread is the producer */
+	struct spsc_queue events;
+	/* Lock-free stack of events destroyed by the caller, linked via
+	 * event->returned_next. The input thread frees them. */
+	struct libinput_event *returned;
+	/* Set when the input thread could not publish all events because
+	 * the queue was full */
+	bool blocked;
+
+	/* libinput_input_thread_call() */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	void (*call_func)(struct libinput *libinput, void *data);
+	void *call_data;
+	uint64_t call_serial;
+};
+
+/* The context whose input thread we are, set before that thread touches
+ * anything else. pthread_create() may return after the new thread has
+ * already started dispatching, so thread->thread cannot be used here. */
+static __thread struct libinput *libinput_input_thread_context;
+
+static inline bool
+libinput_input_thread_is_caller(struct libinput *libinput)
+{
+	return libinput->thread && libinput_input_thread_context != libinput;
+}
+
+/**
+ * Called by the caller after removing events from the queue.
+ */
+static inline void
+libinput_input_thread_unblock(struct libinput_input_thread *thread)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_exchange_n(&thread->blocked, false, __ATOMIC_SEQ_CST))
+		eventfd_write(thread->wake_fd, 1);
+}
+
+/**
+ * Hand the event back to the input thread, all device and tool refcounts
+ * are only ever modified by the input thread.
+ */
+static inline void
+libinput_input_thread_return_event(struct libinput_input_thread *thread,
+				   struct libinput_event *event)
+{
+	struct libinput_event *head =
+		__atomic_load_n(&thread->returned, __ATOMIC_RELAXED);
+
+	do {
+		event->returned_next = head;
+	} while (!__atomic_compare_exchange_n(&thread->returned,
+					      &head,
+					      event,
+					      true,
+					      __ATOMIC_RELEASE,
+					      __ATOMIC_RELAXED));
+}
+
 LIBINPUT_EXPORT enum libinput_event_type
 libinput_event_get_type(struct libinput_event *event)
 {
@@ -594,6 +650,28 @@ libinput_event_pointer_get_time_usec(struct libinput_event_pointer *event)
 	return event->time;
 }
 
+LIBINPUT_EXPORT uint64_t
+libinput_event_pointer_get_first_time_usec(struct libinput_event_pointer *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_POINTER_MOTION);
+
+	return event->nmerged ? event->first_time : event->time;
+}
+
+LIBINPUT_EXPORT uint32_t
+libinput_event_pointer_get_coalesced_count(struct libinput_event_pointer *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_POINTER_MOTION);
+
+	return event->nmerged + 1;
+}
+
 LIBINPUT_EXPORT double
 libinput_event_pointer_get_dx(struct libinput_event_pointer *event)
 {
@@ -1796,38 +1874,198 @@ libinput_event_switch_get_time_usec(struct libinput_event_switch *event)
 	return event->time;
 }
 
-struct libinput_source *
-libinput_add_fd(struct libinput *libinput,
-		int fd,
-		libinput_source_dispatch_t dispatch,
-		void *user_data)
+/* Event structs are recycled through a per-context pool of freelists,
+ * one per size class. Every event struct must fit into the largest
+ * class. */
+static const size_t event_pool_class_size[LIBINPUT_EVENT_POOL_NCLASSES] = {
+	64,
+	128,
+	256,
+};
+
+/* Maximum number of cached structs per size class, anything beyond
+ * that goes back to the allocator so a burst doesn't pin memory */
+#define EVENT_POOL_MAX_CACHED 256
+
+static_assert(sizeof(struct libinput_event_tablet_tool) <= 256,
+	      "event struct too large for the event pool");
+static_assert(sizeof(struct libinput_event_tablet_pad) <= 256,
+	      "event struct too large for the event pool");
+static_assert(sizeof(struct libinput_event_pointer) <= 256,
+	      "event struct too large for the event pool");
+static_assert(sizeof(struct libinput_event_gesture) <= 256,
+	      "event struct too large for the event pool");
+
+static size_t
+event_struct_size(enum libinput_event_type type)
 {
-	struct libinput_source *source;
-	struct epoll_event ep;
+	switch (type) {
+	case LIBINPUT_EVENT_NONE:
+		break;
+	case LIBINPUT_EVENT_DEVICE_ADDED:
+	case LIBINPUT_EVENT_DEVICE_REMOVED:
+		return sizeof(struct libinput_event_device_notify);
+	case LIBINPUT_EVENT_KEYBOARD_KEY:
+		return sizeof(struct libinput_event_keyboard);
+	case LIBINPUT_EVENT_POINTER_MOTION:
+	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
+	case LIBINPUT_EVENT_POINTER_BUTTON:
+	case LIBINPUT_EVENT_POINTER_AXIS:
+	case LIBINPUT_EVENT_POINTER_SCROLL_WHEEL:
+	case LIBINPUT_EVENT_POINTER_SCROLL_FINGER:
+	case LIBINPUT_EVENT_POINTER_SCROLL_CONTINUOUS:
+		return sizeof(struct libinput_event_pointer);
+	case LIBINPUT_EVENT_TOUCH_DOWN:
+	case LIBINPUT_EVENT_TOUCH_UP:
+	case LIBINPUT_EVENT_TOUCH_MOTION:
+	case LIBINPUT_EVENT_TOUCH_CANCEL:
+	case LIBINPUT_EVENT_TOUCH_FRAME:
+		return sizeof(struct libinput_event_touch);
+	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
+	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
+	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
+	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
+		return sizeof(struct libinput_event_tablet_tool);
+	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
+	case LIBINPUT_EVENT_TABLET_PAD_RING:
+	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
+	case LIBINPUT_EVENT_TABLET_PAD_KEY:
+	case LIBINPUT_EVENT_TABLET_PAD_DIAL:
+		return sizeof(struct libinput_event_tablet_pad);
+	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
+	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_END:
+	case LIBINPUT_EVENT_GESTURE_HOLD_BEGIN:
+	case LIBINPUT_EVENT_GESTURE_HOLD_END:
+		return sizeof(struct libinput_event_gesture);
+	case LIBINPUT_EVENT_SWITCH_TOGGLE:
+		return sizeof(struct libinput_event_switch);
+	}
 
-	source = zalloc(sizeof *source);
-	source->dispatch = dispatch;
-	source->user_data = user_data;
-	source->fd = fd;
+	abort();
+}
 
-	memset(&ep, 0, sizeof ep);
-	ep.events = EPOLLIN;
-	ep.data.ptr = source;
+static inline unsigned int
+event_pool_class(size_t size)
+{
+	for (unsigned int i = 0; i < ARRAY_LENGTH(event_pool_class_size); i++) {
+		if (size <= event_pool_class_size[i])
+			return i;
+	}
 
-	if (epoll_ctl(libinput->epoll_fd, EPOLL_CTL_ADD, fd, &ep) < 0) {
-		free(source);
-		return NULL;
+	abort();
+}
+
+/**
+ * Return a zeroed struct of at least size bytes, recycled from the pool
+ * if possible. The caller must post it as event, it is returned to the
+ * pool by libinput_event_destroy().
+ */
+static void *
+event_pool_alloc(struct libinput_device *device, size_t size)
+{
+	struct libinput *libinput = device->seat->libinput;
+	unsigned int class = event_pool_class(size);
+	void *event = libinput->event_pool.free[class];
+
+	if (event) {
+		libinput->event_pool.free[class] = *(void **)event;
+		libinput->event_pool.nfree[class]--;
+		libinput->event_pool.hits++;
+		memset(event, 0, size);
+	} else {
+		event = zalloc(event_pool_class_size[class]);
+		libinput->event_pool.misses++;
 	}
 
-	return source;
+	libinput->event_pool.in_use++;
+	libinput->event_pool.high_water_mark =
+		max(libinput->event_pool.high_water_mark,
+		    libinput->event_pool.in_use);
+
+	return event;
 }
 
-void
-libinput_remove_source(struct libinput *libinput, struct libinput_source *source)
+static void
+event_pool_release(struct libinput *libinput, struct libinput_event *event)
 {
-	epoll_ctl(libinput->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
-	source->fd = -1;
-	list_insert(&libinput->source_destroy_list, &source->link);
+	unsigned int class = event_pool_class(event_struct_size(event->type));
+
+	assert(libinput->event_pool.in_use > 0);
+	libinput->event_pool.in_use--;
+
+	if (libinput->event_pool.nfree[class] >= EVENT_POOL_MAX_CACHED) {
+		free(event);
+		return;
+	}
+
+	*(void **)event = libinput->event_pool.free[class];
+	libinput->event_pool.free[class] = event;
+	libinput->event_pool.nfree[class]++;
+}
+
+static void
+event_pool_destroy(struct libinput *libinput)
+{
+	for (unsigned int i = 0; i < LIBINPUT_EVENT_POOL_NCLASSES; i++) {
+		void *event = libinput->event_pool.free[i];
+
+		while (event) {
+			void *next = *(void **)event;
+			free(event);
+			event = next;
+		}
+
+		libinput->event_pool.free[i] = NULL;
+		libinput->event_pool.nfree[i] = 0;
+	}
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_get_stat(struct libinput *libinput, enum libinput_stat stat)
+{
+	switch (stat) {
+	case LIBINPUT_STAT_EVENT_POOL_HITS:
+		return libinput->event_pool.hits;
+	case LIBINPUT_STAT_EVENT_POOL_MISSES:
+		return libinput->event_pool.misses;
+	case LIBINPUT_STAT_EVENT_POOL_HIGH_WATER_MARK:
+		return libinput->event_pool.high_water_mark;
+	case LIBINPUT_STAT_DISPATCH_BUDGET_HITS:
+		return libinput->dispatch.budget_hits;
+	case LIBINPUT_STAT_EVENT_QUEUE_DEPTH:
+		return libinput->events_count;
+	case LIBINPUT_STAT_EVENT_QUEUE_PEAK_DEPTH:
+		return libinput->events_peak;
+	case LIBINPUT_STAT_EVENT_QUEUE_DROPPED:
+		return libinput->events_dropped;
+	case LIBINPUT_STAT_IO_URING_SUBMISSIONS:
+#ifdef HAVE_LIBURING
+		return libinput->uring ? evdev_uring_get_submissions(libinput->uring)
+				       : 0;
+#else
+		return 0;
+#endif
+	case LIBINPUT_STAT_TIMER_WAKEUPS:
+		return libinput->timer.wakeups;
+	case LIBINPUT_STAT_TOUCHPAD_TOUCH_VISITS:
+		return libinput->touchpad.touch_visits;
+	case LIBINPUT_STAT_TOUCHPAD_TOUCH_SKIPS:
+		return libinput->touchpad.touch_skips;
+	case LIBINPUT_STAT_TOUCHPAD_TAPS:
+		return libinput->touchpad.taps;
+	case LIBINPUT_STAT_TOUCHPAD_TAP_TIMEOUTS:
+		return libinput->touchpad.tap_timeouts;
+	case LIBINPUT_STAT_TOUCHPAD_TAP_CANCELS:
+		return libinput->touchpad.tap_cancels;
+	}
+
+	log_bug_client(libinput, "Invalid statistic %u\n", stat);
+
+	return 0;
 }
 
 int
@@ -1843,8 +2081,10 @@ libinput_init(struct libinput *libinput,
 	if (libinput->epoll_fd < 0)
 		return -1;
 
-	libinput->events_len = 4;
+	libinput->events_len = LIBINPUT_EVENT_QUEUE_MIN_LEN;
 	libinput->events = zalloc(libinput->events_len * sizeof(*libinput->events));
+	/* at most 5 "event queue full" log messages per hour */
+	ratelimit_init(&libinput->events_overflow_limit, s2us(60 * 60), 5);
 	libinput->log_handler = libinput_default_log_func;
 	libinput->log_priority = LIBINPUT_LOG_PRIORITY_ERROR;
 	libinput->interface = interface;
@@ -1852,6 +2092,7 @@ libinput_init(struct libinput *libinput,
 	libinput->user_data = user_data;
 	libinput->refcount = 1;
 	list_init(&libinput->source_destroy_list);
+	list_init(&libinput->dispatch.pending);
 	list_init(&libinput->seat_list);
 	list_init(&libinput->device_group_list);
 	list_init(&libinput->tool_list);
@@ -1911,16 +2152,6 @@ libinput_device_destroy(struct libinput_device *device);
 static void
 libinput_seat_destroy(struct libinput_seat *seat);
 
-static void
-libinput_drop_destroyed_sources(struct libinput *libinput)
-{
-	struct libinput_source *source;
-
-	list_for_each_safe(source, &libinput->source_destroy_list, link)
-		free(source);
-	list_init(&libinput->source_destroy_list);
-}
-
 LIBINPUT_EXPORT struct libinput *
 libinput_ref(struct libinput *libinput)
 {
@@ -1945,6 +2176,7 @@ libinput_unref(struct libinput *libinput)
 	if (libinput->refcount > 0)
 		return libinput;
 
+	libinput_input_thread_stop(libinput);
 	libinput_suspend(libinput);
 
 	libinput->interface_backend->destroy(libinput);
@@ -1971,10 +2203,14 @@ libinput_unref(struct libinput *libinput)
 		libinput_device_group_destroy(group);
 	}
 
+#ifdef HAVE_LIBURING
+	evdev_uring_destroy(libinput->uring);
+#endif
 	libinput_timer_subsys_destroy(libinput);
 	libinput_drop_destroyed_sources(libinput);
 	quirks_context_unref(libinput->quirks);
 	close(libinput->epoll_fd);
+	event_pool_destroy(libinput);
 	free(libinput);
 
 	return NULL;
@@ -2003,12 +2239,10 @@ libinput_event_tablet_pad_destroy(struct libinput_event_tablet_pad *event)
 		libinput_tablet_pad_mode_group_unref(event->mode_group);
 }
 
-LIBINPUT_EXPORT void
-libinput_event_destroy(struct libinput_event *event)
+/* Drop the references the event type holds, everything but the device */
+static void
+libinput_event_destroy_data(struct libinput_event *event)
 {
-	if (event == NULL)
-		return;
-
 	switch (event->type) {
 	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
 	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
@@ -2028,11 +2262,27 @@ libinput_event_destroy(struct libinput_event *event)
 	default:
 		break;
 	}
+}
+
+LIBINPUT_EXPORT void
+libinput_event_destroy(struct libinput_event *event)
+{
+	if (event == NULL)
+		return;
+
+	struct libinput *libinput = libinput_event_get_context(event);
+
+	if (libinput_input_thread_is_caller(libinput)) {
+		libinput_input_thread_return_event(libinput->thread, event);
+		return;
+	}
+
+	libinput_event_destroy_data(event);
 
 	if (event->device)
 		libinput_device_unref(event->device);
 
-	free(event);
+	event_pool_release(libinput, event);
 }
 
 int
@@ -2177,40 +2427,25 @@ libinput_device_disable_feature(struct libinput_device *device,
 LIBINPUT_EXPORT int
 libinput_get_fd(struct libinput *libinput)
 {
+	if (libinput->thread)
+		return libinput->thread->event_fd;
+
 	return libinput->epoll_fd;
 }
 
 LIBINPUT_EXPORT int
 libinput_dispatch(struct libinput *libinput)
 {
-	static uint8_t take_time_snapshot;
-	struct libinput_source *source;
-	struct epoll_event ep[32];
-	int i, count;
-
-	/* Every 10 calls to libinput_dispatch() we take the current time so
-	 * we can check the delay between our current time and the event
-	 * timestamps */
-	if ((++take_time_snapshot % 10) == 0)
-		libinput->dispatch_time = libinput_now(libinput);
-	else if (libinput->dispatch_time)
-		libinput->dispatch_time = 0;
-
-	count = epoll_wait(libinput->epoll_fd, ep, ARRAY_LENGTH(ep), 0);
-	if (count < 0)
-		return -errno;
-
-	for (i = 0; i < count; ++i) {
-		source = ep[i].data.ptr;
-		if (source->fd == -1)
-			continue;
-
-		source->dispatch(source->user_data);
-	}
+	if (libinput->thread) {
+		eventfd_t count;
 
-	libinput_drop_destroyed_sources(libinput);
+		/* The input thread does all the work, all that's left is
+		 * to reset the fd for the next wakeup */
+		eventfd_read(libinput->thread->event_fd, &count);
+		return 0;
+	}
 
-	return 0;
+	return libinput_dispatch_sources(libinput);
 }
 
 void
@@ -2343,6 +2578,18 @@ post_device_event(struct libinput_device *device,
 
 	init_event_base(event, device, type);
 
+	if (device->seat->libinput->latency_stats) {
+		uint64_t now = libinput_now(device->seat->libinput);
+
+		if (device->latency.frame_exit_time)
+			libinput_device_note_latency(
+				device,
+				LIBINPUT_LATENCY_STAGE_PLUGIN_EXIT_TO_QUEUE,
+				device->latency.frame_exit_time,
+				now);
+		event->queue_time = now;
+	}
+
 	list_for_each_safe(listener, &device->event_listeners, link)
 		listener->notify_func(time, event, listener->notify_func_data);
 
@@ -2357,7 +2604,7 @@ notify_added_device(struct libinput_device *device)
 
 	struct libinput_event_device_notify *added_device_event;
 
-	added_device_event = zalloc(sizeof *added_device_event);
+	added_device_event = event_pool_alloc(device, sizeof *added_device_event);
 
 	post_base_event(device, LIBINPUT_EVENT_DEVICE_ADDED, &added_device_event->base);
 
@@ -2376,7 +2623,7 @@ notify_removed_device(struct libinput_device *device)
 
 	struct libinput_event_device_notify *removed_device_event;
 
-	removed_device_event = zalloc(sizeof *removed_device_event);
+	removed_device_event = event_pool_alloc(device, sizeof *removed_device_event);
 
 	post_base_event(device,
 			LIBINPUT_EVENT_DEVICE_REMOVED,
@@ -2441,7 +2688,7 @@ keyboard_notify_key(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_KEYBOARD))
 		return;
 
-	key_event = zalloc(sizeof *key_event);
+	key_event = event_pool_alloc(device, sizeof *key_event);
 
 	seat_key_count = update_seat_key_count(device->seat, keycode, state);
 
@@ -2466,7 +2713,7 @@ pointer_notify_motion(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	motion_event = zalloc(sizeof *motion_event);
+	motion_event = event_pool_alloc(device, sizeof *motion_event);
 
 	*motion_event = (struct libinput_event_pointer){
 		.time = time,
@@ -2490,7 +2737,7 @@ pointer_notify_motion_absolute(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	motion_absolute_event = zalloc(sizeof *motion_absolute_event);
+	motion_absolute_event = event_pool_alloc(device, sizeof *motion_absolute_event);
 
 	*motion_absolute_event = (struct libinput_event_pointer){
 		.time = time,
@@ -2515,7 +2762,7 @@ pointer_notify_button(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	button_event = zalloc(sizeof *button_event);
+	button_event = event_pool_alloc(device, sizeof *button_event);
 
 	seat_button_count = update_seat_button_count(device->seat, button, state);
 
@@ -2545,8 +2792,8 @@ pointer_notify_axis_finger(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	axis_event = zalloc(sizeof *axis_event);
-	axis_event_legacy = zalloc(sizeof *axis_event_legacy);
+	axis_event = event_pool_alloc(device, sizeof *axis_event);
+	axis_event_legacy = event_pool_alloc(device, sizeof *axis_event_legacy);
 
 	*axis_event = (struct libinput_event_pointer){
 		.time = time,
@@ -2581,8 +2828,8 @@ pointer_notify_axis_continuous(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	axis_event = zalloc(sizeof *axis_event);
-	axis_event_legacy = zalloc(sizeof *axis_event_legacy);
+	axis_event = event_pool_alloc(device, sizeof *axis_event);
+	axis_event_legacy = event_pool_alloc(device, sizeof *axis_event_legacy);
 
 	*axis_event = (struct libinput_event_pointer){
 		.time = time,
@@ -2617,7 +2864,7 @@ pointer_notify_axis_legacy_wheel(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	axis_event = zalloc(sizeof *axis_event);
+	axis_event = event_pool_alloc(device, sizeof *axis_event);
 
 	*axis_event = (struct libinput_event_pointer){
 		.time = time,
@@ -2643,7 +2890,7 @@ pointer_notify_axis_wheel(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_POINTER))
 		return;
 
-	axis_event = zalloc(sizeof *axis_event);
+	axis_event = event_pool_alloc(device, sizeof *axis_event);
 
 	*axis_event = (struct libinput_event_pointer){
 		.time = time,
@@ -2675,7 +2922,7 @@ touch_notify_touch_down(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
-	touch_event = zalloc(sizeof *touch_event);
+	touch_event = event_pool_alloc(device, sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch){
 		.time = time,
@@ -2699,7 +2946,7 @@ touch_notify_touch_motion(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
-	touch_event = zalloc(sizeof *touch_event);
+	touch_event = event_pool_alloc(device, sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch){
 		.time = time,
@@ -2725,7 +2972,7 @@ touch_notify_touch_up(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
-	touch_event = zalloc(sizeof *touch_event);
+	touch_event = event_pool_alloc(device, sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch){
 		.time = time,
@@ -2747,7 +2994,7 @@ touch_notify_touch_cancel(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
-	touch_event = zalloc(sizeof *touch_event);
+	touch_event = event_pool_alloc(device, sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch){
 		.time = time,
@@ -2769,7 +3016,7 @@ touch_notify_frame(struct libinput_device *device, uint64_t time)
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_TOUCH))
 		return;
 
-	touch_event = zalloc(sizeof *touch_event);
+	touch_event = event_pool_alloc(device, sizeof *touch_event);
 
 	*touch_event = (struct libinput_event_touch){
 		.time = time,
@@ -2790,7 +3037,7 @@ tablet_notify_axis(struct libinput_device *device,
 {
 	struct libinput_event_tablet_tool *axis_event;
 
-	axis_event = zalloc(sizeof *axis_event);
+	axis_event = event_pool_alloc(device, sizeof *axis_event);
 
 	*axis_event = (struct libinput_event_tablet_tool){
 		.time = time,
@@ -2824,7 +3071,7 @@ tablet_notify_proximity(struct libinput_device *device,
 {
 	struct libinput_event_tablet_tool *proximity_event;
 
-	proximity_event = zalloc(sizeof *proximity_event);
+	proximity_event = event_pool_alloc(device, sizeof *proximity_event);
 
 	*proximity_event = (struct libinput_event_tablet_tool){
 		.time = time,
@@ -2857,7 +3104,7 @@ tablet_notify_tip(struct libinput_device *device,
 {
 	struct libinput_event_tablet_tool *tip_event;
 
-	tip_event = zalloc(sizeof *tip_event);
+	tip_event = event_pool_alloc(device, sizeof *tip_event);
 
 	*tip_event = (struct libinput_event_tablet_tool){
 		.time = time,
@@ -2890,7 +3137,7 @@ tablet_notify_button(struct libinput_device *device,
 	struct libinput_event_tablet_tool *button_event;
 	int32_t seat_button_count;
 
-	button_event = zalloc(sizeof *button_event);
+	button_event = event_pool_alloc(device, sizeof *button_event);
 
 	seat_button_count = update_seat_button_count(device->seat, button, state);
 
@@ -2923,7 +3170,7 @@ tablet_pad_notify_button(struct libinput_device *device,
 	struct libinput_event_tablet_pad *button_event;
 	unsigned int mode;
 
-	button_event = zalloc(sizeof *button_event);
+	button_event = event_pool_alloc(device, sizeof *button_event);
 
 	mode = libinput_tablet_pad_mode_group_get_mode(group);
 
@@ -2951,7 +3198,7 @@ tablet_pad_notify_dial(struct libinput_device *device,
 	struct libinput_event_tablet_pad *dial_event;
 	unsigned int mode;
 
-	dial_event = zalloc(sizeof *dial_event);
+	dial_event = event_pool_alloc(device, sizeof *dial_event);
 
 	mode = libinput_tablet_pad_mode_group_get_mode(group);
 
@@ -2980,7 +3227,7 @@ tablet_pad_notify_ring(struct libinput_device *device,
 	struct libinput_event_tablet_pad *ring_event;
 	unsigned int mode;
 
-	ring_event = zalloc(sizeof *ring_event);
+	ring_event = event_pool_alloc(device, sizeof *ring_event);
 
 	mode = libinput_tablet_pad_mode_group_get_mode(group);
 
@@ -3010,7 +3257,7 @@ tablet_pad_notify_strip(struct libinput_device *device,
 	struct libinput_event_tablet_pad *strip_event;
 	unsigned int mode;
 
-	strip_event = zalloc(sizeof *strip_event);
+	strip_event = event_pool_alloc(device, sizeof *strip_event);
 
 	mode = libinput_tablet_pad_mode_group_get_mode(group);
 
@@ -3037,7 +3284,7 @@ tablet_pad_notify_key(struct libinput_device *device,
 {
 	struct libinput_event_tablet_pad *key_event;
 
-	key_event = zalloc(sizeof *key_event);
+	key_event = event_pool_alloc(device, sizeof *key_event);
 
 	*key_event = (struct libinput_event_tablet_pad){
 		.time = time,
@@ -3067,7 +3314,7 @@ gesture_notify(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_GESTURE))
 		return;
 
-	gesture_event = zalloc(sizeof *gesture_event);
+	gesture_event = event_pool_alloc(device, sizeof *gesture_event);
 
 	*gesture_event = (struct libinput_event_gesture){
 		.time = time,
@@ -3201,7 +3448,7 @@ switch_notify_toggle(struct libinput_device *device,
 	if (!device_has_cap(device, LIBINPUT_DEVICE_CAP_SWITCH))
 		return;
 
-	switch_event = zalloc(sizeof *switch_event);
+	switch_event = event_pool_alloc(device, sizeof *switch_event);
 
 	*switch_event = (struct libinput_event_switch){
 		.time = time,
@@ -3228,61 +3475,102 @@ libinput_print_queued_event(struct libinput_event *event)
 		.show_keycodes = false,
 	};
 	struct libinput *libinput = libinput_event_get_context(event);
-	char *event_str = libinput_event_to_str(event, 0, &opts);
+	char event_buf[512];
+	_autofree_ char *event_alloc = NULL;
+	const char *event_str = libinput_event_format_fallback(event,
+							       0,
+							       &opts,
+							       event_buf,
+							       sizeof(event_buf),
+							       &event_alloc);
+
 	log_debug(libinput, "Queuing %s\n", event_str);
-	free(event_str);
 }
 
 static void
 libinput_post_event(struct libinput *libinput, struct libinput_event *event)
 {
-	struct libinput_event **events = libinput->events;
-	size_t events_len = libinput->events_len;
-	size_t events_count = libinput->events_count;
-	size_t move_len;
-	size_t new_out;
-
 #ifdef EVENT_DEBUGGING
 	libinput_print_queued_event(event);
 #endif
 
-	events_count++;
-	if (events_count > events_len) {
-		void *tmp;
-
-		events_len *= 2;
-		tmp = realloc(events, events_len * sizeof *events);
-		if (!tmp) {
-			log_error(libinput,
-				  "Failed to reallocate event ring buffer. "
-				  "Events may be discarded\n");
-			return;
-		}
+	if (!libinput_event_queue_push(libinput, event)) {
+		libinput_event_destroy_data(event);
+		event_pool_release(libinput, event);
+	}
+}
 
-		events = tmp;
-
-		if (libinput->events_count > 0 && libinput->events_in == 0) {
-			libinput->events_in = libinput->events_len;
-		} else if (libinput->events_count > 0 &&
-			   libinput->events_out >= libinput->events_in) {
-			move_len = libinput->events_len - libinput->events_out;
-			new_out = events_len - move_len;
-			memmove(events + new_out,
-				events + libinput->events_out,
-				move_len * sizeof *events);
-			libinput->events_out = new_out;
+LIBINPUT_EXPORT int
+libinput_set_io_uring_enabled(struct libinput *libinput, int enabled)
+{
+#ifdef HAVE_LIBURING
+	if (enabled && !libinput->uring) {
+		int rc = evdev_uring_new(libinput, &libinput->uring);
+		if (rc < 0) {
+			log_info(libinput,
+				 "io_uring is not available (%s)\n",
+				 strerror(-rc));
+			return rc;
 		}
+	}
+
+	libinput->io_uring_enabled = !!enabled;
+
+	return 0;
+#else
+	return enabled ? -ENOSYS : 0;
+#endif
+}
 
-		libinput->events = events;
-		libinput->events_len = events_len;
+LIBINPUT_EXPORT int
+libinput_get_io_uring_enabled(struct libinput *libinput)
+{
+	return libinput->io_uring_enabled;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_bulk_read_enabled(struct libinput *libinput, int enabled)
+{
+	libinput->bulk_read_enabled = !!enabled;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_bulk_read_enabled(struct libinput *libinput)
+{
+	return libinput->bulk_read_enabled;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_latency_stats_enabled(struct libinput *libinput, int enabled)
+{
+	libinput->latency_stats = !!enabled;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_latency_stats_enabled(struct libinput *libinput)
+{
+	return libinput->latency_stats;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_device_get_latency_histogram(struct libinput_device *device,
+				      enum libinput_latency_stage stage,
+				      uint64_t *buckets,
+				      size_t nbuckets)
+{
+	if (stage < LIBINPUT_LATENCY_STAGE_KERNEL_TO_READ ||
+	    stage > LIBINPUT_LATENCY_NSTAGES) {
+		log_bug_client(libinput_device_get_context(device),
+			       "Invalid latency stage %u\n",
+			       stage);
+		return 0;
 	}
 
-	if (event->device)
-		libinput_device_ref(event->device);
+	memcpy(buckets,
+	       libinput_device_latency_histogram(device, stage),
+	       min(nbuckets, (size_t)LIBINPUT_LATENCY_NBUCKETS) * sizeof(*buckets));
 
-	libinput->events_count = events_count;
-	events[libinput->events_in] = event;
-	libinput->events_in = (libinput->events_in + 1) % libinput->events_len;
+	return LIBINPUT_LATENCY_NBUCKETS;
 }
 
 LIBINPUT_EXPORT struct libinput_event *
@@ -3290,26 +3578,292 @@ libinput_get_event(struct libinput *libinput)
 {
 	struct libinput_event *event;
 
-	if (libinput->events_count == 0)
+	if (libinput->thread) {
+		event = spsc_queue_pop(&libinput->thread->events);
+		if (!event)
+			return NULL;
+
+		libinput_input_thread_unblock(libinput->thread);
+	} else if (libinput_event_queue_pop(libinput, &event, 1) == 0) {
 		return NULL;
+	}
 
-	event = libinput->events[libinput->events_out];
-	libinput->events_out = (libinput->events_out + 1) % libinput->events_len;
-	libinput->events_count--;
+	if (libinput->latency_stats && event->queue_time)
+		libinput_device_note_dequeue_latency(event->device,
+						     event->queue_time,
+						     libinput_now(libinput));
 
 	return event;
 }
 
+LIBINPUT_EXPORT size_t
+libinput_get_events(struct libinput *libinput,
+		    struct libinput_event **events,
+		    size_t max_events)
+{
+	size_t count = 0;
+
+	if (libinput->thread) {
+		while (count < max_events &&
+		       (events[count] = spsc_queue_pop(&libinput->thread->events)))
+			count++;
+
+		if (count == 0)
+			return 0;
+
+		libinput_input_thread_unblock(libinput->thread);
+	} else {
+		count = libinput_event_queue_pop(libinput, events, max_events);
+		if (count == 0)
+			return 0;
+	}
+
+	if (libinput->latency_stats) {
+		uint64_t now = libinput_now(libinput);
+
+		for (size_t i = 0; i < count; i++) {
+			if (events[i]->queue_time == 0)
+				continue;
+
+			libinput_device_note_dequeue_latency(events[i]->device,
+							     events[i]->queue_time,
+							     now);
+		}
+	}
+
+	return count;
+}
+
 LIBINPUT_EXPORT enum libinput_event_type
 libinput_next_event_type(struct libinput *libinput)
 {
 	struct libinput_event *event;
 
-	if (libinput->events_count == 0)
-		return LIBINPUT_EVENT_NONE;
+	if (libinput->thread)
+		event = spsc_queue_peek(&libinput->thread->events);
+	else
+		event = libinput_event_queue_peek(libinput);
 
-	event = libinput->events[libinput->events_out];
-	return event->type;
+	return event ? event->type : LIBINPUT_EVENT_NONE;
+}
+
+/* Input thread only. Free all events the caller destroyed */
+static void
+libinput_input_thread_reclaim(struct libinput_input_thread *thread)
+{
+	struct libinput_event *event =
+		__atomic_exchange_n(&thread->returned,
+				    NULL,
+				    __ATOMIC_ACQUIRE);
+
+	while (event) {
+		struct libinput_event *next = event->returned_next;
+
+		libinput_event_destroy(event);
+		event = next;
+	}
+}
+
+/**
+ * Input thread only. Move events from our queue to the one shared with
+ * the caller. If that one is full, the remaining events stay in our
+ * queue until the caller has caught up.
+ */
+static void
+libinput_input_thread_publish(struct libinput *libinput)
+{
+	struct libinput_input_thread *thread = libinput->thread;
+	struct libinput_event *event;
+	bool published = false;
+
+	while ((event = libinput_event_queue_peek(libinput))) {
+		if (!spsc_queue_push(&thread->events, event)) {
+			/* Ask for a wakeup, then try again in case the
+			 * caller emptied the queue before it could see the
+			 * flag */
+			__atomic_store_n(&thread->blocked, true, __ATOMIC_SEQ_CST);
+			__atomic_thread_fence(__ATOMIC_SEQ_CST);
+			if (!spsc_queue_push(&thread->events, event))
+				break;
+		}
+
+		libinput_event_queue_pop(libinput, &event, 1);
+		published = true;
+	}
+
+	if (published)
+		eventfd_write(thread->event_fd, 1);
+}
+
+/* Input thread only */
+static void
+libinput_input_thread_run_call(struct libinput *libinput)
+{
+	struct libinput_input_thread *thread = libinput->thread;
+
+	pthread_mutex_lock(&thread->lock);
+	if (thread->call_func) {
+		/* Process everything that is pending so func sees the same
+		 * state it would without an input thread. Anything func
+		 * triggered, e.g. timers expired by libinput_clock_advance(),
+		 * is published before the caller continues. */
+		libinput_dispatch_sources(libinput);
+		thread->call_func(libinput, thread->call_data);
+		thread->call_func = NULL;
+		libinput_dispatch_sources(libinput);
+		libinput_input_thread_publish(libinput);
+
+		thread->call_serial++;
+		pthread_cond_broadcast(&thread->cond);
+	}
+	pthread_mutex_unlock(&thread->lock);
+}
+
+static void *
+libinput_input_thread_func(void *data)
+{
+	struct libinput *libinput = data;
+	struct libinput_input_thread *thread = libinput->thread;
+	struct pollfd fds[] = {
+		{ .fd = libinput->epoll_fd, .events = POLLIN },
+		{ .fd = thread->wake_fd, .events = POLLIN },
+	};
+
+	libinput_input_thread_context = libinput;
+
+	while (!__atomic_load_n(&thread->stop, __ATOMIC_ACQUIRE)) {
+		eventfd_t count;
+
+		eventfd_read(thread->wake_fd, &count);
+
+		libinput_input_thread_reclaim(thread);
+		libinput_input_thread_run_call(libinput);
+		libinput_dispatch_sources(libinput);
+		libinput_input_thread_publish(libinput);
+
+		if (poll(fds, ARRAY_LENGTH(fds), -1) < 0 && errno != EINTR) {
+			log_bug_libinput(libinput,
+					 "input thread: poll failed (%s)\n",
+					 strerror(errno));
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+libinput_input_thread_destroy(struct libinput_input_thread *thread)
+{
+	pthread_cond_destroy(&thread->cond);
+	pthread_mutex_destroy(&thread->lock);
+	spsc_queue_fini(&thread->events);
+	if (thread->event_fd != -1)
+		close(thread->event_fd);
+	if (thread->wake_fd != -1)
+		close(thread->wake_fd);
+	free(thread);
+}
+
+LIBINPUT_EXPORT int
+libinput_input_thread_start(struct libinput *libinput)
+{
+	struct libinput_input_thread *thread;
+	int rc;
+
+	if (libinput->thread)
+		return -EALREADY;
+
+	thread = zalloc(sizeof(*thread));
+	thread->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	thread->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	pthread_mutex_init(&thread->lock, NULL);
+	pthread_cond_init(&thread->cond, NULL);
+
+	if (thread->wake_fd == -1 || thread->event_fd == -1) {
+		rc = -errno;
+		libinput_input_thread_destroy(thread);
+		return rc;
+	}
+
+	if (!spsc_queue_init(&thread->events, LIBINPUT_INPUT_THREAD_QUEUE_LEN)) {
+		libinput_input_thread_destroy(thread);
+		return -ENOMEM;
+	}
+
+	libinput->thread = thread;
+	rc = pthread_create(&thread->thread,
+			    NULL,
+			    libinput_input_thread_func,
+			    libinput);
+	if (rc != 0) {
+		libinput->thread = NULL;
+		libinput_input_thread_destroy(thread);
+		return -rc;
+	}
+
+	return 0;
+}
+
+LIBINPUT_EXPORT void
+libinput_input_thread_stop(struct libinput *libinput)
+{
+	struct libinput_input_thread *thread = libinput->thread;
+	struct libinput_event *event;
+
+	if (!thread)
+		return;
+
+	__atomic_store_n(&thread->stop, true, __ATOMIC_RELEASE);
+	eventfd_write(thread->wake_fd, 1);
+	pthread_join(thread->thread, NULL);
+
+	libinput->thread = NULL;
+	libinput_input_thread_reclaim(thread);
+
+	/* Events not yet fetched by the caller go back into our queue,
+	 * ahead of the ones that were never published */
+	size_t nunpublished = libinput->events_count;
+
+	while ((event = spsc_queue_pop(&thread->events))) {
+		if (!libinput_event_queue_append(libinput, event))
+			libinput_event_destroy(event);
+	}
+
+	for (size_t i = 0; i < nunpublished; i++) {
+		libinput_event_queue_pop(libinput, &event, 1);
+		if (!libinput_event_queue_append(libinput, event))
+			libinput_event_destroy(event);
+	}
+
+	libinput_input_thread_destroy(thread);
+}
+
+LIBINPUT_EXPORT void
+libinput_input_thread_call(struct libinput *libinput,
+			   void (*func)(struct libinput *libinput, void *data),
+			   void *data)
+{
+	struct libinput_input_thread *thread = libinput->thread;
+
+	if (!libinput_input_thread_is_caller(libinput)) {
+		func(libinput, data);
+		return;
+	}
+
+	pthread_mutex_lock(&thread->lock);
+	while (thread->call_func)
+		pthread_cond_wait(&thread->cond, &thread->lock);
+
+	uint64_t serial = thread->call_serial;
+
+	thread->call_func = func;
+	thread->call_data = data;
+	eventfd_write(thread->wake_fd, 1);
+
+	while (thread->call_serial == serial)
+		pthread_cond_wait(&thread->cond, &thread->lock);
+	pthread_mutex_unlock(&thread->lock);
 }
 
 LIBINPUT_EXPORT void
@@ -4958,6 +5512,50 @@ libinput_device_config_dwtp_get_default_enabled(struct libinput_device *device)
 	return device->config.dwtp->get_default_enabled(device);
 }
 
+LIBINPUT_EXPORT int
+libinput_device_config_pointer_prediction_is_available(struct libinput_device *device)
+{
+	if (!device->config.pointer_prediction)
+		return 0;
+
+	return device->config.pointer_prediction->is_available(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_pointer_prediction_set_enabled(
+	struct libinput_device *device,
+	enum libinput_config_pointer_prediction_state enable)
+{
+	if (enable != LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED &&
+	    enable != LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (!libinput_device_config_pointer_prediction_is_available(device))
+		return enable ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED
+			      : LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	return device->config.pointer_prediction->set_enabled(device, enable);
+}
+
+LIBINPUT_EXPORT enum libinput_config_pointer_prediction_state
+libinput_device_config_pointer_prediction_get_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_pointer_prediction_is_available(device))
+		return LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED;
+
+	return device->config.pointer_prediction->get_enabled(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_pointer_prediction_state
+libinput_device_config_pointer_prediction_get_default_enabled(
+	struct libinput_device *device)
+{
+	if (!libinput_device_config_pointer_prediction_is_available(device))
+		return LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED;
+
+	return device->config.pointer_prediction->get_default_enabled(device);
+}
+
 LIBINPUT_EXPORT int
 libinput_device_config_rotation_is_available(struct libinput_device *device)
 {
@@ -1305,6 +1305,47 @@ libinput_event_pointer_get_time(struct libinput_event_pointer *event);
 uint64_t
 libinput_event_pointer_get_time_usec(struct libinput_event_pointer *event);
 
+/**
+ * @ingroup event_pointer
+ *
+ * Return the time of the first motion event merged into this event, see
+ * libinput_set_motion_coalescing_enabled(). For events that are not the
+ * result of merging, this is the same as
+ * libinput_event_pointer_get_time_usec().
+ *
+ * For pointer events that are not of type @ref
+ * LIBINPUT_EVENT_POINTER_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events other
+ * than @ref LIBINPUT_EVENT_POINTER_MOTION.
+ *
+ * @return The time of the first merged event in microseconds
+ *
+ * @since 1.31
+ */
+uint64_t
+libinput_event_pointer_get_first_time_usec(struct libinput_event_pointer *event);
+
+/**
+ * @ingroup event_pointer
+ *
+ * Return the number of motion events merged into this event, see
+ * libinput_set_motion_coalescing_enabled(). For events that are not the
+ * result of merging, this is 1.
+ *
+ * For pointer events that are not of type @ref
+ * LIBINPUT_EVENT_POINTER_MOTION, this function returns 0.
+ *
+ * @note It is an application bug to call this function for events other
+ * than @ref LIBINPUT_EVENT_POINTER_MOTION.
+ *
+ * @return The number of motion events merged into this event
+ *
+ * @since 1.31
+ */
+uint32_t
+libinput_event_pointer_get_coalesced_count(struct libinput_event_pointer *event);
+
 /**
  * @ingroup event_pointer
  *
@@ -3762,6 +3803,30 @@ libinput_plugin_system_append_path(struct libinput *libinput, const char *path);
 void
 libinput_plugin_system_append_default_paths(struct libinput *libinput);
 
+/**
+ * @ingroup base
+ *
+ * Set the directory to cache compiled plugins in. Where a plugin has a
+ * cached compiled version that is newer than the plugin file, the cached
+ * version is used instead of compiling the plugin again. This reduces the
+ * time it takes to load plugins, e.g. for compositors that restart often.
+ *
+ * The directory is created if it does not exist. Cached files are
+ * only used if they are owned by the effective user id of the process and
+ * not writable by anyone else. The caller should use a directory that
+ * only this user can write to, e.g. below `$XDG_CACHE_HOME`.
+ *
+ * By default no cache directory is set and plugins are compiled each
+ * time they are loaded. A path of NULL disables the cache.
+ *
+ * This function must be called before libinput_plugin_system_load_plugins().
+ *
+ * @since 1.31
+ */
+void
+libinput_plugin_system_set_cache_directory(struct libinput *libinput,
+					   const char *path);
+
 enum libinput_plugin_system_flags {
 	LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE = 0,
 };
@@ -3796,6 +3861,76 @@ int
 libinput_plugin_system_load_plugins(struct libinput *libinput,
 				    enum libinput_plugin_system_flags flags);
 
+/**
+ * @ingroup base
+ *
+ * Per-plugin statistics counters, see
+ * libinput_plugin_system_get_plugin_stat().
+ *
+ * @since 1.31
+ */
+enum libinput_plugin_stat {
+	/**
+	 * The number of times libinput called into the plugin.
+	 */
+	LIBINPUT_PLUGIN_STAT_CALLS = 1,
+	/**
+	 * The cumulative CPU time spent in the plugin, in microseconds.
+	 */
+	LIBINPUT_PLUGIN_STAT_TIME_TOTAL_US,
+	/**
+	 * The most CPU time spent in a single call into the plugin, in
+	 * microseconds.
+	 */
+	LIBINPUT_PLUGIN_STAT_TIME_MAX_US,
+	/**
+	 * The number of calls into the plugin that were aborted because
+	 * they exceeded the per-call CPU budget. A plugin that exceeds the
+	 * budget repeatedly is unloaded.
+	 */
+	LIBINPUT_PLUGIN_STAT_BUDGET_OVERRUNS,
+};
+
+/**
+ * @ingroup base
+ *
+ * Return the name of the plugin at the given index. Plugins are indexed
+ * in the order they process events, starting at 0. Plugins that were
+ * unloaded are not included.
+ *
+ * This function is intended for debugging and profiling, see
+ * libinput_plugin_system_get_plugin_stat().
+ *
+ * @param libinput A previously initialized libinput context
+ * @param index The index of the plugin
+ * @return The name of the plugin or NULL if the index is out of range
+ *
+ * @since 1.31
+ */
+const char *
+libinput_plugin_system_get_plugin_name(struct libinput *libinput, size_t index);
+
+/**
+ * @ingroup base
+ *
+ * Return the current value of the given statistics counter for the plugin
+ * at the given index, see libinput_plugin_system_get_plugin_name().
+ * Counters are only maintained for plugins loaded from a file, libinput's
+ * built-in plugins always return 0.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param index The index of the plugin
+ * @param stat The counter to query
+ * @return The current value of the counter or 0 if the index or counter
+ * is invalid
+ *
+ * @since 1.31
+ */
+uint64_t
+libinput_plugin_system_get_plugin_stat(struct libinput *libinput,
+				       size_t index,
+				       enum libinput_plugin_stat stat);
+
 /**
  * @ingroup base
  *
@@ -3827,6 +3962,283 @@ libinput_get_fd(struct libinput *libinput);
 int
 libinput_dispatch(struct libinput *libinput);
 
+/**
+ * @ingroup base
+ *
+ * Limit the number of evdev frames (a set of events terminated by a
+ * SYN_REPORT) processed for a single device before libinput moves on to
+ * the next device with pending data.
+ *
+ * By default libinput_dispatch() processes all data available on a
+ * device before looking at the next device. A device that sends events
+ * at a high rate, e.g. a gaming mouse with a high polling rate, can thus
+ * delay the processing of events from other devices. With a nonzero
+ * budget, libinput_dispatch() processes at most max_frames frames per
+ * device at a time and visits all devices with pending data round-robin
+ * until no data is left. libinput_dispatch() still processes all
+ * available data before it returns.
+ *
+ * The number of times a device exhausted its budget is available as @ref
+ * LIBINPUT_STAT_DISPATCH_BUDGET_HITS.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param max_frames The maximum number of frames per device per round, or
+ * 0 to disable the limit
+ *
+ * @see libinput_get_dispatch_budget
+ *
+ * @since 1.31
+ */
+void
+libinput_set_dispatch_budget(struct libinput *libinput, unsigned int max_frames);
+
+/**
+ * @ingroup base
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The per-device frame budget as set by
+ * libinput_set_dispatch_budget(), 0 if unlimited.
+ *
+ * @since 1.31
+ */
+unsigned int
+libinput_get_dispatch_budget(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable merging of adjacent @ref LIBINPUT_EVENT_POINTER_MOTION
+ * events in the event queue.
+ *
+ * If enabled and a motion event is queued while the most recent event in
+ * the queue is a motion event from the same device, the new event's
+ * accelerated and unaccelerated deltas are added to the queued event
+ * instead of queuing a new event. The merged event carries the time of the
+ * most recent motion event, the time of the first merged event is
+ * available with libinput_event_pointer_get_first_time_usec().
+ *
+ * Events are never merged across any other event, e.g. a button or
+ * scroll event, and events already retrieved with libinput_get_event() are
+ * never modified.
+ *
+ * This reduces the number of events a caller has to process after it
+ * was unable to call libinput_dispatch() for some time. Motion
+ * coalescing is disabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enabled Nonzero to enable motion coalescing, zero to disable
+ *
+ * @since 1.31
+ */
+void
+libinput_set_motion_coalescing_enabled(struct libinput *libinput, int enabled);
+
+/**
+ * @ingroup base
+ *
+ * @param libinput A previously initialized libinput context
+ * @return Nonzero if motion coalescing is enabled, zero otherwise
+ *
+ * @see libinput_set_motion_coalescing_enabled
+ *
+ * @since 1.31
+ */
+int
+libinput_get_motion_coalescing_enabled(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Limit the number of events in the event queue. By default the event
+ * queue grows as needed to hold all events until the caller retrieves
+ * them with libinput_get_event().
+ *
+ * Once the limit is reached, a new @ref LIBINPUT_EVENT_POINTER_MOTION
+ * event is merged into the most recently queued event if that is a motion
+ * event from the same device, as if motion coalescing was enabled (see
+ * libinput_set_motion_coalescing_enabled()). Otherwise the new event is
+ * discarded and counted as @ref LIBINPUT_STAT_EVENT_QUEUE_DROPPED.
+ * @ref LIBINPUT_EVENT_DEVICE_ADDED and @ref LIBINPUT_EVENT_DEVICE_REMOVED
+ * events are never discarded and may exceed the limit.
+ *
+ * Discarding events may leave the caller with an inconsistent state, e.g.
+ * a button release without the matching press. Callers should set a limit
+ * large enough that it is only reached when they failed to call
+ * libinput_dispatch() and libinput_get_event() for a long time.
+ *
+ * Setting a limit lower than the current number of queued events does not
+ * discard any already queued events.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param max_events The maximum number of queued events, or 0 for no limit
+ *
+ * @since 1.31
+ */
+void
+libinput_set_event_queue_limit(struct libinput *libinput, size_t max_events);
+
+/**
+ * @ingroup base
+ *
+ * @param libinput A previously initialized libinput context
+ * @return The maximum number of queued events as set with
+ * libinput_set_event_queue_limit(), or 0 if unlimited
+ *
+ * @since 1.31
+ */
+size_t
+libinput_get_event_queue_limit(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Read from devices through io_uring instead of polling each device fd
+ * separately. With io_uring, the reads for all devices that have events
+ * pending are submitted in a single syscall. This is beneficial when many
+ * devices are in use at the same time.
+ *
+ * This only affects devices added or resumed after this call, devices
+ * already in use keep their current backend until they are suspended.
+ * io_uring is disabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enabled Non-zero to read from devices through io_uring
+ * @return 0 on success, -ENOSYS if libinput was built without io_uring
+ * support or a negative errno if io_uring cannot be used, e.g. because the
+ * kernel does not support it
+ *
+ * @since 1.31
+ */
+int
+libinput_set_io_uring_enabled(struct libinput *libinput, int enabled);
+
+/**
+ * @ingroup base
+ *
+ * @param libinput A previously initialized libinput context
+ * @return Non-zero if newly added devices are read through io_uring
+ *
+ * @see libinput_set_io_uring_enabled
+ *
+ * @since 1.31
+ */
+int
+libinput_get_io_uring_enabled(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Read events from the device in bulk and update libinput's view of the
+ * device state directly instead of processing each event through
+ * libevdev. This reduces the per-event overhead for devices with a high
+ * event rate, e.g. gaming mice or multitouch screens. Events are
+ * processed identically either way, after a @c SYN_DROPPED libinput
+ * falls back to libevdev until the device is back in sync.
+ *
+ * This only affects devices added or resumed after this call, devices
+ * already in use keep their current read path until they are suspended.
+ * Devices read via io_uring (see libinput_set_io_uring_enabled()) are not
+ * affected. Bulk reads are disabled by default.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enabled Non-zero to read events in bulk
+ *
+ * @since 1.31
+ */
+void
+libinput_set_bulk_read_enabled(struct libinput *libinput, int enabled);
+
+/**
+ * @ingroup base
+ *
+ * @param libinput A previously initialized libinput context
+ * @return Non-zero if newly added devices are read in bulk
+ *
+ * @see libinput_set_bulk_read_enabled
+ *
+ * @since 1.31
+ */
+int
+libinput_get_bulk_read_enabled(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Move all event processing into a dedicated input thread. The input
+ * thread reads from the devices, runs timers and plugins and hands the
+ * resulting events to the caller through a lock-free queue, so event
+ * processing is not delayed while the caller's thread is busy.
+ *
+ * While the input thread is running, the caller may only use
+ * libinput_get_fd(), libinput_dispatch(), libinput_get_event(),
+ * libinput_get_events(), libinput_next_event_type(), the event accessor
+ * functions and libinput_event_destroy() directly. libinput_get_fd()
+ * returns a different file descriptor that becomes readable when events
+ * are available, callers must re-fetch it after starting or stopping the
+ * input thread. libinput_dispatch() only resets that file descriptor.
+ *
+ * Any other function, including device and seat configuration and
+ * reference counting, must be called from within
+ * libinput_input_thread_call(). The log handler and the interface's
+ * open_restricted/close_restricted are called from the input thread.
+ *
+ * This function is not available on all platforms.
+ *
+ * @param libinput A previously initialized libinput context
+ * @return 0 on success, a negative errno on failure, -EALREADY if the
+ * input thread is already running or -ENOSYS if not supported
+ *
+ * @see libinput_input_thread_stop
+ *
+ * @since 1.31
+ */
+int
+libinput_input_thread_start(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Stop the input thread started with libinput_input_thread_start() and
+ * return to processing events in libinput_dispatch(). Events not yet
+ * retrieved by the caller remain in the event queue in their original
+ * order. If no input thread is running, this function does nothing.
+ *
+ * This function is called automatically when the last reference to the
+ * context is dropped.
+ *
+ * @param libinput A previously initialized libinput context
+ *
+ * @since 1.31
+ */
+void
+libinput_input_thread_stop(struct libinput *libinput);
+
+/**
+ * @ingroup base
+ *
+ * Call func on the input thread and wait until it has returned. If no
+ * input thread is running or this is called from the input thread, func
+ * is called immediately.
+ *
+ * The input thread processes all pending device events before calling
+ * func. Events that are a result of func are available in the event
+ * queue when this function returns.
+ *
+ * Within func, all libinput functions may be used except those for
+ * retrieving events from the event queue and those that start or stop the
+ * input thread.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param func The function to call
+ * @param data Caller-specific data passed to func
+ *
+ * @since 1.31
+ */
+void
+libinput_input_thread_call(struct libinput *libinput,
+			   void (*func)(struct libinput *libinput, void *data),
+			   void *data);
+
 /**
  * @ingroup base
  *
@@ -3841,6 +4253,48 @@ libinput_dispatch(struct libinput *libinput);
 struct libinput_event *
 libinput_get_event(struct libinput *libinput);
 
+/**
+ * @ingroup base
+ *
+ * Retrieve up to max_events events from libinput's internal event queue
+ * and store them in the caller-provided array, in the same order
+ * libinput_get_event() would return them. This is equivalent to calling
+ * libinput_get_event() up to max_events times.
+ *
+ * After handling the retrieved events, the caller must destroy each event
+ * using libinput_event_destroy() or all of them at once using
+ * libinput_events_destroy().
+ *
+ * @param libinput A previously initialized libinput context
+ * @param events An array with space for at least max_events events
+ * @param max_events The maximum number of events to retrieve
+ * @return The number of events stored in events, 0 if no event is
+ * available.
+ *
+ * @see libinput_events_destroy
+ *
+ * @since 1.31
+ */
+size_t
+libinput_get_events(struct libinput *libinput,
+		    struct libinput_event **events,
+		    size_t max_events);
+
+/**
+ * @ingroup event
+ *
+ * Destroy the first nevents events in the given array, typically filled
+ * by libinput_get_events(). This is equivalent to calling
+ * libinput_event_destroy() on each event.
+ *
+ * @param events An array of events
+ * @param nevents The number of events to destroy
+ *
+ * @since 1.31
+ */
+void
+libinput_events_destroy(struct libinput_event **events, size_t nevents);
+
 /**
  * @ingroup base
  *
@@ -3855,6 +4309,203 @@ libinput_get_event(struct libinput *libinput);
 enum libinput_event_type
 libinput_next_event_type(struct libinput *libinput);
 
+/**
+ * @ingroup base
+ *
+ * Statistics counters maintained by a libinput context, see
+ * libinput_get_stat().
+ *
+ * @since 1.31
+ */
+enum libinput_stat {
+	/**
+	 * The number of events whose memory was recycled from a previously
+	 * destroyed event.
+	 */
+	LIBINPUT_STAT_EVENT_POOL_HITS = 1,
+	/**
+	 * The number of events that required a new memory allocation. In
+	 * steady state this number should not increase.
+	 */
+	LIBINPUT_STAT_EVENT_POOL_MISSES,
+	/**
+	 * The highest number of events that were alive at the same time,
+	 * i.e. queued or retrieved by the caller but not yet destroyed.
+	 */
+	LIBINPUT_STAT_EVENT_POOL_HIGH_WATER_MARK,
+	/**
+	 * The number of times a device had more data pending after
+	 * processing its budget, see libinput_set_dispatch_budget().
+	 */
+	LIBINPUT_STAT_DISPATCH_BUDGET_HITS,
+	/**
+	 * The number of events currently in the event queue.
+	 */
+	LIBINPUT_STAT_EVENT_QUEUE_DEPTH,
+	/**
+	 * The highest number of events that were in the event queue at the
+	 * same time.
+	 */
+	LIBINPUT_STAT_EVENT_QUEUE_PEAK_DEPTH,
+	/**
+	 * The number of events discarded because the event queue was full,
+	 * see libinput_set_event_queue_limit().
+	 */
+	LIBINPUT_STAT_EVENT_QUEUE_DROPPED,
+	/**
+	 * The number of io_uring submissions, see
+	 * libinput_set_io_uring_enabled(). Each submission is one syscall
+	 * regardless of the number of devices read.
+	 */
+	LIBINPUT_STAT_IO_URING_SUBMISSIONS,
+	/**
+	 * The number of times libinput's internal timer woke up the
+	 * caller. Timers that expire close to each other share a single
+	 * wakeup where possible.
+	 */
+	LIBINPUT_STAT_TIMER_WAKEUPS,
+	/**
+	 * The number of touches a touchpad's per-frame processing visited
+	 * because they changed in that frame.
+	 */
+	LIBINPUT_STAT_TOUCHPAD_TOUCH_VISITS,
+	/**
+	 * The number of touches a touchpad's per-frame processing skipped
+	 * because they did not change in that frame.
+	 */
+	LIBINPUT_STAT_TOUCHPAD_TOUCH_SKIPS,
+	/**
+	 * The number of button presses generated by tapping, including
+	 * the press that starts a tap-and-drag.
+	 */
+	LIBINPUT_STAT_TOUCHPAD_TAPS,
+	/**
+	 * The number of tap timeouts handled by the tap state machine,
+	 * e.g. a finger held down too long to be a tap.
+	 */
+	LIBINPUT_STAT_TOUCHPAD_TAP_TIMEOUTS,
+	/**
+	 * The number of times the tap state machine gave up on a touch
+	 * sequence, e.g. because of finger motion, a physical button press
+	 * or too many fingers.
+	 */
+	LIBINPUT_STAT_TOUCHPAD_TAP_CANCELS,
+};
+
+/**
+ * @ingroup base
+ *
+ * Return the current value of the given statistics counter. Counters
+ * start at zero when the context is created and are never reset.
+ *
+ * This function is intended for debugging and profiling, the counters
+ * have no effect on libinput's behavior.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param stat The counter to query
+ * @return The current value of the counter or 0 if the counter is invalid
+ *
+ * @since 1.31
+ */
+uint64_t
+libinput_get_stat(struct libinput *libinput, enum libinput_stat stat);
+
+/**
+ * @ingroup base
+ *
+ * The processing stages of an input event for which libinput can collect
+ * latency statistics, see libinput_set_latency_stats_enabled().
+ *
+ * @since 1.31
+ */
+enum libinput_latency_stage {
+	/**
+	 * From the kernel timestamp of an evdev frame until libinput
+	 * reads the frame from the device.
+	 */
+	LIBINPUT_LATENCY_STAGE_KERNEL_TO_READ = 1,
+	/**
+	 * From reading an evdev frame until it leaves the plugin chain.
+	 * This includes any delay added by plugins, e.g. for button
+	 * debouncing.
+	 */
+	LIBINPUT_LATENCY_STAGE_READ_TO_PLUGIN_EXIT,
+	/**
+	 * From an evdev frame leaving the plugin chain until each
+	 * resulting event is added to the event queue. Events generated
+	 * by timers, e.g. tap-to-click, are not counted.
+	 */
+	LIBINPUT_LATENCY_STAGE_PLUGIN_EXIT_TO_QUEUE,
+	/**
+	 * From an event being added to the event queue until the caller
+	 * retrieves it with libinput_get_event() or libinput_get_events().
+	 */
+	LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT,
+};
+
+/**
+ * @ingroup base
+ *
+ * Enable or disable the collection of per-device latency statistics,
+ * see libinput_device_get_latency_histogram(). Collecting latency
+ * statistics requires reading the current time multiple times for each
+ * event and is disabled by default.
+ *
+ * Disabling latency statistics does not reset the histograms already
+ * collected.
+ *
+ * @param libinput A previously initialized libinput context
+ * @param enabled Nonzero to enable latency statistics, zero to disable
+ *
+ * @since 1.31
+ */
+void
+libinput_set_latency_stats_enabled(struct libinput *libinput, int enabled);
+
+/**
+ * @ingroup base
+ *
+ * @param libinput A previously initialized libinput context
+ * @return Nonzero if latency statistics are enabled, zero otherwise
+ *
+ * @see libinput_set_latency_stats_enabled
+ *
+ * @since 1.31
+ */
+int
+libinput_get_latency_stats_enabled(struct libinput *libinput);
+
+/**
+ * @ingroup device
+ *
+ * Copy the latency histogram for the given stage into the caller-provided
+ * array. Each bucket counts the number of frames or events with a latency
+ * within that bucket's range, in microseconds:
+ * - bucket 0 counts latencies of 0us
+ * - bucket n counts latencies within [2^(n-1), 2^n)us
+ * - the last bucket counts all latencies larger than that
+ *
+ * Histograms are only updated while latency statistics are enabled with
+ * libinput_set_latency_stats_enabled().
+ *
+ * To query the number of buckets, call this function with a nbuckets of
+ * zero.
+ *
+ * @param device A previously obtained device
+ * @param stage The processing stage
+ * @param buckets An array with space for at least nbuckets elements
+ * @param nbuckets The number of elements to copy
+ * @return The total number of buckets in the histogram, which may be
+ * more than nbuckets, or 0 if the stage is invalid
+ *
+ * @since 1.31
+ */
+size_t
+libinput_device_get_latency_histogram(struct libinput_device *device,
+				      enum libinput_latency_stage stage,
+				      uint64_t *buckets,
+				      size_t nbuckets);
+
 /**
  * @ingroup base
  *
@@ -6833,6 +7484,109 @@ libinput_device_config_dwtp_get_enabled(struct libinput_device *device);
 enum libinput_config_dwtp_state
 libinput_device_config_dwtp_get_default_enabled(struct libinput_device *device);
 
+/**
+ * @ingroup config
+ *
+ * Possible states for touchpad pointer prediction.
+ *
+ * @since 1.31
+ */
+enum libinput_config_pointer_prediction_state {
+	LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED,
+	LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED,
+};
+
+/**
+ * @ingroup config
+ *
+ * Check if this device supports pointer prediction. When enabled, pointer
+ * motion is extrapolated from the recent motion of the finger to roughly
+ * where the finger will be at the next hardware report, reducing the
+ * perceived latency of the cursor. The extrapolated part is corrected with
+ * the next real event and taken back when the motion stops, before any
+ * button event. See the libinput documentation for details.
+ *
+ * @param device The device to configure
+ * @return 0 if this device does not support pointer prediction, or 1
+ * otherwise.
+ *
+ * @see libinput_device_config_pointer_prediction_set_enabled
+ * @see libinput_device_config_pointer_prediction_get_enabled
+ * @see libinput_device_config_pointer_prediction_get_default_enabled
+ *
+ * @since 1.31
+ */
+int
+libinput_device_config_pointer_prediction_is_available(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Enable or disable pointer prediction on this device.
+ *
+ * @note Disabling pointer prediction while the pointer is moving takes
+ * effect with the next pointer motion event.
+ *
+ * @param device The device to configure
+ * @param enable @ref LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED to disable
+ * pointer prediction, @ref LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED to
+ * enable
+ *
+ * @return A config status code. Disabling pointer prediction on a device
+ * that does not support the feature always succeeds.
+ *
+ * @see libinput_device_config_pointer_prediction_is_available
+ * @see libinput_device_config_pointer_prediction_get_enabled
+ * @see libinput_device_config_pointer_prediction_get_default_enabled
+ *
+ * @since 1.31
+ */
+enum libinput_config_status
+libinput_device_config_pointer_prediction_set_enabled(
+	struct libinput_device *device,
+	enum libinput_config_pointer_prediction_state enable);
+
+/**
+ * @ingroup config
+ *
+ * Check if pointer prediction is currently enabled on this device. If the
+ * device does not support pointer prediction, this function returns @ref
+ * LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED.
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED if disabled, @ref
+ * LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED if enabled.
+ *
+ * @see libinput_device_config_pointer_prediction_is_available
+ * @see libinput_device_config_pointer_prediction_set_enabled
+ * @see libinput_device_config_pointer_prediction_get_default_enabled
+ *
+ * @since 1.31
+ */
+enum libinput_config_pointer_prediction_state
+libinput_device_config_pointer_prediction_get_enabled(struct libinput_device *device);
+
+/**
+ * @ingroup config
+ *
+ * Check if pointer prediction is enabled on this device by default. If the
+ * device does not support pointer prediction, this function returns @ref
+ * LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED.
+ *
+ * @param device The device to configure
+ * @return @ref LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED if disabled, @ref
+ * LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED if enabled.
+ *
+ * @see libinput_device_config_pointer_prediction_is_available
+ * @see libinput_device_config_pointer_prediction_set_enabled
+ * @see libinput_device_config_pointer_prediction_get_enabled
+ *
+ * @since 1.31
+ */
+enum libinput_config_pointer_prediction_state
+libinput_device_config_pointer_prediction_get_default_enabled(
+	struct libinput_device *device);
+
 /**
  * @ingroup config
  *
@@ -80,6 +80,7 @@ ASSERT_INT_SIZE(enum libinput_config_middle_emulation_state);
 ASSERT_INT_SIZE(enum libinput_config_scroll_method);
 ASSERT_INT_SIZE(enum libinput_config_dwt_state);
 ASSERT_INT_SIZE(enum libinput_config_dwtp_state);
+ASSERT_INT_SIZE(enum libinput_config_pointer_prediction_state);
 
 static inline const char *
 event_type_to_str(enum libinput_event_type type)
@@ -160,13 +161,6 @@ check_event_type(struct libinput *libinput,
 	return rc;
 }
 
-struct libinput_source {
-	libinput_source_dispatch_t dispatch;
-	void *user_data;
-	int fd;
-	struct list link;
-};
-
 struct libinput_event_device_notify {
 	struct libinput_event base;
 };
@@ -179,21 +173,6 @@ struct libinput_event_keyboard {
 	enum libinput_key_state state;
 };
 
-struct libinput_event_pointer {
-	struct libinput_event base;
-	uint64_t time;
-	struct normalized_coords delta;
-	struct device_float_coords delta_raw;
-	struct device_coords absolute;
-	struct discrete_coords discrete;
-	struct wheel_v120 v120;
-	uint32_t button;
-	uint32_t seat_button_count;
-	enum libinput_button_state state;
-	enum libinput_pointer_axis_source source;
-	uint32_t axes;
-};
-
 struct libinput_event_touch {
 	struct libinput_event base;
 	uint64_t time;
@@ -594,6 +573,28 @@ libinput_event_pointer_get_time_usec(struct libinput_event_pointer *event)
 	return event->time;
 }
 
+LIBINPUT_EXPORT uint64_t
+libinput_event_pointer_get_first_time_usec(struct libinput_event_pointer *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_POINTER_MOTION);
+
+	return event->nmerged ? event->first_time : event->time;
+}
+
+LIBINPUT_EXPORT uint32_t
+libinput_event_pointer_get_coalesced_count(struct libinput_event_pointer *event)
+{
+	require_event_type(libinput_event_get_context(&event->base),
+			   event->base.type,
+			   0,
+			   LIBINPUT_EVENT_POINTER_MOTION);
+
+	return event->nmerged + 1;
+}
+
 LIBINPUT_EXPORT double
 libinput_event_pointer_get_dx(struct libinput_event_pointer *event)
 {
@@ -1771,40 +1772,6 @@ libinput_event_switch_get_time_usec(struct libinput_event_switch *event)
 	return event->time;
 }
 
-struct libinput_source *
-libinput_add_fd(struct libinput *libinput,
-		int fd,
-		libinput_source_dispatch_t dispatch,
-		void *user_data)
-{
-	struct libinput_source *source;
-	struct epoll_event ep;
-
-	source = zalloc(sizeof *source);
-	source->dispatch = dispatch;
-	source->user_data = user_data;
-	source->fd = fd;
-
-	memset(&ep, 0, sizeof ep);
-	ep.events = EPOLLIN;
-	ep.data.ptr = source;
-
-	if (epoll_ctl(libinput->epoll_fd, EPOLL_CTL_ADD, fd, &ep) < 0) {
-		free(source);
-		return NULL;
-	}
-
-	return source;
-}
-
-void
-libinput_remove_source(struct libinput *libinput, struct libinput_source *source)
-{
-	epoll_ctl(libinput->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL);
-	source->fd = -1;
-	list_insert(&libinput->source_destroy_list, &source->link);
-}
-
 int
 libinput_init(struct libinput *libinput,
 	      const struct libinput_interface *interface,
@@ -1818,8 +1785,10 @@ libinput_init(struct libinput *libinput,
 	if (libinput->epoll_fd < 0)
 		return -1;
 
-	libinput->events_len = 4;
+	libinput->events_len = LIBINPUT_EVENT_QUEUE_MIN_LEN;
 	libinput->events = zalloc(libinput->events_len * sizeof(*libinput->events));
+	/* at most 5 "event queue full" log messages per hour */
+	ratelimit_init(&libinput->events_overflow_limit, s2us(60 * 60), 5);
 	libinput->log_handler = libinput_default_log_func;
 	libinput->log_priority = LIBINPUT_LOG_PRIORITY_ERROR;
 	libinput->interface = interface;
@@ -1827,6 +1796,7 @@ libinput_init(struct libinput *libinput,
 	libinput->user_data = user_data;
 	libinput->refcount = 1;
 	list_init(&libinput->source_destroy_list);
+	list_init(&libinput->dispatch.pending);
 	list_init(&libinput->seat_list);
 	list_init(&libinput->device_group_list);
 	list_init(&libinput->tool_list);
@@ -1857,16 +1827,6 @@ libinput_device_destroy(struct libinput_device *device);
 static void
 libinput_seat_destroy(struct libinput_seat *seat);
 
-static void
-libinput_drop_destroyed_sources(struct libinput *libinput)
-{
-	struct libinput_source *source;
-
-	list_for_each_safe(source, &libinput->source_destroy_list, link)
-		free(source);
-	list_init(&libinput->source_destroy_list);
-}
-
 LIBINPUT_EXPORT struct libinput *
 libinput_ref(struct libinput *libinput)
 {
@@ -1942,12 +1902,10 @@ libinput_event_tablet_pad_destroy(struct libinput_event_tablet_pad *event)
 		libinput_tablet_pad_mode_group_unref(event->mode_group);
 }
 
-LIBINPUT_EXPORT void
-libinput_event_destroy(struct libinput_event *event)
+/* Drop the references the event type holds, everything but the device */
+static void
+libinput_event_destroy_data(struct libinput_event *event)
 {
-	if (event == NULL)
-		return;
-
 	switch (event->type) {
 	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
 	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
@@ -1967,6 +1925,15 @@ libinput_event_destroy(struct libinput_event *event)
 	default:
 		break;
 	}
+}
+
+LIBINPUT_EXPORT void
+libinput_event_destroy(struct libinput_event *event)
+{
+	if (event == NULL)
+		return;
+
+	libinput_event_destroy_data(event);
 
 	if (event->device)
 		libinput_device_unref(event->device);
@@ -2123,34 +2090,7 @@ libinput_get_fd(struct libinput *libinput)
 LIBINPUT_EXPORT int
 libinput_dispatch(struct libinput *libinput)
 {
-	static uint8_t take_time_snapshot;
-	struct libinput_source *source;
-	struct epoll_event ep[32];
-	int i, count;
-
-	/* Every 10 calls to libinput_dispatch() we take the current time so
-	 * we can check the delay between our current time and the event
-	 * timestamps */
-	if ((++take_time_snapshot % 10) == 0)
-		libinput->dispatch_time = libinput_now(libinput);
-	else if (libinput->dispatch_time)
-		libinput->dispatch_time = 0;
-
-	count = epoll_wait(libinput->epoll_fd, ep, ARRAY_LENGTH(ep), 0);
-	if (count < 0)
-		return -errno;
-
-	for (i = 0; i < count; ++i) {
-		source = ep[i].data.ptr;
-		if (source->fd == -1)
-			continue;
-
-		source->dispatch(source->user_data);
-	}
-
-	libinput_drop_destroyed_sources(libinput);
-
-	return 0;
+	return libinput_dispatch_sources(libinput);
 }
 
 void
@@ -3129,53 +3069,90 @@ libinput_print_queued_event(struct libinput_event *event)
 static void
 libinput_post_event(struct libinput *libinput, struct libinput_event *event)
 {
-	struct libinput_event **events = libinput->events;
-	size_t events_len = libinput->events_len;
-	size_t events_count = libinput->events_count;
-	size_t move_len;
-	size_t new_out;
-
 #if 0
 	log_debug(libinput, "Queuing %s\n", event_type_to_str(event->type));
 #endif
 
-	events_count++;
-	if (events_count > events_len) {
-		void *tmp;
-
-		events_len *= 2;
-		tmp = realloc(events, events_len * sizeof *events);
-		if (!tmp) {
-			log_error(libinput,
-				  "Failed to reallocate event ring buffer. "
-				  "Events may be discarded\n");
-			return;
-		}
+	if (!libinput_event_queue_push(libinput, event)) {
+		libinput_event_destroy_data(event);
+		free(event);
+	}
+}
 
-		events = tmp;
-
-		if (libinput->events_count > 0 && libinput->events_in == 0) {
-			libinput->events_in = libinput->events_len;
-		} else if (libinput->events_count > 0 &&
-			   libinput->events_out >= libinput->events_in) {
-			move_len = libinput->events_len - libinput->events_out;
-			new_out = events_len - move_len;
-			memmove(events + new_out,
-				events + libinput->events_out,
-				move_len * sizeof *events);
-			libinput->events_out = new_out;
-		}
+LIBINPUT_EXPORT int
+libinput_set_io_uring_enabled(struct libinput *libinput, int enabled)
+{
+	return enabled ? -ENOSYS : 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_get_io_uring_enabled(struct libinput *libinput)
+{
+	return 0;
+}
+
+LIBINPUT_EXPORT void
+libinput_set_bulk_read_enabled(struct libinput *libinput, int enabled)
+{
+}
+
+LIBINPUT_EXPORT int
+libinput_get_bulk_read_enabled(struct libinput *libinput)
+{
+	return 0;
+}
+
+LIBINPUT_EXPORT int
+libinput_input_thread_start(struct libinput *libinput)
+{
+	/* wscons input is always processed in the caller's thread */
+	return -ENOSYS;
+}
+
+LIBINPUT_EXPORT void
+libinput_input_thread_stop(struct libinput *libinput)
+{
+}
+
+LIBINPUT_EXPORT void
+libinput_input_thread_call(struct libinput *libinput,
+			   void (*func)(struct libinput *libinput, void *data),
+			   void *data)
+{
+	func(libinput, data);
+}
+
+LIBINPUT_EXPORT void
+libinput_set_latency_stats_enabled(struct libinput *libinput, int enabled)
+{
+	libinput->latency_stats = !!enabled;
+}
 
-		libinput->events = events;
-		libinput->events_len = events_len;
+LIBINPUT_EXPORT int
+libinput_get_latency_stats_enabled(struct libinput *libinput)
+{
+	return libinput->latency_stats;
+}
+
+LIBINPUT_EXPORT size_t
+libinput_device_get_latency_histogram(struct libinput_device *device,
+				      enum libinput_latency_stage stage,
+				      uint64_t *buckets,
+				      size_t nbuckets)
+{
+	if (stage < LIBINPUT_LATENCY_STAGE_KERNEL_TO_READ ||
+	    stage > LIBINPUT_LATENCY_NSTAGES) {
+		log_bug_client(libinput_device_get_context(device),
+			       "Invalid latency stage %u\n",
+			       stage);
+		return 0;
 	}
 
-	if (event->device)
-		libinput_device_ref(event->device);
+	memcpy(buckets,
+	       libinput_device_latency_histogram(device, stage),
+	       min(nbuckets, (size_t)LIBINPUT_LATENCY_NBUCKETS) * sizeof(*buckets));
 
-	libinput->events_count = events_count;
-	events[libinput->events_in] = event;
-	libinput->events_in = (libinput->events_in + 1) % libinput->events_len;
+	return LIBINPUT_LATENCY_NBUCKETS;
 }
 
 LIBINPUT_EXPORT struct libinput_event *
@@ -3183,26 +3160,26 @@ libinput_get_event(struct libinput *libinput)
 {
 	struct libinput_event *event;
 
-	if (libinput->events_count == 0)
+	if (libinput_event_queue_pop(libinput, &event, 1) == 0)
 		return NULL;
 
-	event = libinput->events[libinput->events_out];
-	libinput->events_out = (libinput->events_out + 1) % libinput->events_len;
-	libinput->events_count--;
-
 	return event;
 }
 
+LIBINPUT_EXPORT size_t
+libinput_get_events(struct libinput *libinput,
+		    struct libinput_event **events,
+		    size_t max_events)
+{
+	return libinput_event_queue_pop(libinput, events, max_events);
+}
+
 LIBINPUT_EXPORT enum libinput_event_type
 libinput_next_event_type(struct libinput *libinput)
 {
-	struct libinput_event *event;
-
-	if (libinput->events_count == 0)
-		return LIBINPUT_EVENT_NONE;
+	struct libinput_event *event = libinput_event_queue_peek(libinput);
 
-	event = libinput->events[libinput->events_out];
-	return event->type;
+	return event ? event->type : LIBINPUT_EVENT_NONE;
 }
 
 LIBINPUT_EXPORT void
@@ -4817,6 +4794,50 @@ libinput_device_config_dwtp_get_default_enabled(struct libinput_device *device)
 	return device->config.dwtp->get_default_enabled(device);
 }
 
+LIBINPUT_EXPORT int
+libinput_device_config_pointer_prediction_is_available(struct libinput_device *device)
+{
+	if (!device->config.pointer_prediction)
+		return 0;
+
+	return device->config.pointer_prediction->is_available(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_status
+libinput_device_config_pointer_prediction_set_enabled(
+	struct libinput_device *device,
+	enum libinput_config_pointer_prediction_state enable)
+{
+	if (enable != LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED &&
+	    enable != LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED)
+		return LIBINPUT_CONFIG_STATUS_INVALID;
+
+	if (!libinput_device_config_pointer_prediction_is_available(device))
+		return enable ? LIBINPUT_CONFIG_STATUS_UNSUPPORTED
+			      : LIBINPUT_CONFIG_STATUS_SUCCESS;
+
+	return device->config.pointer_prediction->set_enabled(device, enable);
+}
+
+LIBINPUT_EXPORT enum libinput_config_pointer_prediction_state
+libinput_device_config_pointer_prediction_get_enabled(struct libinput_device *device)
+{
+	if (!libinput_device_config_pointer_prediction_is_available(device))
+		return LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED;
+
+	return device->config.pointer_prediction->get_enabled(device);
+}
+
+LIBINPUT_EXPORT enum libinput_config_pointer_prediction_state
+libinput_device_config_pointer_prediction_get_default_enabled(
+	struct libinput_device *device)
+{
+	if (!libinput_device_config_pointer_prediction_is_available(device))
+		return LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED;
+
+	return device->config.pointer_prediction->get_default_enabled(device);
+}
+
 LIBINPUT_EXPORT int
 libinput_device_config_rotation_is_available(struct libinput_device *device)
 {
@@ -4971,6 +4992,14 @@ libinput_plugin_system_append_default_paths(struct libinput *libinput)
 	return;
 }
 
+LIBINPUT_EXPORT void
+libinput_plugin_system_set_cache_directory(struct libinput *libinput,
+					   const char *path)
+{
+	/* We don't support libinput plugins */
+	return;
+}
+
 LIBINPUT_EXPORT int
 libinput_plugin_system_load_plugins(struct libinput *libinput,
 				    enum libinput_plugin_system_flags flags)
@@ -4982,6 +5011,52 @@ libinput_plugin_system_load_plugins(struct libinput *libinput,
 	return -ENOSYS;
 }
 
+LIBINPUT_EXPORT const char *
+libinput_plugin_system_get_plugin_name(struct libinput *libinput, size_t index)
+{
+	/* We don't support libinput plugins */
+	return NULL;
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_plugin_system_get_plugin_stat(struct libinput *libinput,
+				       size_t index,
+				       enum libinput_plugin_stat stat)
+{
+	/* We don't support libinput plugins */
+	return 0;
+}
+
+LIBINPUT_EXPORT uint64_t
+libinput_get_stat(struct libinput *libinput, enum libinput_stat stat)
+{
+	switch (stat) {
+	case LIBINPUT_STAT_DISPATCH_BUDGET_HITS:
+		return libinput->dispatch.budget_hits;
+	case LIBINPUT_STAT_EVENT_QUEUE_DEPTH:
+		return libinput->events_count;
+	case LIBINPUT_STAT_EVENT_QUEUE_PEAK_DEPTH:
+		return libinput->events_peak;
+	case LIBINPUT_STAT_EVENT_QUEUE_DROPPED:
+		return libinput->events_dropped;
+	case LIBINPUT_STAT_TIMER_WAKEUPS:
+		return libinput->timer.wakeups;
+	case LIBINPUT_STAT_TOUCHPAD_TOUCH_VISITS:
+		return libinput->touchpad.touch_visits;
+	case LIBINPUT_STAT_TOUCHPAD_TOUCH_SKIPS:
+		return libinput->touchpad.touch_skips;
+	case LIBINPUT_STAT_TOUCHPAD_TAPS:
+		return libinput->touchpad.taps;
+	case LIBINPUT_STAT_TOUCHPAD_TAP_TIMEOUTS:
+		return libinput->touchpad.tap_timeouts;
+	case LIBINPUT_STAT_TOUCHPAD_TAP_CANCELS:
+		return libinput->touchpad.tap_cancels;
+	default:
+		/* The event pool is not implemented in libopeninput */
+		return 0;
+	}
+}
+
 #ifdef HAVE_LIBWACOM
 WacomDeviceDatabase *
 libinput_libwacom_ref(struct libinput *li)
@@ -337,6 +337,8 @@ quirk_get_name(enum quirk q)
 		return "AttrInputProp";
 	case QUIRK_ATTR_IS_VIRTUAL:
 		return "AttrIsVirtual";
+	case QUIRK_ATTR_TOUCHPAD_HISTORY_LENGTH:
+		return "AttrTouchpadHistoryLength";
 	default:
 		abort();
 	}
@@ -897,6 +899,13 @@ parse_attr(struct quirks_context *ctx,
 		p->type = PT_UINT;
 		p->value.u = v;
 		rc = true;
+	} else if (streq(key, quirk_get_name(QUIRK_ATTR_TOUCHPAD_HISTORY_LENGTH))) {
+		p->id = QUIRK_ATTR_TOUCHPAD_HISTORY_LENGTH;
+		if (!safe_atou(value, &v))
+			goto out;
+		p->type = PT_UINT;
+		p->value.u = v;
+		rc = true;
 	} else if (streq(key, quirk_get_name(QUIRK_ATTR_MSC_TIMESTAMP))) {
 		p->id = QUIRK_ATTR_MSC_TIMESTAMP;
 		if (!streq(value, "watch"))
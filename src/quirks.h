@@ -113,6 +113,7 @@ enum quirk {
 	QUIRK_ATTR_THUMB_PRESSURE_THRESHOLD,
 	QUIRK_ATTR_THUMB_SIZE_THRESHOLD,
 	QUIRK_ATTR_TOUCH_SIZE_RANGE,
+	QUIRK_ATTR_TOUCHPAD_HISTORY_LENGTH,
 	QUIRK_ATTR_TPKBCOMBO_LAYOUT,
 	QUIRK_ATTR_TRACKPOINT_INTEGRATION,
 	QUIRK_ATTR_TRACKPOINT_MULTIPLIER,
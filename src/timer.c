@@ -50,8 +50,7 @@ libinput_timer_init(struct libinput_timer *timer,
 void
 libinput_timer_destroy(struct libinput_timer *timer)
 {
-	if (timer->link.prev != NULL && timer->link.next != NULL &&
-	    !list_empty(&timer->link)) {
+	if (timer->expire != 0) {
 		log_bug_libinput(timer->libinput,
 				 "timer: %s has not been cancelled\n",
 				 timer->timer_name);
@@ -60,22 +59,151 @@ libinput_timer_destroy(struct libinput_timer *timer)
 	free(timer->timer_name);
 }
 
+/* Armed timers are kept in a binary min-heap so finding the next expiry is
+ * O(1) and arming/cancelling is O(log n). Timers with the same expiry fire
+ * most recently armed first.
+ */
+static inline bool
+timer_before(const struct libinput_timer *a, const struct libinput_timer *b)
+{
+	if (a->expire != b->expire)
+		return a->expire < b->expire;
+
+	return a->seqno > b->seqno;
+}
+
+static inline void
+timer_heap_place(struct libinput *libinput,
+		 struct libinput_timer *timer,
+		 size_t index)
+{
+	libinput->timer.heap[index] = timer;
+	timer->heap_index = index;
+}
+
+static void
+timer_heap_sift_up(struct libinput *libinput, size_t index)
+{
+	struct libinput_timer **heap = libinput->timer.heap;
+	struct libinput_timer *timer = heap[index];
+
+	while (index > 0) {
+		size_t parent = (index - 1) / 2;
+
+		if (!timer_before(timer, heap[parent]))
+			break;
+
+		timer_heap_place(libinput, heap[parent], index);
+		index = parent;
+	}
+
+	timer_heap_place(libinput, timer, index);
+}
+
+static void
+timer_heap_sift_down(struct libinput *libinput, size_t index)
+{
+	struct libinput_timer **heap = libinput->timer.heap;
+	struct libinput_timer *timer = heap[index];
+	size_t count = libinput->timer.heap_count;
+
+	while (true) {
+		size_t child = 2 * index + 1;
+
+		if (child >= count)
+			break;
+
+		if (child + 1 < count && timer_before(heap[child + 1], heap[child]))
+			child++;
+
+		if (!timer_before(heap[child], timer))
+			break;
+
+		timer_heap_place(libinput, heap[child], index);
+		index = child;
+	}
+
+	timer_heap_place(libinput, timer, index);
+}
+
+static void
+timer_heap_insert(struct libinput *libinput, struct libinput_timer *timer)
+{
+	if (libinput->timer.heap_count == libinput->timer.heap_size) {
+		size_t size = max(libinput->timer.heap_size * 2, 16U);
+		struct libinput_timer **heap =
+			realloc(libinput->timer.heap, size * sizeof(*heap));
+
+		if (!heap)
+			abort();
+
+		libinput->timer.heap = heap;
+		libinput->timer.heap_size = size;
+	}
+
+	size_t index = libinput->timer.heap_count++;
+	timer_heap_place(libinput, timer, index);
+	timer_heap_sift_up(libinput, index);
+}
+
+static void
+timer_heap_remove(struct libinput *libinput, struct libinput_timer *timer)
+{
+	size_t index = timer->heap_index;
+	size_t last = --libinput->timer.heap_count;
+
+	assert(libinput->timer.heap[index] == timer);
+
+	if (index == last)
+		return;
+
+	timer_heap_place(libinput, libinput->timer.heap[last], index);
+	timer_heap_sift_up(libinput, index);
+	timer_heap_sift_down(libinput, libinput->timer.heap[index]->heap_index);
+}
+
+/* Return the latest time we can wake up without any timer in the subtree
+ * at index firing later than its expiry plus slack. Only timers that expire
+ * before the current deadline can lower it, and the heap order lets us skip
+ * all subtrees that expire later.
+ */
+static uint64_t
+timer_heap_deadline(struct libinput *libinput, size_t index, uint64_t deadline)
+{
+	if (index >= libinput->timer.heap_count)
+		return deadline;
+
+	struct libinput_timer *timer = libinput->timer.heap[index];
+	if (timer->expire >= deadline)
+		return deadline;
+
+	deadline = min(deadline, timer->expire + timer->slack);
+	deadline = timer_heap_deadline(libinput, 2 * index + 1, deadline);
+	deadline = timer_heap_deadline(libinput, 2 * index + 2, deadline);
+
+	return deadline;
+}
+
 static void
 libinput_timer_arm_timer_fd(struct libinput *libinput)
 {
 	int r;
-	struct libinput_timer *timer;
 	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
-	uint64_t earliest_expire = UINT64_MAX;
+	uint64_t wakeup = timer_heap_deadline(libinput, 0, UINT64_MAX);
 
-	list_for_each(timer, &libinput->timer.list, link) {
-		if (timer->expire < earliest_expire)
-			earliest_expire = timer->expire;
-	}
+	/* Most timer updates don't change the wakeup time, skip the
+	 * syscall in that case */
+	if (wakeup == libinput->timer.next_expiry)
+		return;
 
-	if (earliest_expire != UINT64_MAX) {
-		its.it_value.tv_sec = earliest_expire / ms2us(1000);
-		its.it_value.tv_nsec = (earliest_expire % ms2us(1000)) * 1000;
+	if (wakeup != UINT64_MAX) {
+		/* The timerfd uses CLOCK_MONOTONIC, an expiry that is in
+		 * the past fires immediately. A zero value would disarm it. */
+		uint64_t offset = libinput_clock_offset(libinput);
+		uint64_t monotonic = max(wakeup, offset + 1) - offset;
+
+		its.it_value.tv_sec = monotonic / ms2us(1000);
+		its.it_value.tv_nsec = (monotonic % ms2us(1000)) * 1000;
 	}
 
 	r = timerfd_settime(libinput->timer.fd, TFD_TIMER_ABSTIME, &its, NULL);
@@ -84,7 +212,7 @@ libinput_timer_arm_timer_fd(struct libinput *libinput)
 			  "timer: timerfd_settime error: %s\n",
 			  strerror(errno));
 
-	libinput->timer.next_expiry = earliest_expire;
+	libinput->timer.next_expiry = wakeup;
 }
 
 void
@@ -114,11 +242,24 @@ libinput_timer_set_flags(struct libinput_timer *timer, uint64_t expire, uint32_t
 
 	assert(expire);
 
-	if (!timer->expire)
-		list_insert(&timer->libinput->timer.list, &timer->link);
+	struct libinput *libinput = timer->libinput;
+
+	if (!timer->expire) {
+		timer->expire = expire;
+		timer->seqno = ++libinput->timer.seqno;
+		timer_heap_insert(libinput, timer);
+	} else {
+		bool later = expire > timer->expire;
+
+		timer->expire = expire;
+		timer->seqno = ++libinput->timer.seqno;
+		if (later)
+			timer_heap_sift_down(libinput, timer->heap_index);
+		else
+			timer_heap_sift_up(libinput, timer->heap_index);
+	}
 
-	timer->expire = expire;
-	libinput_timer_arm_timer_fd(timer->libinput);
+	libinput_timer_arm_timer_fd(libinput);
 }
 
 void
@@ -127,43 +268,41 @@ libinput_timer_set(struct libinput_timer *timer, uint64_t expire)
 	libinput_timer_set_flags(timer, expire, TIMER_FLAG_NONE);
 }
 
+void
+libinput_timer_set_slack(struct libinput_timer *timer, uint64_t slack)
+{
+	timer->slack = slack;
+
+	if (timer->expire)
+		libinput_timer_arm_timer_fd(timer->libinput);
+}
+
 void
 libinput_timer_cancel(struct libinput_timer *timer)
 {
 	if (!timer->expire)
 		return;
 
+	timer_heap_remove(timer->libinput, timer);
 	timer->expire = 0;
-	list_remove(&timer->link);
 	libinput_timer_arm_timer_fd(timer->libinput);
 }
 
 static void
 libinput_timer_handler(struct libinput *libinput, uint64_t now)
 {
-	struct libinput_timer *timer;
-
-restart:
-	list_for_each_safe(timer, &libinput->timer.list, link) {
-		if (timer->expire == 0)
-			continue;
-
-		if (timer->expire <= now) {
-			/* Clear the timer before calling timer_func,
-			   as timer_func may re-arm it */
-			libinput_timer_cancel(timer);
-			timer->timer_func(now, timer->timer_func_data);
-
-			/*
-			 * Restart the loop. We can't use
-			 * list_for_each_safe() here because that only
-			 * allows removing one (our) timer per timer_func.
-			 * But the timer func may trigger another unrelated
-			 * timer to be cancelled and removed, causing a
-			 * segfault.
-			 */
-			goto restart;
-		}
+	/* The timer func may arm or cancel any timer, including this
+	 * one, so always re-check the top of the heap */
+	while (libinput->timer.heap_count > 0) {
+		struct libinput_timer *timer = libinput->timer.heap[0];
+
+		if (timer->expire > now)
+			break;
+
+		/* Clear the timer before calling timer_func,
+		   as timer_func may re-arm it */
+		libinput_timer_cancel(timer);
+		timer->timer_func(now, timer->timer_func_data);
 	}
 }
 
@@ -181,6 +320,8 @@ libinput_timer_dispatch(void *data)
 				 "timer: error %d reading from timerfd (%s)",
 				 errno,
 				 strerror(errno));
+	else if (r > 0)
+		libinput->timer.wakeups++;
 
 	now = libinput_now(libinput);
 	if (now == 0)
@@ -197,7 +338,11 @@ libinput_timer_subsys_init(struct libinput *libinput)
 	if (libinput->timer.fd < 0)
 		return -1;
 
-	list_init(&libinput->timer.list);
+	libinput->timer.heap = NULL;
+	libinput->timer.heap_count = 0;
+	libinput->timer.heap_size = 0;
+	libinput->timer.next_expiry = UINT64_MAX;
+	libinput->timer.wakeups = 0;
 
 	libinput->timer.source = libinput_add_fd(libinput,
 						 libinput->timer.fd,
@@ -215,19 +360,16 @@ void
 libinput_timer_subsys_destroy(struct libinput *libinput)
 {
 #ifndef NDEBUG
-	if (!list_empty(&libinput->timer.list)) {
-		struct libinput_timer *t;
-
-		list_for_each(t, &libinput->timer.list, link) {
-			log_bug_libinput(libinput,
-					 "timer: %s still present on shutdown\n",
-					 t->timer_name);
-		}
+	for (size_t i = 0; i < libinput->timer.heap_count; i++) {
+		log_bug_libinput(libinput,
+				 "timer: %s still present on shutdown\n",
+				 libinput->timer.heap[i]->timer_name);
 	}
 #endif
 
 	/* All timer users should have destroyed their timers now */
-	assert(list_empty(&libinput->timer.list));
+	assert(libinput->timer.heap_count == 0);
+	free(libinput->timer.heap);
 
 	libinput_remove_source(libinput, libinput->timer.source);
 	close(libinput->timer.fd);
@@ -240,15 +382,33 @@ libinput_timer_subsys_destroy(struct libinput *libinput)
  * flush any timers.
  *
  * Assume 'now' is the current time check if there is a current timer expiry
- * before this time. If so, trigger the timer func.
+ * before this time. If so, trigger the timer func. This ignores the timer
+ * slack, we're awake anyway and timers must fire before any later event.
  */
 void
 libinput_timer_flush(struct libinput *libinput, uint64_t now)
 {
-	if (libinput->timer.next_expiry == 0 || libinput->timer.next_expiry > now)
+	if (libinput->timer.heap_count == 0 || libinput->timer.heap[0]->expire > now)
+		return;
+
+	libinput_timer_handler(libinput, now);
+}
+
+/**
+ * Called when libinput's clock moved forward, see libinput_clock_advance().
+ * Fire all timers that expired and re-arm the timerfd for the new offset.
+ */
+void
+libinput_timer_clock_changed(struct libinput *libinput)
+{
+	uint64_t now = libinput_now(libinput);
+	if (now == 0)
 		return;
 
+	/* Force a re-arm, the wakeup time may not change */
+	libinput->timer.next_expiry = 0;
 	libinput_timer_handler(libinput, now);
+	libinput_timer_arm_timer_fd(libinput);
 }
 
 uint64_t
@@ -262,5 +422,5 @@ libinput_now(struct libinput *libinput)
 		return 0;
 	}
 
-	return now;
+	return now + libinput_clock_offset(libinput);
 }
@@ -35,8 +35,10 @@ struct libinput;
 struct libinput_timer {
 	struct libinput *libinput;
 	char *timer_name;
-	struct list link;
-	uint64_t expire; /* in absolute us CLOCK_MONOTONIC */
+	size_t heap_index; /* index in libinput->timer.heap while armed */
+	uint64_t seqno;	   /* tie-breaker for timers with the same expiry */
+	uint64_t expire;   /* in absolute us CLOCK_MONOTONIC */
+	uint64_t slack;	   /* in us, see libinput_timer_set_slack() */
 	void (*timer_func)(uint64_t now, void *timer_func_data);
 	void *timer_func_data;
 };
@@ -66,6 +68,17 @@ libinput_timer_set_flags(struct libinput_timer *timer, uint64_t expire, uint32_t
 void
 libinput_timer_cancel(struct libinput_timer *timer);
 
+/* Slack for timers whose expiry is user-visible, e.g. a button press */
+#define TIMER_SLACK_INTERACTIVE ms2us(1)
+/* Slack for timers that only change internal state, e.g. palm detection */
+#define TIMER_SLACK_BACKGROUND ms2us(10)
+
+/* Allow the timer to fire up to slack us after its expiry. Timers are
+ * never fired early, but a timer with slack shares the wakeup of any other
+ * timer that expires within its slack window. The default slack is 0. */
+void
+libinput_timer_set_slack(struct libinput_timer *timer, uint64_t slack);
+
 int
 libinput_timer_subsys_init(struct libinput *libinput);
 
@@ -75,6 +88,9 @@ libinput_timer_subsys_destroy(struct libinput *libinput);
 void
 libinput_timer_flush(struct libinput *libinput, uint64_t now);
 
+void
+libinput_timer_clock_changed(struct libinput *libinput);
+
 uint64_t
 libinput_now(struct libinput *libinput);
 
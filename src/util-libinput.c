@@ -24,6 +24,8 @@
 #include "config.h"
 
 #include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
 
 #include "util-libinput.h"
 #include "util-mem.h"
@@ -143,11 +145,45 @@ event_type_to_str(enum libinput_event_type evtype)
 	return type;
 }
 
-static char *
-print_event_header(struct libinput_event *ev, size_t event_count)
+/* Output goes to fp if set, otherwise into buf. Output that does not fit
+ * into buf is discarded but still counted in len, like snprintf() */
+struct print_sink {
+	FILE *fp;
+	char *buf;
+	size_t size;
+	size_t len;
+};
+
+LIBINPUT_ATTRIBUTE_PRINTF(2, 3)
+static void
+sink_printf(struct print_sink *s, const char *format, ...)
+{
+	va_list args;
+	int n;
+
+	va_start(args, format);
+	if (s->fp) {
+		n = vfprintf(s->fp, format, args);
+	} else {
+		size_t offset = s->size > 0 ? min(s->len, s->size - 1) : 0;
+
+		n = vsnprintf(s->buf + offset, s->size - offset, format, args);
+	}
+	va_end(args);
+
+	if (n > 0)
+		s->len += n;
+}
+
+/* The device of the previous event, use for pointer value only, do not
+ * dereference */
+static void *last_device = NULL;
+
+static void
+print_event_header(struct print_sink *s,
+		   struct libinput_event *ev,
+		   size_t event_count)
 {
-	/* use for pointer value only, do not dereference */
-	static void *last_device = NULL;
 	struct libinput_device *dev = libinput_event_get_device(ev);
 	const char *type = event_type_to_str(libinput_event_get_type(ev));
 	char count[10];
@@ -160,11 +196,12 @@ print_event_header(struct libinput_event *ev, size_t event_count)
 	char prefix = (last_device != dev) ? '-' : ' ';
 	last_device = dev;
 
-	return strdup_printf("%c%-7s  %-23s %s",
-			     prefix,
-			     libinput_device_get_sysname(dev),
-			     type,
-			     count);
+	sink_printf(s,
+		    "%c%-7s  %-23s %s",
+		    prefix,
+		    libinput_device_get_sysname(dev),
+		    type,
+		    count);
 }
 
 static void
@@ -173,26 +210,29 @@ print_event_time(char buf[16], uint32_t start_time, uint32_t time)
 	snprintf(buf, 16, "%+6.3fs", start_time ? (time - start_time) / 1000.0 : 0);
 }
 
-static inline char *
-print_device_options(struct libinput_device *dev)
+static inline void
+print_device_options(struct print_sink *s, struct libinput_device *dev)
 {
 	uint32_t scroll_methods, click_methods;
-	_autofree_ char *tap = NULL;
-	_autofree_ char *scroll = NULL;
-	_autofree_ char *clickm = NULL;
-	_autofree_ char *dwt = NULL;
-	_autofree_ char *dwtp = NULL;
-	_autofree_ char *pad = NULL;
 
 	if (libinput_device_config_tap_get_finger_count(dev)) {
-		tap = strdup_printf(
+		sink_printf(
+			s,
 			" tap (dl %s)",
 			onoff(libinput_device_config_tap_get_drag_lock_enabled(dev)));
 	}
 
+	if (libinput_device_config_left_handed_is_available(dev))
+		sink_printf(s, " left");
+	if (libinput_device_config_scroll_has_natural_scroll(dev))
+		sink_printf(s, " scroll-nat");
+	if (libinput_device_config_calibration_has_matrix(dev))
+		sink_printf(s, " calib");
+
 	scroll_methods = libinput_device_config_scroll_get_methods(dev);
 	if (scroll_methods != LIBINPUT_CONFIG_SCROLL_NO_SCROLL) {
-		scroll = strdup_printf(
+		sink_printf(
+			s,
 			" scroll%s%s%s",
 			(scroll_methods & LIBINPUT_CONFIG_SCROLL_2FG) ? "-2fg" : "",
 			(scroll_methods & LIBINPUT_CONFIG_SCROLL_EDGE) ? "-edge" : "",
@@ -203,7 +243,8 @@ print_device_options(struct libinput_device *dev)
 
 	click_methods = libinput_device_config_click_get_methods(dev);
 	if (click_methods != LIBINPUT_CONFIG_CLICK_METHOD_NONE) {
-		clickm = strdup_printf(
+		sink_printf(
+			s,
 			" click%s%s",
 			(click_methods & LIBINPUT_CONFIG_CLICK_METHOD_BUTTON_AREAS)
 				? "-buttonareas"
@@ -214,43 +255,39 @@ print_device_options(struct libinput_device *dev)
 	}
 
 	if (libinput_device_config_dwt_is_available(dev)) {
-		dwt = strdup_printf(" dwt-%s",
-				    onoff(libinput_device_config_dwt_get_enabled(dev) ==
-					  LIBINPUT_CONFIG_DWT_ENABLED));
+		sink_printf(s,
+			    " dwt-%s",
+			    onoff(libinput_device_config_dwt_get_enabled(dev) ==
+				  LIBINPUT_CONFIG_DWT_ENABLED));
 	}
 
 	if (libinput_device_config_dwtp_is_available(dev)) {
-		dwtp = strdup_printf(
-			" dwtp-%s",
-			onoff(libinput_device_config_dwtp_get_enabled(dev) ==
-			      LIBINPUT_CONFIG_DWTP_ENABLED));
+		sink_printf(s,
+			    " dwtp-%s",
+			    onoff(libinput_device_config_dwtp_get_enabled(dev) ==
+				  LIBINPUT_CONFIG_DWTP_ENABLED));
 	}
 
-	if (libinput_device_has_capability(dev, LIBINPUT_DEVICE_CAP_TABLET_PAD)) {
-		pad = strdup_printf(
-			" buttons:%d strips:%d rings:%d mode groups:%d",
-			libinput_device_tablet_pad_get_num_buttons(dev),
-			libinput_device_tablet_pad_get_num_strips(dev),
-			libinput_device_tablet_pad_get_num_rings(dev),
-			libinput_device_tablet_pad_get_num_mode_groups(dev));
+	if (libinput_device_config_pointer_prediction_is_available(dev)) {
+		enum libinput_config_pointer_prediction_state prediction =
+			libinput_device_config_pointer_prediction_get_enabled(dev);
+		bool enabled = prediction == LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED;
+
+		sink_printf(s, " prediction-%s", onoff(enabled));
 	}
 
-	return strdup_printf(
-		"%s%s%s%s%s%s%s%s%s",
-		tap ? tap : "",
-		libinput_device_config_left_handed_is_available(dev) ? " left" : "",
-		libinput_device_config_scroll_has_natural_scroll(dev) ? " scroll-nat"
-								      : "",
-		libinput_device_config_calibration_has_matrix(dev) ? " calib" : "",
-		scroll ? scroll : "",
-		clickm ? clickm : "",
-		dwt ? dwt : "",
-		dwtp ? dwtp : "",
-		pad ? pad : "");
+	if (libinput_device_has_capability(dev, LIBINPUT_DEVICE_CAP_TABLET_PAD)) {
+		sink_printf(s,
+			    " buttons:%d strips:%d rings:%d mode groups:%d",
+			    libinput_device_tablet_pad_get_num_buttons(dev),
+			    libinput_device_tablet_pad_get_num_strips(dev),
+			    libinput_device_tablet_pad_get_num_rings(dev),
+			    libinput_device_tablet_pad_get_num_mode_groups(dev));
+	}
 }
 
-static char *
-print_device_notify(struct libinput_event *ev)
+static void
+print_device_notify(struct print_sink *s, struct libinput_event *ev)
 {
 	struct libinput_device *dev = libinput_event_get_device(ev);
 	struct libinput_seat *seat = libinput_device_get_seat(dev);
@@ -258,9 +295,6 @@ print_device_notify(struct libinput_event *ev)
 	double w, h;
 	static int next_group_id = 0;
 	intptr_t group_id;
-	_autofree_ char *size = NULL;
-	_autofree_ char *ntouches = NULL;
-	_autofree_ char *options = NULL;
 
 	group = libinput_device_get_device_group(dev);
 	group_id = (intptr_t)libinput_device_group_get_user_data(group);
@@ -269,18 +303,9 @@ print_device_notify(struct libinput_event *ev)
 		libinput_device_group_set_user_data(group, (void *)group_id);
 	}
 
-	if (libinput_device_get_size(dev, &w, &h) == 0)
-		size = strdup_printf("  size %.0fx%.0fmm", w, h);
-
-	if (libinput_device_has_capability(dev, LIBINPUT_DEVICE_CAP_TOUCH))
-		ntouches = strdup_printf(" ntouches %d",
-					 libinput_device_touch_get_touch_count(dev));
-
-	if (libinput_event_get_type(ev) == LIBINPUT_EVENT_DEVICE_ADDED)
-		options = print_device_options(dev);
-
-	return strdup_printf(
-		"%-33s %5s %7s group%-2d cap:%s%s%s%s%s%s%s%s%s%s",
+	sink_printf(
+		s,
+		"%-33s %5s %7s group%-2d cap:%s%s%s%s%s%s%s",
 		libinput_device_get_name(dev),
 		libinput_seat_get_physical_name(seat),
 		libinput_seat_get_logical_name(seat),
@@ -300,14 +325,24 @@ print_device_notify(struct libinput_event *ev)
 			? "P"
 			: "",
 		libinput_device_has_capability(dev, LIBINPUT_DEVICE_CAP_SWITCH) ? "S"
-										: "",
-		size ? size : "",
-		ntouches ? ntouches : "",
-		options ? options : "");
+										: "");
+
+	if (libinput_device_get_size(dev, &w, &h) == 0)
+		sink_printf(s, "  size %.0fx%.0fmm", w, h);
+
+	if (libinput_device_has_capability(dev, LIBINPUT_DEVICE_CAP_TOUCH))
+		sink_printf(s,
+			    " ntouches %d",
+			    libinput_device_touch_get_touch_count(dev));
+
+	if (libinput_event_get_type(ev) == LIBINPUT_EVENT_DEVICE_ADDED)
+		print_device_options(s, dev);
 }
 
-static char *
-print_key_event(struct libinput_event *ev, const struct libinput_print_options *opts)
+static void
+print_key_event(struct print_sink *s,
+		struct libinput_event *ev,
+		const struct libinput_print_options *opts)
 {
 	struct libinput_event_keyboard *k = libinput_event_get_keyboard_event(ev);
 	enum libinput_key_state state;
@@ -326,16 +361,18 @@ print_key_event(struct libinput_event *ev, const struct libinput_print_options *
 		keyname = libevdev_event_code_get_name(EV_KEY, key);
 		keyname = keyname ? keyname : "???";
 	}
-	return strdup_printf("%s\t%s (%d) %s",
-			     time,
-			     keyname,
-			     key,
-			     state == LIBINPUT_KEY_STATE_PRESSED ? "pressed"
-								 : "released");
+	sink_printf(s,
+		    "%s\t%s (%d) %s",
+		    time,
+		    keyname,
+		    key,
+		    state == LIBINPUT_KEY_STATE_PRESSED ? "pressed" : "released");
 }
 
-static char *
-print_motion_event(struct libinput_event *ev, const struct libinput_print_options *opts)
+static void
+print_motion_event(struct print_sink *s,
+		   struct libinput_event *ev,
+		   const struct libinput_print_options *opts)
 {
 	struct libinput_event_pointer *p = libinput_event_get_pointer_event(ev);
 	double x = libinput_event_pointer_get_dx(p);
@@ -346,11 +383,12 @@ print_motion_event(struct libinput_event *ev, const struct libinput_print_option
 
 	print_event_time(time, opts->start_time, libinput_event_pointer_get_time(p));
 
-	return strdup_printf("%s\t%6.2f/%6.2f (%+6.2f/%+6.2f)", time, x, y, ux, uy);
+	sink_printf(s, "%s\t%6.2f/%6.2f (%+6.2f/%+6.2f)", time, x, y, ux, uy);
 }
 
-static char *
-print_absmotion_event(struct libinput_event *ev,
+static void
+print_absmotion_event(struct print_sink *s,
+		      struct libinput_event *ev,
 		      const struct libinput_print_options *opts)
 {
 	struct libinput_event_pointer *p = libinput_event_get_pointer_event(ev);
@@ -363,11 +401,12 @@ print_absmotion_event(struct libinput_event *ev,
 	char time[16];
 
 	print_event_time(time, opts->start_time, libinput_event_pointer_get_time(p));
-	return strdup_printf("%s\t%6.2f/%6.2f", time, x, y);
+	sink_printf(s, "%s\t%6.2f/%6.2f", time, x, y);
 }
 
-static char *
-print_pointer_button_event(struct libinput_event *ev,
+static void
+print_pointer_button_event(struct print_sink *s,
+			   struct libinput_event *ev,
 			   const struct libinput_print_options *opts)
 {
 	struct libinput_event_pointer *p = libinput_event_get_pointer_event(ev);
@@ -382,38 +421,42 @@ print_pointer_button_event(struct libinput_event *ev,
 	buttonname = libevdev_event_code_get_name(EV_KEY, button);
 
 	state = libinput_event_pointer_get_button_state(p);
-	return strdup_printf("%s\t%s (%d) %s, seat count: %u",
-			     time,
-			     buttonname ? buttonname : "???",
-			     button,
-			     state == LIBINPUT_BUTTON_STATE_PRESSED ? "pressed"
-								    : "released",
-			     libinput_event_pointer_get_seat_button_count(p));
+	sink_printf(s,
+		    "%s\t%s (%d) %s, seat count: %u",
+		    time,
+		    buttonname ? buttonname : "???",
+		    button,
+		    state == LIBINPUT_BUTTON_STATE_PRESSED ? "pressed" : "released",
+		    libinput_event_pointer_get_seat_button_count(p));
 }
 
-static char *
-print_tablet_axes(struct libinput_event_tablet_tool *t)
+static void
+print_tablet_axes(struct print_sink *s, struct libinput_event_tablet_tool *t)
 {
 	struct libinput_tablet_tool *tool = libinput_event_tablet_tool_get_tool(t);
 	double x, y;
-	_autofree_ char *tilt = NULL;
-	_autofree_ char *distance = NULL;
-	_autofree_ char *rot = NULL;
-	_autofree_ char *whl = NULL;
-	_autofree_ char *sld = NULL;
-	_autofree_ char *size = NULL;
 
 #define changed_sym(ev, ax) \
 	(libinput_event_tablet_tool_##ax##_has_changed(ev) ? "*" : " ")
 
+	x = libinput_event_tablet_tool_get_x(t);
+	y = libinput_event_tablet_tool_get_y(t);
+	sink_printf(s,
+		    "\t%.2f%s/%.2f%s",
+		    x,
+		    changed_sym(t, x),
+		    y,
+		    changed_sym(t, y));
+
 	if (libinput_tablet_tool_has_tilt(tool)) {
 		x = libinput_event_tablet_tool_get_tilt_x(t);
 		y = libinput_event_tablet_tool_get_tilt_y(t);
-		tilt = strdup_printf("\ttilt: %.2f%s/%.2f%s",
-				     x,
-				     changed_sym(t, tilt_x),
-				     y,
-				     changed_sym(t, tilt_y));
+		sink_printf(s,
+			    "\ttilt: %.2f%s/%.2f%s",
+			    x,
+			    changed_sym(t, tilt_x),
+			    y,
+			    changed_sym(t, tilt_y));
 	}
 
 	if (libinput_tablet_tool_has_distance(tool) ||
@@ -421,63 +464,55 @@ print_tablet_axes(struct libinput_event_tablet_tool *t)
 		double dist = libinput_event_tablet_tool_get_distance(t);
 		double pressure = libinput_event_tablet_tool_get_pressure(t);
 		if (dist)
-			distance = strdup_printf("\tdistance: %.2f%s",
-						 dist,
-						 changed_sym(t, distance));
+			sink_printf(s,
+				    "\tdistance: %.2f%s",
+				    dist,
+				    changed_sym(t, distance));
 		else
-			distance = strdup_printf("\tpressure: %.2f%s",
-						 pressure,
-						 changed_sym(t, pressure));
+			sink_printf(s,
+				    "\tpressure: %.2f%s",
+				    pressure,
+				    changed_sym(t, pressure));
 	}
 
 	if (libinput_tablet_tool_has_rotation(tool)) {
 		double rotation = libinput_event_tablet_tool_get_rotation(t);
-		rot = strdup_printf("\trotation: %6.2f%s",
-				    rotation,
-				    changed_sym(t, rotation));
-	}
-
-	if (libinput_tablet_tool_has_slider(tool)) {
-		double slider = libinput_event_tablet_tool_get_slider_position(t);
-		sld = strdup_printf("\tslider: %.2f%s", slider, changed_sym(t, slider));
+		sink_printf(s,
+			    "\trotation: %6.2f%s",
+			    rotation,
+			    changed_sym(t, rotation));
 	}
 
 	if (libinput_tablet_tool_has_wheel(tool)) {
 		double wheel = libinput_event_tablet_tool_get_wheel_delta(t);
 		double delta = libinput_event_tablet_tool_get_wheel_delta_discrete(t);
-		whl = strdup_printf("\twheel: %.2f%s (%d)",
-				    wheel,
-				    changed_sym(t, wheel),
-				    (int)delta);
+		sink_printf(s,
+			    "\twheel: %.2f%s (%d)",
+			    wheel,
+			    changed_sym(t, wheel),
+			    (int)delta);
+	}
+
+	if (libinput_tablet_tool_has_slider(tool)) {
+		double slider = libinput_event_tablet_tool_get_slider_position(t);
+		sink_printf(s, "\tslider: %.2f%s", slider, changed_sym(t, slider));
 	}
 
 	if (libinput_tablet_tool_has_size(tool)) {
 		double major = libinput_event_tablet_tool_get_size_major(t);
 		double minor = libinput_event_tablet_tool_get_size_minor(t);
-		size = strdup_printf("\tsize: %.2f%s/%.2f%s",
-				     major,
-				     changed_sym(t, size_major),
-				     minor,
-				     changed_sym(t, size_minor));
+		sink_printf(s,
+			    "\tsize: %.2f%s/%.2f%s",
+			    major,
+			    changed_sym(t, size_major),
+			    minor,
+			    changed_sym(t, size_minor));
 	}
-
-	x = libinput_event_tablet_tool_get_x(t);
-	y = libinput_event_tablet_tool_get_y(t);
-	return strdup_printf("\t%.2f%s/%.2f%s%s%s%s%s%s%s",
-			     x,
-			     changed_sym(t, x),
-			     y,
-			     changed_sym(t, y),
-			     tilt ? tilt : "",
-			     distance ? distance : "",
-			     rot ? rot : "",
-			     whl ? whl : "",
-			     sld ? sld : "",
-			     size ? size : "");
 }
 
-static char *
-print_tablet_tip_event(struct libinput_event *ev,
+static void
+print_tablet_tip_event(struct print_sink *s,
+		       struct libinput_event *ev,
 		       const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_tool *t = libinput_event_get_tablet_tool_event(ev);
@@ -488,17 +523,15 @@ print_tablet_tip_event(struct libinput_event *ev,
 			 opts->start_time,
 			 libinput_event_tablet_tool_get_time(t));
 
-	_autofree_ char *axes = print_tablet_axes(t);
-
 	state = libinput_event_tablet_tool_get_tip_state(t);
-	return strdup_printf("%s\t%s %s",
-			     time,
-			     axes,
-			     state == LIBINPUT_TABLET_TOOL_TIP_DOWN ? "down" : "up");
+	sink_printf(s, "%s\t", time);
+	print_tablet_axes(s, t);
+	sink_printf(s, " %s", state == LIBINPUT_TABLET_TOOL_TIP_DOWN ? "down" : "up");
 }
 
-static char *
-print_tablet_button_event(struct libinput_event *ev,
+static void
+print_tablet_button_event(struct print_sink *s,
+			  struct libinput_event *ev,
 			  const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_tool *p = libinput_event_get_tablet_tool_event(ev);
@@ -515,17 +548,18 @@ print_tablet_button_event(struct libinput_event *ev,
 	buttonname = libevdev_event_code_get_name(EV_KEY, button);
 
 	state = libinput_event_tablet_tool_get_button_state(p);
-	return strdup_printf("%s\ts%3d (%s) %s, seat count: %u",
-			     time,
-			     button,
-			     buttonname ? buttonname : "???",
-			     state == LIBINPUT_BUTTON_STATE_PRESSED ? "pressed"
-								    : "released",
-			     libinput_event_tablet_tool_get_seat_button_count(p));
+	sink_printf(s,
+		    "%s\ts%3d (%s) %s, seat count: %u",
+		    time,
+		    button,
+		    buttonname ? buttonname : "???",
+		    state == LIBINPUT_BUTTON_STATE_PRESSED ? "pressed" : "released",
+		    libinput_event_tablet_tool_get_seat_button_count(p));
 }
 
-static char *
-print_legacy_pointer_axis_event(struct libinput_event *ev,
+static void
+print_legacy_pointer_axis_event(struct print_sink *s,
+				struct libinput_event *ev,
 				const struct libinput_print_options *opts)
 {
 	struct libinput_event_pointer *p = libinput_event_get_pointer_event(ev);
@@ -569,19 +603,21 @@ print_legacy_pointer_axis_event(struct libinput_event *ev,
 	}
 
 	print_event_time(time, opts->start_time, libinput_event_pointer_get_time(p));
-	return strdup_printf("%s\tvert %.2f/%d%s horiz %.2f/%d%s (%s)",
-			     time,
-			     v,
-			     v_discrete,
-			     have_vert,
-			     h,
-			     h_discrete,
-			     have_horiz,
-			     source);
+	sink_printf(s,
+		    "%s\tvert %.2f/%d%s horiz %.2f/%d%s (%s)",
+		    time,
+		    v,
+		    v_discrete,
+		    have_vert,
+		    h,
+		    h_discrete,
+		    have_horiz,
+		    source);
 }
 
-static char *
-print_pointer_axis_event(struct libinput_event *ev,
+static void
+print_pointer_axis_event(struct print_sink *s,
+			 struct libinput_event *ev,
 			 const struct libinput_print_options *opts)
 {
 	struct libinput_event_pointer *p = libinput_event_get_pointer_event(ev);
@@ -625,19 +661,21 @@ print_pointer_axis_event(struct libinput_event *ev,
 	}
 
 	print_event_time(time, opts->start_time, libinput_event_pointer_get_time(p));
-	return strdup_printf("%s\tvert %.2f/%.1f%s horiz %.2f/%.1f%s (%s)",
-			     time,
-			     v,
-			     v120,
-			     have_vert,
-			     h,
-			     h120,
-			     have_horiz,
-			     source);
+	sink_printf(s,
+		    "%s\tvert %.2f/%.1f%s horiz %.2f/%.1f%s (%s)",
+		    time,
+		    v,
+		    v120,
+		    have_vert,
+		    h,
+		    h120,
+		    have_horiz,
+		    source);
 }
 
-static char *
-print_tablet_axis_event(struct libinput_event *ev,
+static void
+print_tablet_axis_event(struct print_sink *s,
+			struct libinput_event *ev,
 			const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_tool *t = libinput_event_get_tablet_tool_event(ev);
@@ -646,13 +684,14 @@ print_tablet_axis_event(struct libinput_event *ev,
 	print_event_time(time,
 			 opts->start_time,
 			 libinput_event_tablet_tool_get_time(t));
-	_autofree_ char *axes = print_tablet_axes(t);
 
-	return strdup_printf("%s\t%s", time, axes);
+	sink_printf(s, "%s\t", time);
+	print_tablet_axes(s, t);
 }
 
-static char *
-print_proximity_event(struct libinput_event *ev,
+static void
+print_proximity_event(struct print_sink *s,
+		      struct libinput_event *ev,
 		      const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_tool *t = libinput_event_get_tablet_tool_event(ev);
@@ -660,8 +699,6 @@ print_proximity_event(struct libinput_event *ev,
 	enum libinput_tablet_tool_proximity_state state;
 	const char *tool_str, *state_str;
 	char time[16];
-	_autofree_ char *axes = NULL;
-	_autofree_ char *proxin = NULL;
 
 	switch (libinput_tablet_tool_get_type(tool)) {
 	case LIBINPUT_TABLET_TOOL_TYPE_PEN:
@@ -698,18 +735,25 @@ print_proximity_event(struct libinput_event *ev,
 			 opts->start_time,
 			 libinput_event_tablet_tool_get_time(t));
 
-	if (state == LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN) {
-		axes = print_tablet_axes(t);
+	if (state == LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN)
 		state_str = "proximity-in";
-	} else if (state == LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_OUT) {
-		axes = print_tablet_axes(t);
+	else if (state == LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_OUT)
 		state_str = "proximity-out";
-	} else {
+	else
 		abort();
-	}
+
+	sink_printf(s, "%s\t", time);
+	print_tablet_axes(s, t);
+	sink_printf(s,
+		    "\t%-8s (%#" PRIx64 ", id %#" PRIx64 ") %s",
+		    tool_str,
+		    libinput_tablet_tool_get_serial(tool),
+		    libinput_tablet_tool_get_tool_id(tool),
+		    state_str);
 
 	if (state == LIBINPUT_TABLET_TOOL_PROXIMITY_STATE_IN) {
-		proxin = strdup_printf(
+		sink_printf(
+			s,
 			"\taxes:%s%s%s%s%s%s\tbtn:%s%s%s%s%s%s%s%s%s%s",
 			libinput_tablet_tool_has_distance(tool) ? "d" : "",
 			libinput_tablet_tool_has_pressure(tool) ? "p" : "",
@@ -728,32 +772,25 @@ print_proximity_event(struct libinput_event *ev,
 			libinput_tablet_tool_has_button(tool, BTN_EXTRA) ? "Ex" : "",
 			libinput_tablet_tool_has_button(tool, BTN_0) ? "0" : "");
 	}
-
-	return strdup_printf("%s\t%s\t%-8s (%#" PRIx64 ", id %#" PRIx64 ") %s%s",
-			     time,
-			     axes ? axes : "",
-			     tool_str,
-			     libinput_tablet_tool_get_serial(tool),
-			     libinput_tablet_tool_get_tool_id(tool),
-			     state_str,
-			     proxin ? proxin : "");
 }
 
-static char *
-print_touch_event(struct libinput_event *ev, const struct libinput_print_options *opts)
+static void
+print_touch_event(struct print_sink *s,
+		  struct libinput_event *ev,
+		  const struct libinput_print_options *opts)
 {
 	struct libinput_event_touch *t = libinput_event_get_touch_event(ev);
 	enum libinput_event_type type = libinput_event_get_type(ev);
 	char time[16];
-	_autofree_ char *slot = NULL;
-	_autofree_ char *pos = NULL;
 
 	print_event_time(time, opts->start_time, libinput_event_touch_get_time(t));
+	sink_printf(s, "%s\t", time);
 
 	if (type != LIBINPUT_EVENT_TOUCH_FRAME) {
-		slot = strdup_printf("%d (%d)",
-				     libinput_event_touch_get_slot(t),
-				     libinput_event_touch_get_seat_slot(t));
+		sink_printf(s,
+			    "%d (%d)",
+			    libinput_event_touch_get_slot(t),
+			    libinput_event_touch_get_seat_slot(t));
 	}
 
 	if (type == LIBINPUT_EVENT_TOUCH_DOWN || type == LIBINPUT_EVENT_TOUCH_MOTION) {
@@ -764,14 +801,13 @@ print_touch_event(struct libinput_event *ev, const struct libinput_print_options
 		double xmm = libinput_event_touch_get_x(t);
 		double ymm = libinput_event_touch_get_y(t);
 
-		pos = strdup_printf(" %5.2f/%5.2f (%5.2f/%5.2fmm)", x, y, xmm, ymm);
+		sink_printf(s, " %5.2f/%5.2f (%5.2f/%5.2fmm)", x, y, xmm, ymm);
 	}
-
-	return strdup_printf("%s\t%s%s", time, slot ? slot : "", pos ? pos : "");
 }
 
-static char *
-print_gesture_event_without_coords(struct libinput_event *ev,
+static void
+print_gesture_event_without_coords(struct print_sink *s,
+				   struct libinput_event *ev,
 				   const struct libinput_print_options *opts)
 {
 	struct libinput_event_gesture *t = libinput_event_get_gesture_event(ev);
@@ -788,14 +824,16 @@ print_gesture_event_without_coords(struct libinput_event *ev,
 		cancelled = libinput_event_gesture_get_cancelled(t);
 
 	print_event_time(time, opts->start_time, libinput_event_gesture_get_time(t));
-	return strdup_printf("%s\t%d%s",
-			     time,
-			     finger_count,
-			     cancelled ? " cancelled" : "");
+	sink_printf(s,
+		    "%s\t%d%s",
+		    time,
+		    finger_count,
+		    cancelled ? " cancelled" : "");
 }
 
-static char *
-print_gesture_event_with_coords(struct libinput_event *ev,
+static void
+print_gesture_event_with_coords(struct print_sink *s,
+				struct libinput_event *ev,
 				const struct libinput_print_options *opts)
 {
 	struct libinput_event_gesture *t = libinput_event_get_gesture_event(ev);
@@ -804,29 +842,29 @@ print_gesture_event_with_coords(struct libinput_event *ev,
 	double dx_unaccel = libinput_event_gesture_get_dx_unaccelerated(t);
 	double dy_unaccel = libinput_event_gesture_get_dy_unaccelerated(t);
 	char time[16];
-	_autofree_ char *pinch = NULL;
 
 	print_event_time(time, opts->start_time, libinput_event_gesture_get_time(t));
 
+	sink_printf(s,
+		    "%s\t%d %5.2f/%5.2f (%5.2f/%5.2f unaccelerated)",
+		    time,
+		    libinput_event_gesture_get_finger_count(t),
+		    dx,
+		    dy,
+		    dx_unaccel,
+		    dy_unaccel);
+
 	if (libinput_event_get_type(ev) == LIBINPUT_EVENT_GESTURE_PINCH_UPDATE) {
 		double scale = libinput_event_gesture_get_scale(t);
 		double angle = libinput_event_gesture_get_angle_delta(t);
 
-		pinch = strdup_printf(" %5.2f @ %5.2f", scale, angle);
+		sink_printf(s, " %5.2f @ %5.2f", scale, angle);
 	}
-
-	return strdup_printf("%s\t%d %5.2f/%5.2f (%5.2f/%5.2f unaccelerated)%s",
-			     time,
-			     libinput_event_gesture_get_finger_count(t),
-			     dx,
-			     dy,
-			     dx_unaccel,
-			     dy_unaccel,
-			     pinch ? pinch : "");
 }
 
-static char *
-print_tablet_pad_button_event(struct libinput_event *ev,
+static void
+print_tablet_pad_button_event(struct print_sink *s,
+			      struct libinput_event *ev,
 			      const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_pad *p = libinput_event_get_tablet_pad_event(ev);
@@ -846,16 +884,17 @@ print_tablet_pad_button_event(struct libinput_event *ev,
 	if (libinput_tablet_pad_mode_group_button_is_toggle(group, button))
 		toggle = " <mode toggle>";
 
-	return strdup_printf("%3d %s (mode %d)%s",
-			     button,
-			     state == LIBINPUT_BUTTON_STATE_PRESSED ? "pressed"
-								    : "released",
-			     mode,
-			     toggle ? toggle : "");
+	sink_printf(s,
+		    "%3d %s (mode %d)%s",
+		    button,
+		    state == LIBINPUT_BUTTON_STATE_PRESSED ? "pressed" : "released",
+		    mode,
+		    toggle ? toggle : "");
 }
 
-static char *
-print_tablet_pad_ring_event(struct libinput_event *ev,
+static void
+print_tablet_pad_ring_event(struct print_sink *s,
+			    struct libinput_event *ev,
 			    const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_pad *p = libinput_event_get_tablet_pad_event(ev);
@@ -875,16 +914,18 @@ print_tablet_pad_ring_event(struct libinput_event *ev,
 	}
 
 	mode = libinput_event_tablet_pad_get_mode(p);
-	return strdup_printf("%s\tring %d position %.2f (source %s) (mode %d)",
-			     time,
-			     libinput_event_tablet_pad_get_ring_number(p),
-			     libinput_event_tablet_pad_get_ring_position(p),
-			     source,
-			     mode);
+	sink_printf(s,
+		    "%s\tring %d position %.2f (source %s) (mode %d)",
+		    time,
+		    libinput_event_tablet_pad_get_ring_number(p),
+		    libinput_event_tablet_pad_get_ring_position(p),
+		    source,
+		    mode);
 }
 
-static char *
-print_tablet_pad_strip_event(struct libinput_event *ev,
+static void
+print_tablet_pad_strip_event(struct print_sink *s,
+			     struct libinput_event *ev,
 			     const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_pad *p = libinput_event_get_tablet_pad_event(ev);
@@ -904,16 +945,18 @@ print_tablet_pad_strip_event(struct libinput_event *ev,
 	}
 
 	mode = libinput_event_tablet_pad_get_mode(p);
-	return strdup_printf("%s\tstrip %d position %.2f (source %s) (mode %d)",
-			     time,
-			     libinput_event_tablet_pad_get_strip_number(p),
-			     libinput_event_tablet_pad_get_strip_position(p),
-			     source,
-			     mode);
+	sink_printf(s,
+		    "%s\tstrip %d position %.2f (source %s) (mode %d)",
+		    time,
+		    libinput_event_tablet_pad_get_strip_number(p),
+		    libinput_event_tablet_pad_get_strip_position(p),
+		    source,
+		    mode);
 }
 
-static char *
-print_tablet_pad_key_event(struct libinput_event *ev,
+static void
+print_tablet_pad_key_event(struct print_sink *s,
+			   struct libinput_event *ev,
 			   const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_pad *p = libinput_event_get_tablet_pad_event(ev);
@@ -933,16 +976,17 @@ print_tablet_pad_key_event(struct libinput_event *ev,
 		keyname = keyname ? keyname : "???";
 	}
 	state = libinput_event_tablet_pad_get_key_state(p);
-	return strdup_printf("%s\t%s (%d) %s",
-			     time,
-			     keyname,
-			     key,
-			     state == LIBINPUT_KEY_STATE_PRESSED ? "pressed"
-								 : "released");
+	sink_printf(s,
+		    "%s\t%s (%d) %s",
+		    time,
+		    keyname,
+		    key,
+		    state == LIBINPUT_KEY_STATE_PRESSED ? "pressed" : "released");
 }
 
-static char *
-print_tablet_pad_dial_event(struct libinput_event *ev,
+static void
+print_tablet_pad_dial_event(struct print_sink *s,
+			    struct libinput_event *ev,
 			    const struct libinput_print_options *opts)
 {
 	struct libinput_event_tablet_pad *p = libinput_event_get_tablet_pad_event(ev);
@@ -952,15 +996,18 @@ print_tablet_pad_dial_event(struct libinput_event *ev,
 	print_event_time(time, opts->start_time, libinput_event_tablet_pad_get_time(p));
 
 	mode = libinput_event_tablet_pad_get_mode(p);
-	return strdup_printf("%s\tdial %d delta %.2f (mode %d)",
-			     time,
-			     libinput_event_tablet_pad_get_dial_number(p),
-			     libinput_event_tablet_pad_get_dial_delta_v120(p),
-			     mode);
+	sink_printf(s,
+		    "%s\tdial %d delta %.2f (mode %d)",
+		    time,
+		    libinput_event_tablet_pad_get_dial_number(p),
+		    libinput_event_tablet_pad_get_dial_delta_v120(p),
+		    mode);
 }
 
-static char *
-print_switch_event(struct libinput_event *ev, const struct libinput_print_options *opts)
+static void
+print_switch_event(struct print_sink *s,
+		   struct libinput_event *ev,
+		   const struct libinput_print_options *opts)
 {
 	struct libinput_event_switch *sw = libinput_event_get_switch_event(ev);
 	enum libinput_switch_state state;
@@ -982,17 +1029,16 @@ print_switch_event(struct libinput_event *ev, const struct libinput_print_option
 
 	state = libinput_event_switch_get_switch_state(sw);
 
-	return strdup_printf("%s\tswitch %s state %d", time, which, state);
+	sink_printf(s, "%s\tswitch %s state %d", time, which, state);
 }
 
-char *
-libinput_event_to_str(struct libinput_event *ev,
-		      size_t event_repeat_count,
-		      const struct libinput_print_options *options)
+static void
+print_event(struct print_sink *s,
+	    struct libinput_event *ev,
+	    size_t event_repeat_count,
+	    const struct libinput_print_options *options)
 {
 	enum libinput_event_type type = libinput_event_get_type(ev);
-	_autofree_ char *event_header = print_event_header(ev, event_repeat_count);
-	_autofree_ char *event_str = NULL;
 
 	struct libinput_print_options opts = {
 		.start_time = options ? options->start_time : 0,
@@ -1006,99 +1052,160 @@ libinput_event_to_str(struct libinput_event *ev,
 
 	};
 
+	print_event_header(s, ev, event_repeat_count);
+	sink_printf(s, " ");
+
 	switch (type) {
 	case LIBINPUT_EVENT_NONE:
 		abort();
 	case LIBINPUT_EVENT_DEVICE_ADDED:
-		event_str = print_device_notify(ev);
-		break;
 	case LIBINPUT_EVENT_DEVICE_REMOVED:
-		event_str = print_device_notify(ev);
+		print_device_notify(s, ev);
 		break;
 	case LIBINPUT_EVENT_KEYBOARD_KEY:
-		event_str = print_key_event(ev, &opts);
+		print_key_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_POINTER_MOTION:
-		event_str = print_motion_event(ev, &opts);
+		print_motion_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE:
-		event_str = print_absmotion_event(ev, &opts);
+		print_absmotion_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_POINTER_BUTTON:
-		event_str = print_pointer_button_event(ev, &opts);
+		print_pointer_button_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_POINTER_AXIS:
-		event_str = print_legacy_pointer_axis_event(ev, &opts);
+		print_legacy_pointer_axis_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_POINTER_SCROLL_WHEEL:
 	case LIBINPUT_EVENT_POINTER_SCROLL_FINGER:
 	case LIBINPUT_EVENT_POINTER_SCROLL_CONTINUOUS:
-		event_str = print_pointer_axis_event(ev, &opts);
+		print_pointer_axis_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TOUCH_DOWN:
 	case LIBINPUT_EVENT_TOUCH_MOTION:
 	case LIBINPUT_EVENT_TOUCH_UP:
 	case LIBINPUT_EVENT_TOUCH_CANCEL:
-		event_str = print_touch_event(ev, &opts);
-		break;
 	case LIBINPUT_EVENT_TOUCH_FRAME:
-		event_str = print_touch_event(ev, &opts);
+		print_touch_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN:
-		event_str = print_gesture_event_without_coords(ev, &opts);
-		break;
-	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
-		event_str = print_gesture_event_with_coords(ev, &opts);
-		break;
 	case LIBINPUT_EVENT_GESTURE_SWIPE_END:
-		event_str = print_gesture_event_without_coords(ev, &opts);
-		break;
 	case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN:
-		event_str = print_gesture_event_without_coords(ev, &opts);
-		break;
-	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
-		event_str = print_gesture_event_with_coords(ev, &opts);
-		break;
 	case LIBINPUT_EVENT_GESTURE_PINCH_END:
-		event_str = print_gesture_event_without_coords(ev, &opts);
-		break;
 	case LIBINPUT_EVENT_GESTURE_HOLD_BEGIN:
-		event_str = print_gesture_event_without_coords(ev, &opts);
-		break;
 	case LIBINPUT_EVENT_GESTURE_HOLD_END:
-		event_str = print_gesture_event_without_coords(ev, &opts);
+		print_gesture_event_without_coords(s, ev, &opts);
+		break;
+	case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE:
+	case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE:
+		print_gesture_event_with_coords(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
-		event_str = print_tablet_axis_event(ev, &opts);
+		print_tablet_axis_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
-		event_str = print_proximity_event(ev, &opts);
+		print_proximity_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_TOOL_TIP:
-		event_str = print_tablet_tip_event(ev, &opts);
+		print_tablet_tip_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_TOOL_BUTTON:
-		event_str = print_tablet_button_event(ev, &opts);
+		print_tablet_button_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_PAD_BUTTON:
-		event_str = print_tablet_pad_button_event(ev, &opts);
+		print_tablet_pad_button_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_PAD_RING:
-		event_str = print_tablet_pad_ring_event(ev, &opts);
+		print_tablet_pad_ring_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_PAD_STRIP:
-		event_str = print_tablet_pad_strip_event(ev, &opts);
+		print_tablet_pad_strip_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_PAD_KEY:
-		event_str = print_tablet_pad_key_event(ev, &opts);
+		print_tablet_pad_key_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_TABLET_PAD_DIAL:
-		event_str = print_tablet_pad_dial_event(ev, &opts);
+		print_tablet_pad_dial_event(s, ev, &opts);
 		break;
 	case LIBINPUT_EVENT_SWITCH_TOGGLE:
-		event_str = print_switch_event(ev, &opts);
+		print_switch_event(s, ev, &opts);
 		break;
 	}
+}
+
+size_t
+libinput_event_format(struct libinput_event *ev,
+		      size_t event_repeat_count,
+		      const struct libinput_print_options *options,
+		      char *buf,
+		      size_t size)
+{
+	struct print_sink sink = {
+		.buf = buf,
+		.size = size,
+	};
+
+	if (size > 0)
+		buf[0] = '\0';
+
+	print_event(&sink, ev, event_repeat_count, options);
+
+	return sink.len;
+}
+
+size_t
+libinput_event_print(FILE *fp,
+		     struct libinput_event *ev,
+		     size_t event_repeat_count,
+		     const struct libinput_print_options *options)
+{
+	struct print_sink sink = {
+		.fp = fp,
+	};
 
-	return strdup_printf("%s %s", event_header, event_str);
+	print_event(&sink, ev, event_repeat_count, options);
+
+	return sink.len;
+}
+
+const char *
+libinput_event_format_fallback(struct libinput_event *ev,
+			       size_t event_repeat_count,
+			       const struct libinput_print_options *options,
+			       char *buf,
+			       size_t size,
+			       char **alloc)
+{
+	void *prev_device = last_device;
+	size_t len = libinput_event_format(ev, event_repeat_count, options, buf, size);
+
+	*alloc = NULL;
+	if (len < size)
+		return buf;
+
+	/* Too long, format again with the same header state */
+	last_device = prev_device;
+
+	*alloc = zalloc(len + 1);
+	libinput_event_format(ev, event_repeat_count, options, *alloc, len + 1);
+
+	return *alloc;
+}
+
+char *
+libinput_event_to_str(struct libinput_event *ev,
+		      size_t event_repeat_count,
+		      const struct libinput_print_options *options)
+{
+	char buf[512];
+	char *str;
+	const char *formatted = libinput_event_format_fallback(ev,
+							       event_repeat_count,
+							       options,
+							       buf,
+							       sizeof(buf),
+							       &str);
+
+	return str ? str : safe_strdup(formatted);
 }
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "libinput.h"
 
@@ -34,6 +35,45 @@ struct libinput_print_options {
 	bool show_keycodes;
 };
 
+/**
+ * Format the event like snprintf() into the caller-supplied buffer, without
+ * allocating memory. The return value is the length of the full string,
+ * if it is size or more, the output was truncated.
+ */
+size_t
+libinput_event_format(struct libinput_event *ev,
+		      size_t event_repeat_count,
+		      const struct libinput_print_options *opts,
+		      char *buf,
+		      size_t size);
+
+/**
+ * Like libinput_event_format() but formats into a newly allocated string
+ * if the event does not fit into buf. The return value is either buf or
+ * that string, the latter is also stored in alloc and must be freed by
+ * the caller.
+ */
+const char *
+libinput_event_format_fallback(struct libinput_event *ev,
+			       size_t event_repeat_count,
+			       const struct libinput_print_options *opts,
+			       char *buf,
+			       size_t size,
+			       char **alloc);
+
+/**
+ * Print the event to fp, without allocating memory. No newline is
+ * appended. Returns the number of bytes written.
+ */
+size_t
+libinput_event_print(FILE *fp,
+		     struct libinput_event *ev,
+		     size_t event_repeat_count,
+		     const struct libinput_print_options *opts);
+
+/**
+ * Like libinput_event_format() but returns a newly allocated string.
+ */
 char *
 libinput_event_to_str(struct libinput_event *ev,
 		      size_t event_repeat_count,
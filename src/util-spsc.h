@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * A bounded lock-free single-producer/single-consumer queue of pointers.
+ *
+ * Exactly one thread may call spsc_queue_push() and exactly one (other)
+ * thread may call spsc_queue_pop() and spsc_queue_peek(). The capacity
+ * must be a power of two.
+ */
+struct spsc_queue {
+	void **slots;
+	size_t mask;
+	/* Only written by the consumer */
+	size_t head __attribute__((aligned(64)));
+	/* Only written by the producer */
+	size_t tail __attribute__((aligned(64)));
+};
+
+static inline bool
+spsc_queue_init(struct spsc_queue *queue, size_t capacity)
+{
+	if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+		return false;
+
+	queue->slots = calloc(capacity, sizeof(*queue->slots));
+	if (!queue->slots)
+		return false;
+
+	queue->mask = capacity - 1;
+	queue->head = 0;
+	queue->tail = 0;
+
+	return true;
+}
+
+static inline void
+spsc_queue_fini(struct spsc_queue *queue)
+{
+	free(queue->slots);
+	queue->slots = NULL;
+}
+
+/**
+ * Producer only. Returns false if the queue is full.
+ */
+static inline bool
+spsc_queue_push(struct spsc_queue *queue, void *data)
+{
+	size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+	size_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+	if (tail - head > queue->mask)
+		return false;
+
+	queue->slots[tail & queue->mask] = data;
+	__atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+/**
+ * Consumer only. Returns the oldest element without removing it or NULL if
+ * the queue is empty.
+ */
+static inline void *
+spsc_queue_peek(struct spsc_queue *queue)
+{
+	size_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+	size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+	if (head == tail)
+		return NULL;
+
+	return queue->slots[head & queue->mask];
+}
+
+/**
+ * Consumer only. Removes and returns the oldest element or NULL if the
+ * queue is empty.
+ */
+static inline void *
+spsc_queue_pop(struct spsc_queue *queue)
+{
+	size_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+	size_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+	if (head == tail)
+		return NULL;
+
+	void *data = queue->slots[head & queue->mask];
+	__atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+
+	return data;
+}
@@ -131,6 +131,22 @@ now_in_us(uint64_t *us)
 	return 0;
 }
 
+/* CPU time used by the calling thread, unlike now_in_us() this does
+ * not advance while the thread is preempted or blocked */
+static inline int
+thread_cpu_time_in_us(uint64_t *us)
+{
+	struct timespec ts = { 0, 0 };
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		*us = 0;
+		return -errno;
+	}
+
+	*us = tp2us(&ts);
+	return 0;
+}
+
 struct human_time {
 	unsigned int value;
 	const char *unit;
@@ -0,0 +1,305 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Benchmark comparing the default libevdev read path with bulk reads
+ * (libinput_set_bulk_read_enabled()). We replay a synthetic 1000Hz mouse
+ * and a 10-finger touchscreen through uinput and measure the CPU cost
+ * per evdev event of libinput_dispatch() and draining the event queue.
+ *
+ * This needs uinput and thus must be run as root, it exits with the meson
+ * skip code otherwise.
+ */
+
+#include <config.h>
+
+#include <libevdev/libevdev-uinput.h>
+#include <libevdev/libevdev.h>
+#include <libinput.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#include "benchmark-helpers.h"
+#include "util-macros.h"
+
+#define NFRAMES 20000
+#define NSLOTS 10
+
+struct device_type {
+	const char *name;
+	struct libevdev_uinput *(*create)(void);
+	/* Write one frame, returns the number of events written */
+	size_t (*write_frame)(struct libevdev_uinput *uinput, size_t seq);
+	/* Frames written before we dispatch, must stay below the kernel's
+	 * per-client buffer size */
+	size_t frames_per_round;
+	enum libinput_event_type frame_event;
+};
+
+struct result {
+	uint64_t cpu_ns;
+	uint64_t cycles;
+	size_t nevents;
+};
+
+static inline uint64_t
+cycles(void)
+{
+#ifdef HAVE_RDTSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+/* A 1000Hz mouse sends one small motion per frame */
+static size_t
+write_mouse_frame(struct libevdev_uinput *uinput, size_t seq)
+{
+	int dx = (seq % 4) < 2 ? 2 : -2;
+	int dy = (seq % 4) == 1 ? 1 : -1;
+
+	libevdev_uinput_write_event(uinput, EV_REL, REL_X, dx);
+	libevdev_uinput_write_event(uinput, EV_REL, REL_Y, dy);
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+
+	return 3;
+}
+
+static struct libevdev_uinput *
+create_touchscreen(void)
+{
+	struct libevdev_uinput *uinput = NULL;
+	struct libevdev *evdev = libevdev_new();
+	struct input_absinfo abs = {
+		.minimum = 0,
+		.maximum = 4095,
+		.resolution = 10,
+	};
+	struct input_absinfo slots = {
+		.minimum = 0,
+		.maximum = NSLOTS - 1,
+	};
+	struct input_absinfo ids = {
+		.minimum = 0,
+		.maximum = 65535,
+	};
+
+	libevdev_set_name(evdev, "benchmark touchscreen");
+	libevdev_enable_property(evdev, INPUT_PROP_DIRECT);
+	libevdev_enable_event_code(evdev, EV_KEY, BTN_TOUCH, NULL);
+	libevdev_enable_event_code(evdev, EV_ABS, ABS_X, &abs);
+	libevdev_enable_event_code(evdev, EV_ABS, ABS_Y, &abs);
+	libevdev_enable_event_code(evdev, EV_ABS, ABS_MT_SLOT, &slots);
+	libevdev_enable_event_code(evdev, EV_ABS, ABS_MT_POSITION_X, &abs);
+	libevdev_enable_event_code(evdev, EV_ABS, ABS_MT_POSITION_Y, &abs);
+	libevdev_enable_event_code(evdev, EV_ABS, ABS_MT_TRACKING_ID, &ids);
+
+	int rc = libevdev_uinput_create_from_device(evdev,
+						    LIBEVDEV_UINPUT_OPEN_MANAGED,
+						    &uinput);
+	libevdev_free(evdev);
+
+	return rc == 0 ? uinput : NULL;
+}
+
+/* All NSLOTS fingers down and moving in each frame. The first frame puts
+ * the fingers down, the kernel filters unchanged values so we move every
+ * finger by at least one unit per frame. */
+static size_t
+write_touchscreen_frame(struct libevdev_uinput *uinput, size_t seq)
+{
+	size_t nevents = 0;
+	int offset = 100 + seq % 1000;
+
+	for (int slot = 0; slot < NSLOTS; slot++) {
+		int x = 200 + slot * 300 + offset;
+		int y = 200 + slot * 100 + offset;
+
+		libevdev_uinput_write_event(uinput, EV_ABS, ABS_MT_SLOT, slot);
+		if (seq == 0) {
+			libevdev_uinput_write_event(uinput,
+						    EV_ABS,
+						    ABS_MT_TRACKING_ID,
+						    slot);
+			nevents++;
+		}
+		libevdev_uinput_write_event(uinput, EV_ABS, ABS_MT_POSITION_X, x);
+		libevdev_uinput_write_event(uinput, EV_ABS, ABS_MT_POSITION_Y, y);
+		nevents += 3;
+
+		if (slot == 0) {
+			libevdev_uinput_write_event(uinput, EV_ABS, ABS_X, x);
+			libevdev_uinput_write_event(uinput, EV_ABS, ABS_Y, y);
+			nevents += 2;
+		}
+	}
+	if (seq == 0) {
+		libevdev_uinput_write_event(uinput, EV_KEY, BTN_TOUCH, 1);
+		nevents++;
+	}
+	libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+
+	return nevents + 1;
+}
+
+static const struct device_type device_types[] = {
+	{
+		.name = "mouse",
+		.create = benchmark_create_mouse,
+		.write_frame = write_mouse_frame,
+		.frames_per_round = 16,
+		.frame_event = LIBINPUT_EVENT_POINTER_MOTION,
+	},
+	{
+		.name = "touchscreen",
+		.create = create_touchscreen,
+		.write_frame = write_touchscreen_frame,
+		.frames_per_round = 4,
+		.frame_event = LIBINPUT_EVENT_TOUCH_FRAME,
+	},
+};
+
+/* Process events until we have seen the expected number of frames */
+static bool
+drain(struct libinput *li,
+      enum libinput_event_type frame_event,
+      size_t expected,
+      struct result *result)
+{
+	struct pollfd fds = { .fd = libinput_get_fd(li), .events = POLLIN };
+	struct libinput_event *event;
+	size_t count = 0;
+
+	while (count < expected) {
+		if (poll(&fds, 1, 1000) <= 0) {
+			fprintf(stderr, "Timeout waiting for events\n");
+			return false;
+		}
+
+		uint64_t cpu = benchmark_cpu_time_in_ns();
+		uint64_t tsc = cycles();
+
+		libinput_dispatch(li);
+		while ((event = libinput_get_event(li))) {
+			if (libinput_event_get_type(event) == frame_event)
+				count++;
+			libinput_event_destroy(event);
+		}
+
+		result->cycles += cycles() - tsc;
+		result->cpu_ns += benchmark_cpu_time_in_ns() - cpu;
+	}
+
+	return true;
+}
+
+static bool
+run(const struct device_type *type,
+    struct libevdev_uinput *uinput,
+    bool bulk_read,
+    struct result *result)
+{
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+	struct libinput_event *event;
+	bool success = false;
+
+	memset(result, 0, sizeof(*result));
+
+	libinput_set_bulk_read_enabled(li, bulk_read);
+	if (!libinput_path_add_device(li, libevdev_uinput_get_devnode(uinput)))
+		goto out;
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li)))
+		libinput_event_destroy(event);
+
+	for (size_t seq = 0; seq < NFRAMES;) {
+		for (size_t f = 0; f < type->frames_per_round; f++)
+			result->nevents += type->write_frame(uinput, seq++);
+
+		if (!drain(li, type->frame_event, type->frames_per_round, result))
+			goto out;
+	}
+
+	success = true;
+out:
+	libinput_unref(li);
+
+	return success;
+}
+
+static void
+print_result(const char *name, const char *path, const struct result *result)
+{
+	printf("%-12s %-9s %zu events: %.1fns CPU",
+	       name,
+	       path,
+	       result->nevents,
+	       (double)result->cpu_ns / result->nevents);
+#ifdef HAVE_RDTSC
+	printf(", %.0f cycles", (double)result->cycles / result->nevents);
+#endif
+	printf(" per event\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	for (size_t i = 0; i < ARRAY_LENGTH(device_types); i++) {
+		const struct device_type *type = &device_types[i];
+		struct result libevdev_result, bulk_result;
+
+		/* A new device for each run so the touchscreen starts with
+		 * all fingers up */
+		struct libevdev_uinput *uinput = type->create();
+		if (!uinput) {
+			fprintf(stderr, "Failed to create uinput device, skipping\n");
+			return 77;
+		}
+		bool success = run(type, uinput, false, &libevdev_result);
+		libevdev_uinput_destroy(uinput);
+
+		uinput = type->create();
+		if (success && uinput)
+			success = run(type, uinput, true, &bulk_result);
+		if (uinput)
+			libevdev_uinput_destroy(uinput);
+
+		if (!success) {
+			fprintf(stderr, "Failed to add %s, skipping\n", type->name);
+			return 77;
+		}
+
+		print_result(type->name, "libevdev", &libevdev_result);
+		print_result(type->name, "bulk", &bulk_result);
+	}
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Microbenchmark comparing draining the event queue one event at a time
+ * with libinput_get_event() against libinput_get_events().
+ *
+ * This needs a uinput device and thus must be run as root, it exits with
+ * the meson skip code otherwise.
+ */
+
+#include <config.h>
+
+#include <libevdev/libevdev-uinput.h>
+#include <libinput.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "benchmark-helpers.h"
+#include "util-macros.h"
+
+#define NEVENTS 4096
+#define NRUNS 50
+#define BATCH_SIZE 64
+
+/* Queue up NEVENTS motion events without removing any from the queue */
+static void
+fill_queue(struct libinput *li, struct libevdev_uinput *uinput)
+{
+	size_t queued = 0;
+
+	while (queued < NEVENTS) {
+		/* Stay well below the kernel's per-client buffer size */
+		const size_t nframes = 16;
+
+		for (size_t i = 0; i < nframes; i++) {
+			libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1);
+			libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+		}
+		libinput_dispatch(li);
+		queued += nframes;
+	}
+}
+
+static uint64_t
+drain_single(struct libinput *li, size_t *count)
+{
+	struct libinput_event *event;
+	uint64_t start = benchmark_now_in_ns();
+
+	while ((event = libinput_get_event(li))) {
+		libinput_event_destroy(event);
+		(*count)++;
+	}
+
+	return benchmark_now_in_ns() - start;
+}
+
+static uint64_t
+drain_batch(struct libinput *li, size_t *count)
+{
+	struct libinput_event *events[BATCH_SIZE];
+	size_t n;
+	uint64_t start = benchmark_now_in_ns();
+
+	while ((n = libinput_get_events(li, events, ARRAY_LENGTH(events)))) {
+		libinput_events_destroy(events, n);
+		*count += n;
+	}
+
+	return benchmark_now_in_ns() - start;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev_uinput *uinput = benchmark_create_mouse();
+	if (!uinput) {
+		fprintf(stderr, "Failed to create uinput device, skipping\n");
+		return 77;
+	}
+
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+	if (!libinput_path_add_device(li, libevdev_uinput_get_devnode(uinput))) {
+		fprintf(stderr, "Failed to add device, skipping\n");
+		libinput_unref(li);
+		libevdev_uinput_destroy(uinput);
+		return 77;
+	}
+
+	/* Warm up the queue and the event pool */
+	fill_queue(li, uinput);
+	drain_single(li, &(size_t){ 0 });
+
+	uint64_t single_ns = 0, batch_ns = 0;
+	size_t single_count = 0, batch_count = 0;
+
+	for (int run = 0; run < NRUNS; run++) {
+		fill_queue(li, uinput);
+		single_ns += drain_single(li, &single_count);
+		fill_queue(li, uinput);
+		batch_ns += drain_batch(li, &batch_count);
+	}
+
+	printf("libinput_get_event():  %zu events, %.1fns/event\n",
+	       single_count,
+	       (double)single_ns / single_count);
+	printf("libinput_get_events(): %zu events, %.1fns/event (batch size %d)\n",
+	       batch_count,
+	       (double)batch_ns / batch_count,
+	       BATCH_SIZE);
+
+	libinput_unref(li);
+	libevdev_uinput_destroy(uinput);
+
+	return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <libevdev/libevdev-uinput.h>
+#include <libinput.h>
+#include <stdint.h>
+
+/* Fixture shared by the microbenchmarks */
+
+/* Opens devices directly, the benchmarks run as root */
+extern const struct libinput_interface benchmark_interface;
+
+/* CLOCK_MONOTONIC in ns */
+uint64_t
+benchmark_now_in_ns(void);
+
+/* CPU time of the calling thread in ns */
+uint64_t
+benchmark_cpu_time_in_ns(void);
+
+/* A uinput mouse with REL_X/Y and left/right buttons, or NULL if uinput
+ * is not available */
+struct libevdev_uinput *
+benchmark_create_mouse(void);
@@ -0,0 +1,213 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Benchmark comparing the default epoll read path with the io_uring
+ * backend. NDEVICES uinput mice send NEVENTS motion events in total,
+ * we measure the CPU time spent in libinput and the number of read
+ * syscalls (from /proc/self/io) and io_uring submissions needed to
+ * process them.
+ *
+ * This needs uinput and thus must be run as root, it exits with the meson
+ * skip code otherwise or if io_uring is not available.
+ */
+
+#include <config.h>
+
+#include <libevdev/libevdev-uinput.h>
+#include <libinput.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "benchmark-helpers.h"
+#include "util-macros.h"
+
+#define NDEVICES 20
+#define NEVENTS 10000
+#define FRAMES_PER_ROUND 16
+
+/* Number of read-like syscalls so far, or 0 if unavailable */
+static uint64_t
+read_syscalls(void)
+{
+	FILE *fp = fopen("/proc/self/io", "r");
+	char line[128];
+	unsigned long long syscr = 0;
+
+	if (!fp)
+		return 0;
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (sscanf(line, "syscr: %llu", &syscr) == 1)
+			break;
+	}
+	fclose(fp);
+
+	return syscr;
+}
+
+struct result {
+	uint64_t cpu_ns;
+	uint64_t syscr;
+	uint64_t submissions;
+	size_t nevents;
+};
+
+/* Process events until we have seen expected motion events */
+static void
+drain(struct libinput *li, size_t expected, struct result *result)
+{
+	struct pollfd fds = { .fd = libinput_get_fd(li), .events = POLLIN };
+	struct libinput_event *event;
+	size_t count = 0;
+
+	while (count < expected) {
+		if (poll(&fds, 1, 1000) <= 0) {
+			fprintf(stderr, "Timeout waiting for events\n");
+			break;
+		}
+
+		uint64_t cpu = benchmark_cpu_time_in_ns();
+		uint64_t syscr = read_syscalls();
+
+		libinput_dispatch(li);
+		while ((event = libinput_get_event(li))) {
+			if (libinput_event_get_type(event) ==
+			    LIBINPUT_EVENT_POINTER_MOTION)
+				count++;
+			libinput_event_destroy(event);
+		}
+
+		/* Reading /proc/self/io is itself one read */
+		result->syscr += read_syscalls() - syscr - 1;
+		result->cpu_ns += benchmark_cpu_time_in_ns() - cpu;
+	}
+
+	result->nevents += count;
+}
+
+static bool
+run(struct libevdev_uinput **uinputs, bool io_uring, struct result *result)
+{
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+
+	if (io_uring && libinput_set_io_uring_enabled(li, 1) < 0) {
+		libinput_unref(li);
+		return false;
+	}
+
+	for (size_t i = 0; i < NDEVICES; i++) {
+		const char *devnode = libevdev_uinput_get_devnode(uinputs[i]);
+		if (!libinput_path_add_device(li, devnode)) {
+			libinput_unref(li);
+			return false;
+		}
+	}
+
+	struct libinput_event *event;
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li)))
+		libinput_event_destroy(event);
+
+	memset(result, 0, sizeof(*result));
+	result->submissions =
+		libinput_get_stat(li, LIBINPUT_STAT_IO_URING_SUBMISSIONS);
+
+	size_t sent = 0;
+	while (sent < NEVENTS) {
+		for (size_t i = 0; i < NDEVICES; i++) {
+			for (size_t f = 0; f < FRAMES_PER_ROUND; f++) {
+				libevdev_uinput_write_event(uinputs[i], EV_REL, REL_X, 1);
+				libevdev_uinput_write_event(uinputs[i],
+							    EV_SYN,
+							    SYN_REPORT,
+							    0);
+			}
+		}
+		drain(li, NDEVICES * FRAMES_PER_ROUND, result);
+		sent += NDEVICES * FRAMES_PER_ROUND;
+	}
+
+	result->submissions =
+		libinput_get_stat(li, LIBINPUT_STAT_IO_URING_SUBMISSIONS) -
+		result->submissions;
+
+	libinput_unref(li);
+
+	return true;
+}
+
+static void
+print_result(const char *name, const struct result *result)
+{
+	double scale = 10000.0 / result->nevents;
+
+	printf("%-8s %zu events: per 10k events %.2fms CPU, %.0f read syscalls, "
+	       "%.0f io_uring submissions\n",
+	       name,
+	       result->nevents,
+	       result->cpu_ns * scale / 1000000.0,
+	       result->syscr * scale,
+	       result->submissions * scale);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev_uinput *uinputs[NDEVICES] = { NULL };
+	struct result epoll_result, uring_result;
+	int rc = 77;
+
+	for (size_t i = 0; i < NDEVICES; i++) {
+		uinputs[i] = benchmark_create_mouse();
+		if (!uinputs[i]) {
+			fprintf(stderr, "Failed to create uinput device, skipping\n");
+			goto out;
+		}
+	}
+
+	if (!run(uinputs, false, &epoll_result)) {
+		fprintf(stderr, "Failed to add devices, skipping\n");
+		goto out;
+	}
+
+	if (!run(uinputs, true, &uring_result)) {
+		fprintf(stderr, "io_uring not available, skipping\n");
+		goto out;
+	}
+
+	print_result("epoll", &epoll_result);
+	print_result("io_uring", &uring_result);
+	rc = 0;
+
+out:
+	for (size_t i = 0; i < NDEVICES; i++) {
+		if (uinputs[i])
+			libevdev_uinput_destroy(uinputs[i]);
+	}
+
+	return rc;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Benchmark comparing the table-based "evdev-frame" Lua protocol with the
+ * "evdev-frame-view" userdata. Both plugins triple the relative motion of
+ * a uinput mouse, we count the allocations made by the plugin's Lua state
+ * (i.e. the garbage the GC has to collect later) and the CPU time per frame.
+ *
+ * This needs uinput and thus must be run as root, it exits with the meson
+ * skip code otherwise.
+ */
+
+#include <config.h>
+
+#include <libevdev/libevdev-uinput.h>
+#include <libinput.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "benchmark-helpers.h"
+#include "util-macros.h"
+#include "util-mem.h"
+#include "util-strings.h"
+
+#include "libinput-plugin-lua.h"
+
+#define NFRAMES 20000
+
+static const char *table_plugin =
+	"libinput:register({1})\n"
+	"libinput:connect(\"new-evdev-device\", function(device)\n"
+	"    device:connect(\"evdev-frame\", function(device, frame, timestamp)\n"
+	"        for _, v in ipairs(frame) do\n"
+	"            if v.usage == evdev.REL_X or v.usage == evdev.REL_Y then\n"
+	"                v.value = v.value * 3\n"
+	"            end\n"
+	"        end\n"
+	"        return frame\n"
+	"    end)\n"
+	"end)\n";
+
+static const char *view_plugin =
+	"libinput:register({1})\n"
+	"libinput:connect(\"new-evdev-device\", function(device)\n"
+	"    device:connect(\"evdev-frame-view\", function(device, frame, timestamp)\n"
+	"        for i = 1, #frame do\n"
+	"            local usage = frame:usage(i)\n"
+	"            if usage == evdev.REL_X or usage == evdev.REL_Y then\n"
+	"                frame:set_value(i, frame:value(i) * 3)\n"
+	"            end\n"
+	"        end\n"
+	"    end)\n"
+	"end)\n";
+
+static void
+drain(struct libinput *li)
+{
+	struct libinput_event *event;
+
+	libinput_dispatch(li);
+	while ((event = libinput_get_event(li)))
+		libinput_event_destroy(event);
+}
+
+static bool
+run(struct libevdev_uinput *uinput, const char *name, const char *lua)
+{
+	char dir[] = "/tmp/libinput-benchmark-XXXXXX";
+	if (!mkdtemp(dir))
+		return false;
+
+	_autofree_ char *path = strdup_printf("%s/10-benchmark.lua", dir);
+	FILE *fp = fopen(path, "w");
+	if (!fp) {
+		rmdir(dir);
+		return false;
+	}
+	fputs(lua, fp);
+	fclose(fp);
+
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+	struct libinput_plugin *plugin =
+		libinput_lua_plugin_new_from_path(li, path, NULL);
+	libinput_plugin_system_load_plugins(li, LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+
+	unlink(path);
+	rmdir(dir);
+
+	if (!plugin ||
+	    !libinput_path_add_device(li, libevdev_uinput_get_devnode(uinput))) {
+		libinput_unref(li);
+		return false;
+	}
+	drain(li);
+
+	size_t allocs = libinput_lua_plugin_get_allocations(plugin);
+	uint64_t start = benchmark_cpu_time_in_ns();
+
+	for (int i = 0; i < NFRAMES; i++) {
+		libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1);
+		libevdev_uinput_write_event(uinput, EV_REL, REL_Y, -1);
+		libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+		/* Stay well below the kernel's per-client buffer size */
+		if (i % 16 == 15)
+			drain(li);
+	}
+	drain(li);
+
+	uint64_t ns = benchmark_cpu_time_in_ns() - start;
+	allocs = libinput_lua_plugin_get_allocations(plugin) - allocs;
+
+	printf("%-18s %6.2f allocations/frame, %.1fns/frame\n",
+	       name,
+	       (double)allocs / NFRAMES,
+	       (double)ns / NFRAMES);
+
+	libinput_unref(li);
+
+	return true;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev_uinput *uinput = benchmark_create_mouse();
+	if (!uinput) {
+		fprintf(stderr, "Failed to create uinput device, skipping\n");
+		return 77;
+	}
+
+	int rc = 0;
+	if (!run(uinput, "evdev-frame", table_plugin) ||
+	    !run(uinput, "evdev-frame-view", view_plugin)) {
+		fprintf(stderr, "Failed to set up libinput, skipping\n");
+		rc = 77;
+	}
+
+	libevdev_uinput_destroy(uinput);
+
+	return rc;
+}
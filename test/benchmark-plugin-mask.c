@@ -0,0 +1,230 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Microbenchmark for matching evdev frames against the usage masks of the
+ * internal plugins. Compares looking up every event of the frame in the
+ * mask with the frame's precomputed usage bitmap.
+ *
+ * The masks below mirror what the internal plugins pass to
+ * libinput_plugin_enable_evdev_usage(), plugins without a mask see every
+ * frame and are not included.
+ */
+
+#include <config.h>
+
+#include <stdio.h>
+
+#include "benchmark-helpers.h"
+#include "evdev-frame.h"
+#include "util-macros.h"
+
+#define NITERATIONS 200000
+
+static struct evdev_mask *
+debounce_mask(void)
+{
+	struct evdev_mask *mask = evdev_mask_new();
+
+	for (unsigned int code = BTN_0; code <= KEY_OK; code++) {
+		evdev_usage_t usage = evdev_usage_from_code(EV_KEY, code);
+		if (evdev_usage_is_button(usage))
+			evdev_mask_set_usage(mask, usage);
+	}
+
+	return mask;
+}
+
+static struct evdev_mask *
+wheel_mask(void)
+{
+	struct evdev_mask *mask = evdev_mask_new();
+
+	evdev_mask_set_enum(mask, EVDEV_REL_WHEEL);
+	evdev_mask_set_enum(mask, EVDEV_REL_WHEEL_HI_RES);
+	evdev_mask_set_enum(mask, EVDEV_REL_HWHEEL);
+	evdev_mask_set_enum(mask, EVDEV_REL_HWHEEL_HI_RES);
+
+	return mask;
+}
+
+static struct evdev_mask *
+double_tool_mask(void)
+{
+	struct evdev_mask *mask = evdev_mask_new();
+
+	evdev_mask_set_enum(mask, EVDEV_BTN_TOOL_PEN);
+	evdev_mask_set_enum(mask, EVDEV_BTN_TOOL_RUBBER);
+
+	return mask;
+}
+
+static struct evdev_mask *
+eraser_button_mask(void)
+{
+	struct evdev_mask *mask = evdev_mask_new();
+
+	evdev_mask_set_enum(mask, EVDEV_BTN_TOOL_PEN);
+	evdev_mask_set_enum(mask, EVDEV_BTN_TOOL_RUBBER);
+	evdev_mask_set_enum(mask, EVDEV_BTN_TOUCH);
+	evdev_mask_set_enum(mask, EVDEV_BTN_STYLUS);
+	evdev_mask_set_enum(mask, EVDEV_BTN_STYLUS2);
+	evdev_mask_set_enum(mask, EVDEV_BTN_STYLUS3);
+
+	return mask;
+}
+
+static struct evdev_frame *
+mouse_frame(void)
+{
+	struct evdev_frame *frame = evdev_frame_new(64);
+
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_REL_X), 1);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_REL_Y), -1);
+
+	return frame;
+}
+
+static struct evdev_frame *
+touchpad_frame(void)
+{
+	struct evdev_frame *frame = evdev_frame_new(64);
+
+	for (int slot = 0; slot < 10; slot++) {
+		evdev_frame_append_one(frame,
+				       evdev_usage_from(EVDEV_ABS_MT_SLOT),
+				       slot);
+		evdev_frame_append_one(frame,
+				       evdev_usage_from(EVDEV_ABS_MT_POSITION_X),
+				       100 + slot);
+		evdev_frame_append_one(frame,
+				       evdev_usage_from(EVDEV_ABS_MT_POSITION_Y),
+				       200 + slot);
+		evdev_frame_append_one(frame,
+				       evdev_usage_from(EVDEV_ABS_MT_PRESSURE),
+				       30);
+	}
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_X), 100);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_Y), 200);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_PRESSURE), 30);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_MSC_TIMESTAMP), 1000);
+
+	return frame;
+}
+
+static struct evdev_frame *
+tablet_frame(void)
+{
+	struct evdev_frame *frame = evdev_frame_new(64);
+
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_X), 1000);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_Y), 2000);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_PRESSURE), 300);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_TILT_X), 10);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_TILT_Y), -10);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_BTN_TOUCH), 1);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_MSC_SERIAL), 1234);
+
+	return frame;
+}
+
+/* What plugin_has_mask() did before frames had a usage bitmap */
+static bool
+mask_matches_per_event(struct evdev_mask *mask, struct evdev_frame *frame)
+{
+	size_t nevents;
+	struct evdev_event *events = evdev_frame_get_events(frame, &nevents);
+
+	for (size_t i = 0; i < nevents - 1; i++) {
+		if (evdev_mask_is_set(mask, events[i].usage))
+			return true;
+	}
+
+	return false;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct {
+		const char *name;
+		struct evdev_frame *frame;
+	} frames[] = {
+		{ "mouse", mouse_frame() },
+		{ "touchpad", touchpad_frame() },
+		{ "tablet", tablet_frame() },
+	};
+	struct evdev_mask *masks[] = {
+		debounce_mask(),
+		wheel_mask(), /* mouse-wheel */
+		wheel_mask(), /* mouse-wheel-lowres */
+		double_tool_mask(),
+		eraser_button_mask(),
+	};
+	int rc = 0;
+
+	for (size_t f = 0; f < ARRAY_LENGTH(frames); f++) {
+		struct evdev_frame *frame = frames[f].frame;
+		size_t nmatch_event = 0, nmatch_bitmap = 0;
+		uint64_t start;
+
+		start = benchmark_now_in_ns();
+		for (int i = 0; i < NITERATIONS; i++) {
+			for (size_t m = 0; m < ARRAY_LENGTH(masks); m++)
+				nmatch_event += mask_matches_per_event(masks[m], frame);
+		}
+		uint64_t per_event_ns = benchmark_now_in_ns() - start;
+
+		start = benchmark_now_in_ns();
+		for (int i = 0; i < NITERATIONS; i++) {
+			for (size_t m = 0; m < ARRAY_LENGTH(masks); m++)
+				nmatch_bitmap +=
+					evdev_mask_matches_frame(masks[m], frame);
+		}
+		uint64_t bitmap_ns = benchmark_now_in_ns() - start;
+
+		if (nmatch_event != nmatch_bitmap) {
+			fprintf(stderr,
+				"%s: mismatch, %zu vs %zu matches\n",
+				frames[f].name,
+				nmatch_event,
+				nmatch_bitmap);
+			rc = 1;
+		}
+
+		printf("%-9s %2zu events: per-event %.1fns, bitmap %.1fns "
+		       "per frame for %zu plugins\n",
+		       frames[f].name,
+		       evdev_frame_get_count(frame),
+		       (double)per_event_ns / NITERATIONS,
+		       (double)bitmap_ns / NITERATIONS,
+		       ARRAY_LENGTH(masks));
+	}
+
+	for (size_t f = 0; f < ARRAY_LENGTH(frames); f++)
+		evdev_frame_unref(frames[f].frame);
+	for (size_t m = 0; m < ARRAY_LENGTH(masks); m++)
+		evdev_mask_destroy(masks[m]);
+
+	return rc;
+}
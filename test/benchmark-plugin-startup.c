@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Benchmark for the time it takes to load the plugins in the given
+ * directory (the source tree's plugins/ directory when run by meson),
+ * with and without a cache directory for the compiled plugins. The first
+ * run with the cache directory compiles the plugins and fills the cache,
+ * it is not part of the result.
+ */
+
+#include <config.h>
+
+#include <libinput.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark-helpers.h"
+#include "util-files.h"
+
+#define NRUNS 200
+
+static void
+log_handler(struct libinput *li,
+	    enum libinput_log_priority priority,
+	    const char *format,
+	    va_list args)
+{
+	/* The example plugins don't register and complain about it */
+}
+
+static uint64_t
+load_plugins(const char *plugindir, const char *cachedir)
+{
+	uint64_t start = benchmark_now_in_ns();
+
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+	libinput_log_set_handler(li, log_handler);
+	libinput_plugin_system_append_path(li, plugindir);
+	libinput_plugin_system_set_cache_directory(li, cachedir);
+	libinput_plugin_system_load_plugins(li, LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+	libinput_unref(li);
+
+	return benchmark_now_in_ns() - start;
+}
+
+int
+main(int argc, char **argv)
+{
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s /path/to/plugins\n", argv[0]);
+		return 1;
+	}
+
+	const char *plugindir = argv[1];
+	_destroy_(tmpdir) *cachedir = tmpdir_create(NULL);
+	if (!cachedir) {
+		fprintf(stderr, "Failed to create cache directory, skipping\n");
+		return 77;
+	}
+
+	uint64_t uncached_ns = 0, cached_ns = 0;
+
+	load_plugins(plugindir, cachedir->path); /* fill the cache */
+
+	for (int i = 0; i < NRUNS; i++) {
+		uncached_ns += load_plugins(plugindir, NULL);
+		cached_ns += load_plugins(plugindir, cachedir->path);
+	}
+
+	printf("context with plugins from %s:\n", plugindir);
+	printf("  without cache: %.1fus\n", uncached_ns / 1000.0 / NRUNS);
+	printf("  with cache:    %.1fus\n", cached_ns / 1000.0 / NRUNS);
+
+	return 0;
+}
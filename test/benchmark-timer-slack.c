@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Benchmark for timer slack: arms a group of timers that expire within a
+ * few milliseconds of each other, similar to tap, debounce and palm timers
+ * on a laptop, and counts the timerfd wakeups needed to fire all of them
+ * with and without slack.
+ *
+ * This links against the library objects directly since the timer API is
+ * not public.
+ */
+
+#include <config.h>
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark-helpers.h"
+#include "libinput-private.h"
+#include "timer.h"
+
+#define NTIMERS 8
+#define NROUNDS 50
+
+static size_t nfired;
+
+static void
+timer_func(uint64_t now, void *data)
+{
+	nfired++;
+}
+
+static uint64_t
+run(struct libinput *li, struct libinput_timer *timers, uint64_t slack)
+{
+	uint64_t wakeups = libinput_get_stat(li, LIBINPUT_STAT_TIMER_WAKEUPS);
+	struct pollfd fds = {
+		.fd = libinput_get_fd(li),
+		.events = POLLIN,
+	};
+
+	for (size_t i = 0; i < NTIMERS; i++)
+		libinput_timer_set_slack(&timers[i], slack);
+
+	for (int round = 0; round < NROUNDS; round++) {
+		uint64_t now = libinput_now(li);
+
+		nfired = 0;
+		/* Spread the expiries over 2ms */
+		for (size_t i = 0; i < NTIMERS; i++)
+			libinput_timer_set(&timers[i],
+					   now + ms2us(2) + i * ms2us(2) / NTIMERS);
+
+		while (nfired < NTIMERS && poll(&fds, 1, 1000) > 0)
+			libinput_dispatch(li);
+	}
+
+	return libinput_get_stat(li, LIBINPUT_STAT_TIMER_WAKEUPS) - wakeups;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+	struct libinput_timer timers[NTIMERS] = { 0 };
+	int rc = 0;
+
+	for (size_t i = 0; i < NTIMERS; i++) {
+		char name[32];
+
+		snprintf(name, sizeof(name), "benchmark %zu", i);
+		libinput_timer_init(&timers[i], li, name, timer_func, NULL);
+	}
+
+	uint64_t without_slack = run(li, timers, 0);
+	uint64_t with_slack = run(li, timers, TIMER_SLACK_BACKGROUND);
+
+	printf("%d timers over 2ms, no slack: %.1f wakeups/round\n",
+	       NTIMERS,
+	       (double)without_slack / NROUNDS);
+	printf("%d timers over 2ms, %dms slack: %.1f wakeups/round\n",
+	       NTIMERS,
+	       (int)us2ms(TIMER_SLACK_BACKGROUND),
+	       (double)with_slack / NROUNDS);
+
+	if (with_slack > without_slack)
+		rc = 1;
+
+	for (size_t i = 0; i < NTIMERS; i++) {
+		libinput_timer_cancel(&timers[i]);
+		libinput_timer_destroy(&timers[i]);
+	}
+	libinput_unref(li);
+
+	return rc;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Microbenchmark for the internal timer API with many armed timers.
+ *
+ * Each iteration re-arms a random timer to a random expiry, similar to what
+ * a multi-touch touchpad does for every touch on every frame. This links
+ * against the library objects directly since the timer API is not public.
+ */
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark-helpers.h"
+#include "libinput-private.h"
+#include "timer.h"
+
+#define NTIMERS 512
+#define NITERATIONS 200000
+
+static size_t nfired;
+
+static void
+timer_func(uint64_t now, void *data)
+{
+	nfired++;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+	struct libinput_timer *timers = zalloc(NTIMERS * sizeof(*timers));
+	uint64_t now = libinput_now(li);
+
+	srand(1);
+
+	for (size_t i = 0; i < NTIMERS; i++) {
+		char name[32];
+
+		snprintf(name, sizeof(name), "benchmark %zu", i);
+		libinput_timer_init(&timers[i], li, name, timer_func, NULL);
+	}
+
+	/* Arm all timers, then keep re-arming and cancelling random ones.
+	 * Expiries are far enough in the future that none fire here. */
+	uint64_t start = benchmark_now_in_ns();
+	for (size_t i = 0; i < NTIMERS; i++)
+		libinput_timer_set(&timers[i], now + ms2us(1000 + rand() % 3000));
+	for (size_t i = 0; i < NITERATIONS; i++) {
+		struct libinput_timer *t = &timers[rand() % NTIMERS];
+
+		if (i % 8 == 0)
+			libinput_timer_cancel(t);
+		else
+			libinput_timer_set(t, now + ms2us(1000 + rand() % 3000));
+	}
+	uint64_t arm_ns = benchmark_now_in_ns() - start;
+
+	size_t narmed = 0;
+	for (size_t i = 0; i < NTIMERS; i++) {
+		if (timers[i].expire)
+			narmed++;
+	}
+
+	start = benchmark_now_in_ns();
+	libinput_timer_flush(li, now + s2us(5));
+	uint64_t fire_ns = benchmark_now_in_ns() - start;
+
+	printf("%d timers, set/cancel: %.1fns/op\n",
+	       NTIMERS,
+	       (double)arm_ns / (NTIMERS + NITERATIONS));
+	printf("%d timers, expiry: %zu fired, %.1fns/timer\n",
+	       NTIMERS,
+	       nfired,
+	       (double)fire_ns / max(narmed, 1U));
+
+	for (size_t i = 0; i < NTIMERS; i++)
+		libinput_timer_destroy(&timers[i]);
+	free(timers);
+	libinput_unref(li);
+
+	return nfired == narmed ? 0 : 1;
+}
@@ -3732,8 +3732,9 @@ litest_event_get_type_str(struct libinput_event *event)
 static void
 litest_print_event(struct libinput_event *event, const char *message)
 {
-	_autofree_ char *event_str = libinput_event_to_str(event, 0, NULL);
-	fprintf(stderr, "litest: %s %s\n", message, event_str);
+	fprintf(stderr, "litest: %s ", message);
+	libinput_event_print(stderr, event, 0, NULL);
+	fprintf(stderr, "\n");
 }
 
 void
@@ -4764,11 +4765,16 @@ litest_assert_touch_cancel(struct libinput *li)
 void
 _litest_timeout(struct libinput *li, const char *func, int lineno, int millis)
 {
-	if (li)
-		_litest_dispatch(li, func, lineno);
-	msleep(millis);
-	if (li)
-		_litest_dispatch(li, func, lineno);
+	if (!li) {
+		msleep(millis);
+		return;
+	}
+
+	/* Process any pending events first, then skip ahead in virtual
+	 * time so the timers fire without sleeping */
+	_litest_dispatch(li, func, lineno);
+	libinput_clock_advance(li, ms2us(millis));
+	_litest_dispatch(li, func, lineno);
 }
 
 void
@@ -444,6 +444,8 @@ enum litest_device_type {
 	LITEST_SYNAPTICS_TOPBUTTONPAD,
 	LITEST_SYNAPTICS_TOUCHPAD,
 	LITEST_TOUCHPAD_PALMPRESSURE_ZERO,
+	LITEST_TOUCHPAD_HISTORY_LENGTH,
+	LITEST_TOUCHPAD_HISTORY_LENGTH_SHORT,
 	LITEST_WACOM_INTUOS5_FINGER,
 
 	/* Touchscreens */
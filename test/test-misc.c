@@ -27,11 +27,13 @@
 #include <fcntl.h>
 #include <libinput-util.h>
 #include <libinput.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <unistd.h>
 
 #include "libinput-util.h"
 #include "litest.h"
+#include "util-libinput.h"
 
 static int
 open_restricted(const char *path, int flags, void *data)
@@ -810,6 +812,739 @@ START_TEST(timer_flush)
 }
 END_TEST
 
+START_TEST(event_pool_recycle)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	litest_drain_events(li);
+
+	for (int i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_drain_events(li);
+
+	uint64_t misses = libinput_get_stat(li, LIBINPUT_STAT_EVENT_POOL_MISSES);
+	uint64_t hits = libinput_get_stat(li, LIBINPUT_STAT_EVENT_POOL_HITS);
+	uint64_t high_water_mark =
+		libinput_get_stat(li, LIBINPUT_STAT_EVENT_POOL_HIGH_WATER_MARK);
+
+	litest_assert_int_gt(misses, 0U);
+	litest_assert_int_gt(high_water_mark, 0U);
+
+	/* Same number of events again, all of them must be recycled */
+	for (int i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_drain_events(li);
+
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_EVENT_POOL_MISSES),
+			     misses);
+	litest_assert_int_ge(libinput_get_stat(li, LIBINPUT_STAT_EVENT_POOL_HITS),
+			     hits + 10);
+	litest_assert_int_eq(
+		libinput_get_stat(li, LIBINPUT_STAT_EVENT_POOL_HIGH_WATER_MARK),
+		high_water_mark);
+}
+END_TEST
+
+START_TEST(event_get_events)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *events[8];
+	size_t count;
+
+	litest_drain_events(li);
+
+	count = libinput_get_events(li, events, ARRAY_LENGTH(events));
+	litest_assert_int_eq(count, 0U);
+
+	for (unsigned int key = KEY_1; key <= KEY_5; key++)
+		litest_keyboard_key(dev, key, true);
+	litest_dispatch(li);
+
+	count = libinput_get_events(li, events, 0);
+	litest_assert_int_eq(count, 0U);
+
+	count = libinput_get_events(li, events, 2);
+	litest_assert_int_eq(count, 2U);
+	for (size_t i = 0; i < count; i++)
+		litest_is_keyboard_event(events[i],
+					 KEY_1 + i,
+					 LIBINPUT_KEY_STATE_PRESSED);
+	libinput_events_destroy(events, count);
+
+	/* Refill before the queue is empty so the read position is
+	 * somewhere in the middle of the ring buffer */
+	for (unsigned int key = KEY_1; key <= KEY_5; key++)
+		litest_keyboard_key(dev, key, false);
+	litest_dispatch(li);
+
+	count = libinput_get_events(li, events, ARRAY_LENGTH(events));
+	litest_assert_int_eq(count, 8U);
+	for (size_t i = 0; i < 3; i++)
+		litest_is_keyboard_event(events[i],
+					 KEY_3 + i,
+					 LIBINPUT_KEY_STATE_PRESSED);
+	for (size_t i = 3; i < count; i++)
+		litest_is_keyboard_event(events[i],
+					 KEY_1 + i - 3,
+					 LIBINPUT_KEY_STATE_RELEASED);
+	libinput_events_destroy(events, count);
+
+	litest_assert_empty_queue(li);
+}
+END_TEST
+
+START_TEST(dispatch_budget)
+{
+	_litest_context_destroy_ struct libinput *li = litest_create_context();
+	_destroy_(litest_device) *mouse = litest_add_device(li, LITEST_MOUSE);
+	_destroy_(litest_device) *keyboard = litest_add_device(li, LITEST_KEYBOARD);
+	struct libinput_event *events[16];
+	size_t count;
+	size_t key_index = ARRAY_LENGTH(events);
+
+	litest_drain_events(li);
+
+	litest_assert_int_eq(libinput_get_dispatch_budget(li), 0U);
+	libinput_set_dispatch_budget(li, 2);
+	litest_assert_int_eq(libinput_get_dispatch_budget(li), 2U);
+
+	for (int i = 0; i < 10; i++) {
+		litest_event(mouse, EV_REL, REL_X, 1);
+		litest_event(mouse, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_keyboard_key(keyboard, KEY_A, true);
+	litest_dispatch(li);
+
+	/* All events are processed in one dispatch, but the keyboard
+	 * must not wait for the mouse to be drained */
+	count = libinput_get_events(li, events, ARRAY_LENGTH(events));
+	litest_assert_int_eq(count, 11U);
+	for (size_t i = 0; i < count; i++) {
+		if (libinput_event_get_type(events[i]) == LIBINPUT_EVENT_KEYBOARD_KEY)
+			key_index = i;
+	}
+	libinput_events_destroy(events, count);
+
+	litest_assert_int_le(key_index, 2U);
+	litest_assert_int_gt(libinput_get_stat(li, LIBINPUT_STAT_DISPATCH_BUDGET_HITS),
+			     0U);
+
+	litest_keyboard_key(keyboard, KEY_A, false);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(motion_coalescing)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+
+	litest_drain_events(li);
+
+	/* Disabled by default, one event per frame */
+	litest_assert(!libinput_get_motion_coalescing_enabled(li));
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_dispatch(li);
+
+	for (int i = 0; i < 2; i++) {
+		event = libinput_get_event(li);
+		ptrev = litest_is_motion_event(event);
+		litest_assert_int_eq(libinput_event_pointer_get_coalesced_count(ptrev),
+				     1U);
+		litest_assert_int_eq(libinput_event_pointer_get_first_time_usec(ptrev),
+				     libinput_event_pointer_get_time_usec(ptrev));
+		libinput_event_destroy(event);
+	}
+	litest_assert_empty_queue(li);
+
+	libinput_set_motion_coalescing_enabled(li, 1);
+	litest_assert(libinput_get_motion_coalescing_enabled(li));
+
+	for (int i = 0; i < 5; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_REL, REL_Y, 2);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	for (int i = 0; i < 2; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_dispatch(li);
+
+	/* Motion events are never merged across the button event */
+	event = libinput_get_event(li);
+	ptrev = litest_is_motion_event(event);
+	litest_assert_int_eq(libinput_event_pointer_get_coalesced_count(ptrev), 5U);
+	litest_assert_double_eq(libinput_event_pointer_get_dx_unaccelerated(ptrev),
+				5.0);
+	litest_assert_double_eq(libinput_event_pointer_get_dy_unaccelerated(ptrev),
+				10.0);
+	litest_assert_int_le(libinput_event_pointer_get_first_time_usec(ptrev),
+			     libinput_event_pointer_get_time_usec(ptrev));
+	libinput_event_destroy(event);
+
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_motion_event(event);
+	litest_assert_int_eq(libinput_event_pointer_get_coalesced_count(ptrev), 2U);
+	litest_assert_double_eq(libinput_event_pointer_get_dx_unaccelerated(ptrev),
+				2.0);
+	libinput_event_destroy(event);
+	litest_assert_empty_queue(li);
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(event_queue_limit)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+
+	litest_drain_events(li);
+
+	litest_assert_int_eq(libinput_get_event_queue_limit(li), 0U);
+	libinput_set_event_queue_limit(li, 3);
+	litest_assert_int_eq(libinput_get_event_queue_limit(li), 3U);
+
+	for (int i = 0; i < 5; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_dispatch(li);
+
+	/* Queue is full, the last three motion events are merged */
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_EVENT_QUEUE_DEPTH),
+			     3U);
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_EVENT_QUEUE_DROPPED),
+			     0U);
+
+	/* Anything but motion is dropped */
+	litest_disable_log_handler(li);
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	litest_restore_log_handler(li);
+
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_EVENT_QUEUE_DEPTH),
+			     3U);
+	litest_assert_int_ge(libinput_get_stat(li, LIBINPUT_STAT_EVENT_QUEUE_PEAK_DEPTH),
+			     3U);
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_EVENT_QUEUE_DROPPED),
+			     1U);
+
+	for (int i = 0; i < 2; i++) {
+		event = libinput_get_event(li);
+		ptrev = litest_is_motion_event(event);
+		litest_assert_int_eq(libinput_event_pointer_get_coalesced_count(ptrev),
+				     1U);
+		libinput_event_destroy(event);
+	}
+	event = libinput_get_event(li);
+	ptrev = litest_is_motion_event(event);
+	litest_assert_int_eq(libinput_event_pointer_get_coalesced_count(ptrev), 3U);
+	libinput_event_destroy(event);
+	litest_assert_empty_queue(li);
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_EVENT_QUEUE_DEPTH),
+			     0U);
+
+	libinput_set_event_queue_limit(li, 0);
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+}
+END_TEST
+
+START_TEST(event_queue_limit_tablet_tool_ref)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_tablet_tool *tev;
+	struct libinput_tablet_tool *tool;
+	struct axis_replacement axes[] = {
+		{ ABS_DISTANCE, 10 },
+		{ ABS_PRESSURE, 0 },
+		{ -1, -1 },
+	};
+
+	litest_drain_events(li);
+
+	/* Only the proximity in event fits, all axis events are dropped */
+	libinput_set_event_queue_limit(li, 1);
+	litest_disable_log_handler(li);
+	litest_tablet_proximity_in(dev, 10, 10, axes);
+	for (int i = 0; i < 5; i++)
+		litest_tablet_motion(dev, 10 + i, 10 + i, axes);
+	litest_dispatch(li);
+	litest_restore_log_handler(li);
+
+	litest_assert_int_gt(libinput_get_stat(li, LIBINPUT_STAT_EVENT_QUEUE_DROPPED),
+			     0U);
+
+	event = libinput_get_event(li);
+	tev = litest_is_tablet_event(event, LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY);
+	tool = libinput_tablet_tool_ref(libinput_event_tablet_tool_get_tool(tev));
+	libinput_event_destroy(event);
+	litest_assert_empty_queue(li);
+
+	libinput_set_event_queue_limit(li, 0);
+	litest_tablet_proximity_out(dev);
+	litest_timeout_tablet_proxout(li);
+	litest_drain_events(li);
+
+	/* The tool list and we hold a reference, the dropped events
+	 * must not have left any behind */
+	int refs = 0;
+	while (tool) {
+		tool = libinput_tablet_tool_unref(tool);
+		refs++;
+	}
+	litest_assert_int_eq(refs, 2);
+}
+END_TEST
+
+START_TEST(virtual_clock)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+	struct libinput_event_pointer *ptrev;
+
+	enum libinput_config_status status =
+		libinput_device_config_middle_emulation_set_enabled(
+			dev->libinput_device,
+			LIBINPUT_CONFIG_MIDDLE_EMULATION_ENABLED);
+	litest_assert_enum_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	litest_drain_events(li);
+
+	/* The left button is held back until the middle button timeout */
+	uint64_t start = libinput_clock_now(li);
+	litest_button_click(dev, BTN_LEFT, true);
+	litest_dispatch(li);
+	litest_assert_empty_queue(li);
+
+	/* Timers fire on the next dispatch, no sleep required */
+	libinput_clock_advance(li, s2us(10));
+	litest_dispatch(li);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_button_event(event, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_assert_int_ge(libinput_event_pointer_get_time_usec(ptrev),
+			     start + s2us(10));
+	libinput_event_destroy(event);
+
+	/* Kernel timestamps are moved forward too */
+	litest_button_click(dev, BTN_LEFT, false);
+	litest_dispatch(li);
+
+	event = libinput_get_event(li);
+	ptrev = litest_is_button_event(event, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+	litest_assert_int_ge(libinput_event_pointer_get_time_usec(ptrev),
+			     start + s2us(10));
+	litest_assert_int_le(libinput_event_pointer_get_time_usec(ptrev),
+			     libinput_clock_now(li));
+	libinput_event_destroy(event);
+}
+END_TEST
+
+struct input_thread_call {
+	struct libinput_device *device;
+	enum libinput_config_status status;
+	pthread_t thread;
+};
+
+static void
+input_thread_set_left_handed(struct libinput *li, void *data)
+{
+	struct input_thread_call *call = data;
+
+	call->thread = pthread_self();
+	call->status = libinput_device_config_left_handed_set(call->device, 1);
+}
+
+START_TEST(input_thread)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct input_thread_call call = {
+		.device = dev->libinput_device,
+		.status = LIBINPUT_CONFIG_STATUS_INVALID,
+	};
+	int epoll_fd = libinput_get_fd(li);
+
+	litest_drain_events(li);
+
+	litest_assert_int_eq(libinput_input_thread_start(li), 0);
+	litest_assert_int_eq(libinput_input_thread_start(li), -EALREADY);
+	litest_assert_int_ne(libinput_get_fd(li), epoll_fd);
+
+	for (int i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+
+	for (int i = 0; i < 10; i++) {
+		litest_wait_for_event(li);
+		struct libinput_event *event = libinput_get_event(li);
+		litest_is_motion_event(event);
+		libinput_event_destroy(event);
+	}
+
+	libinput_input_thread_call(li, input_thread_set_left_handed, &call);
+	litest_assert_enum_eq(call.status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	litest_assert(!pthread_equal(call.thread, pthread_self()));
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	litest_assert_button_event(li, BTN_RIGHT, LIBINPUT_BUTTON_STATE_PRESSED);
+
+	/* Events not yet fetched stay in the queue */
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_wait_for_event(li);
+
+	libinput_input_thread_stop(li);
+	litest_assert_int_eq(libinput_get_fd(li), epoll_fd);
+	litest_assert_only_typed_events(li, LIBINPUT_EVENT_POINTER_MOTION);
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	litest_assert_button_event(li, BTN_RIGHT, LIBINPUT_BUTTON_STATE_RELEASED);
+}
+END_TEST
+
+static void
+input_thread_enable_middle_emulation(struct libinput *li, void *data)
+{
+	struct input_thread_call *call = data;
+
+	call->status = libinput_device_config_middle_emulation_set_enabled(
+		call->device,
+		LIBINPUT_CONFIG_MIDDLE_EMULATION_ENABLED);
+}
+
+START_TEST(input_thread_virtual_clock)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct input_thread_call call = {
+		.device = dev->libinput_device,
+		.status = LIBINPUT_CONFIG_STATUS_INVALID,
+	};
+
+	litest_drain_events(li);
+	litest_assert_int_eq(libinput_input_thread_start(li), 0);
+
+	libinput_input_thread_call(li, input_thread_enable_middle_emulation, &call);
+	litest_assert_enum_eq(call.status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+
+	/* The press is held back until the middle button timeout. Advancing
+	 * the clock processes the press first, then fires the timer, and the
+	 * event is queued when libinput_clock_advance() returns */
+	litest_button_click(dev, BTN_LEFT, true);
+	libinput_clock_advance(li, s2us(10));
+
+	_destroy_(libinput_event) *event = libinput_get_event(li);
+	litest_is_button_event(event, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+
+	libinput_input_thread_stop(li);
+
+	litest_button_click(dev, BTN_LEFT, false);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+}
+END_TEST
+
+static void
+reopen_device(struct libinput_device *device)
+{
+	libinput_device_config_send_events_set_mode(
+		device,
+		LIBINPUT_CONFIG_SEND_EVENTS_DISABLED);
+	libinput_device_config_send_events_set_mode(
+		device,
+		LIBINPUT_CONFIG_SEND_EVENTS_ENABLED);
+}
+
+START_TEST(io_uring_backend)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_device *device = dev->libinput_device;
+	uint64_t submissions;
+
+	/* Built without io_uring or not supported by the kernel */
+	if (libinput_set_io_uring_enabled(li, 1) < 0)
+		return LITEST_NOT_APPLICABLE;
+
+	litest_assert(libinput_get_io_uring_enabled(li));
+
+	/* Re-opening the device switches it to io_uring */
+	reopen_device(device);
+	litest_drain_events(li);
+
+	submissions = libinput_get_stat(li, LIBINPUT_STAT_IO_URING_SUBMISSIONS);
+	litest_assert_int_gt(submissions, 0U);
+
+	for (int i = 0; i < 5; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+
+	for (int i = 0; i < 5; i++) {
+		litest_wait_for_event(li);
+		struct libinput_event *event = libinput_get_event(li);
+		litest_is_motion_event(event);
+		libinput_event_destroy(event);
+	}
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+
+	litest_assert_int_gt(libinput_get_stat(li, LIBINPUT_STAT_IO_URING_SUBMISSIONS),
+			     submissions);
+}
+END_TEST
+
+START_TEST(bulk_read_pointer)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	litest_assert(!libinput_get_bulk_read_enabled(li));
+	libinput_set_bulk_read_enabled(li, 1);
+	litest_assert(libinput_get_bulk_read_enabled(li));
+
+	/* Re-opening the device switches it to bulk reads */
+	reopen_device(dev->libinput_device);
+	litest_drain_events(li);
+
+	/* More events than fit into a single read */
+	for (int i = 0; i < 100; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_dispatch(li);
+
+	for (int i = 0; i < 100; i++) {
+		struct libinput_event *event = libinput_get_event(li);
+		litest_is_motion_event(event);
+		libinput_event_destroy(event);
+	}
+	litest_assert_empty_queue(li);
+
+	litest_button_click_debounced(dev, li, BTN_LEFT, true);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_PRESSED);
+	litest_button_click_debounced(dev, li, BTN_LEFT, false);
+	litest_assert_button_event(li, BTN_LEFT, LIBINPUT_BUTTON_STATE_RELEASED);
+}
+END_TEST
+
+START_TEST(bulk_read_touch)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	libinput_set_bulk_read_enabled(li, 1);
+	reopen_device(dev->libinput_device);
+	litest_drain_events(li);
+
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_down(dev, 1, 60, 60);
+	litest_dispatch(li);
+	litest_assert_touch_down_frame(li);
+	litest_assert_touch_down_frame(li);
+
+	litest_touch_move_two_touches(dev, 50, 50, 60, 60, 10, 10, 10);
+	litest_dispatch(li);
+
+	struct libinput_event *event;
+	int nmotion = 0;
+	while ((event = libinput_get_event(li))) {
+		if (libinput_event_get_type(event) == LIBINPUT_EVENT_TOUCH_MOTION)
+			nmotion++;
+		else
+			litest_is_touch_event(event, LIBINPUT_EVENT_TOUCH_FRAME);
+		libinput_event_destroy(event);
+	}
+	litest_assert_int_eq(nmotion, 20);
+
+	litest_touch_up(dev, 1);
+	litest_touch_up(dev, 0);
+	litest_dispatch(li);
+	litest_assert_touch_up_frame(li);
+	litest_assert_touch_up_frame(li);
+}
+END_TEST
+
+static uint64_t
+latency_histogram_total(struct libinput_device *device,
+			enum libinput_latency_stage stage)
+{
+	uint64_t buckets[64];
+	uint64_t total = 0;
+	size_t nbuckets = libinput_device_get_latency_histogram(device,
+								stage,
+								buckets,
+								ARRAY_LENGTH(buckets));
+
+	litest_assert_int_gt(nbuckets, 0U);
+	litest_assert_int_le(nbuckets, ARRAY_LENGTH(buckets));
+
+	for (size_t i = 0; i < nbuckets; i++)
+		total += buckets[i];
+
+	return total;
+}
+
+START_TEST(latency_stats)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	enum libinput_latency_stage stages[] = {
+		LIBINPUT_LATENCY_STAGE_KERNEL_TO_READ,
+		LIBINPUT_LATENCY_STAGE_READ_TO_PLUGIN_EXIT,
+		LIBINPUT_LATENCY_STAGE_PLUGIN_EXIT_TO_QUEUE,
+		LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT,
+	};
+
+	litest_drain_events(li);
+
+	/* Disabled by default, nothing is collected */
+	litest_assert(!libinput_get_latency_stats_enabled(li));
+	for (int i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_drain_events(li);
+
+	ARRAY_FOR_EACH(stages, stage) {
+		litest_assert_int_eq(latency_histogram_total(device, *stage), 0U);
+	}
+
+	libinput_set_latency_stats_enabled(li, 1);
+	litest_assert(libinput_get_latency_stats_enabled(li));
+	for (int i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+	litest_drain_events(li);
+
+	/* One frame and one motion event each */
+	ARRAY_FOR_EACH(stages, stage) {
+		litest_assert_int_eq(latency_histogram_total(device, *stage), 10U);
+	}
+
+	libinput_set_latency_stats_enabled(li, 0);
+}
+END_TEST
+
+struct latency_stats_call {
+	struct libinput_device *device;
+	uint64_t totals[LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT];
+};
+
+static void
+latency_stats_read_histograms(struct libinput *li, void *data)
+{
+	struct latency_stats_call *call = data;
+
+	for (size_t i = 0; i < ARRAY_LENGTH(call->totals); i++)
+		call->totals[i] = latency_histogram_total(call->device, i + 1);
+}
+
+START_TEST(latency_stats_input_thread)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct latency_stats_call call = {
+		.device = dev->libinput_device,
+	};
+
+	litest_drain_events(li);
+	libinput_set_latency_stats_enabled(li, 1);
+	litest_assert_int_eq(libinput_input_thread_start(li), 0);
+
+	for (int i = 0; i < 10; i++) {
+		litest_event(dev, EV_REL, REL_X, 1);
+		litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	}
+
+	for (int i = 0; i < 10; i++) {
+		litest_wait_for_event(li);
+		struct libinput_event *event = libinput_get_event(li);
+		litest_is_motion_event(event);
+		libinput_event_destroy(event);
+	}
+
+	/* The input thread writes the first stages, the caller's thread the
+	 * last one, both must be visible from the input thread */
+	libinput_input_thread_call(li, latency_stats_read_histograms, &call);
+	ARRAY_FOR_EACH(call.totals, total) {
+		litest_assert_int_eq(*total, 10U);
+	}
+
+	libinput_input_thread_stop(li);
+	libinput_set_latency_stats_enabled(li, 0);
+}
+END_TEST
+
+START_TEST(event_format_truncated)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+	struct libinput_print_options opts = { 0 };
+	char buf[8];
+
+	litest_drain_events(li);
+
+	litest_event(dev, EV_REL, REL_X, 1);
+	litest_event(dev, EV_SYN, SYN_REPORT, 0);
+	litest_dispatch(li);
+
+	_destroy_(libinput_event) *event = libinput_get_event(li);
+	litest_assert_notnull(event);
+
+	/* The first character depends on the previously formatted event,
+	 * only compare the rest */
+	_autofree_ char *full = libinput_event_to_str(event, 0, &opts);
+	size_t len = libinput_event_format(event, 0, &opts, buf, sizeof(buf));
+	litest_assert_int_eq(len, strlen(full));
+	litest_assert_int_ge(len, sizeof(buf));
+	litest_assert_int_eq(strlen(buf), sizeof(buf) - 1);
+	litest_assert(strneq(buf + 1, full + 1, sizeof(buf) - 2));
+
+	_autofree_ char *alloc = NULL;
+	const char *str = libinput_event_format_fallback(event,
+							 0,
+							 &opts,
+							 buf,
+							 sizeof(buf),
+							 &alloc);
+	litest_assert_ptr_eq(str, alloc);
+	litest_assert_str_eq(str + 1, full + 1);
+
+	_autofree_ char *unused = NULL;
+	str = libinput_event_format_fallback(event, 0, &opts, full, len + 1, &unused);
+	litest_assert_ptr_eq(str, full);
+	litest_assert_ptr_null(unused);
+}
+END_TEST
+
 START_TEST(udev_absinfo_override)
 {
 	struct litest_device *dev = litest_current_device();
@@ -909,6 +1644,22 @@ TEST_COLLECTION(misc)
 
 	litest_add_no_device(fd_no_event_leak);
 
+	litest_add_for_device(event_pool_recycle, LITEST_MOUSE);
+	litest_add_for_device(event_get_events, LITEST_KEYBOARD);
+	litest_add_no_device(dispatch_budget);
+	litest_add_for_device(latency_stats, LITEST_MOUSE);
+	litest_add_for_device(latency_stats_input_thread, LITEST_MOUSE);
+	litest_add_for_device(motion_coalescing, LITEST_MOUSE);
+	litest_add_for_device(event_queue_limit, LITEST_MOUSE);
+	litest_add_for_device(event_queue_limit_tablet_tool_ref, LITEST_WACOM_CINTIQ_12WX_PEN);
+	litest_add_for_device(virtual_clock, LITEST_MOUSE);
+	litest_add_for_device(input_thread, LITEST_MOUSE);
+	litest_add_for_device(input_thread_virtual_clock, LITEST_MOUSE);
+	litest_add_for_device(io_uring_backend, LITEST_MOUSE);
+	litest_add_for_device(bulk_read_pointer, LITEST_MOUSE);
+	litest_add_for_device(bulk_read_touch, LITEST_GENERIC_MULTITOUCH_SCREEN);
+	litest_add_for_device(event_format_truncated, LITEST_MOUSE);
+
 	litest_add_for_device(udev_absinfo_override, LITEST_ABSINFO_OVERRIDE);
 	/* clang-format on */
 }
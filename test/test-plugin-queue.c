@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2026 Red Hat, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/* Checks that a frame queued by one plugin is not modified by a later
+ * plugin while the first plugin still holds it.
+ *
+ * The "replay" plugin replaces every frame with a copy of the first frame
+ * it saw, which it keeps and queues again each time. The "double" plugin
+ * after it doubles every REL_X in place. Every motion event must thus
+ * have twice the original delta, not four or eight times.
+ *
+ * The plugin API is internal, this links against the library objects.
+ * This needs uinput and thus must be run as root, it exits with the meson
+ * skip code otherwise.
+ */
+
+#include <config.h>
+
+#include <libevdev/libevdev-uinput.h>
+#include <libinput.h>
+#include <stdio.h>
+
+#include "benchmark-helpers.h"
+#include "util-mem.h"
+
+#include "evdev-frame.h"
+#include "libinput-plugin.h"
+
+#define NFRAMES 4
+
+struct replay_data {
+	struct evdev_frame *saved;
+};
+
+static void
+replay_plugin_destroy(struct libinput_plugin *plugin)
+{
+	struct replay_data *data = libinput_plugin_get_user_data(plugin);
+
+	data->saved = evdev_frame_unref(data->saved);
+}
+
+static void
+enable_event_frame(struct libinput_plugin *plugin, struct libinput_device *device)
+{
+	libinput_plugin_enable_device_event_frame(plugin, device, true);
+}
+
+static void
+replay_plugin_evdev_frame(struct libinput_plugin *plugin,
+			  struct libinput_device *device,
+			  struct evdev_frame *frame)
+{
+	struct replay_data *data = libinput_plugin_get_user_data(plugin);
+
+	if (!data->saved)
+		data->saved = evdev_frame_clone(frame);
+
+	evdev_frame_set_time(data->saved, evdev_frame_get_time(frame));
+	libinput_plugin_append_evdev_frame(plugin, device, data->saved);
+	evdev_frame_reset(frame);
+}
+
+static const struct libinput_plugin_interface replay_interface = {
+	.destroy = replay_plugin_destroy,
+	.device_added = enable_event_frame,
+	.evdev_frame = replay_plugin_evdev_frame,
+};
+
+static void
+double_plugin_evdev_frame(struct libinput_plugin *plugin,
+			  struct libinput_device *device,
+			  struct evdev_frame *frame)
+{
+	size_t nevents;
+	struct evdev_event *events = evdev_frame_get_events(frame, &nevents);
+
+	for (size_t i = 0; i < nevents; i++) {
+		if (evdev_usage_eq(events[i].usage, EVDEV_REL_X))
+			events[i].value *= 2;
+	}
+}
+
+static const struct libinput_plugin_interface double_interface = {
+	.device_added = enable_event_frame,
+	.evdev_frame = double_plugin_evdev_frame,
+};
+
+static void
+add_plugin(struct libinput *li,
+	   const char *name,
+	   const struct libinput_plugin_interface *interface,
+	   void *data)
+{
+	_unref_(libinput_plugin) *plugin =
+		libinput_plugin_new(li, name, interface, data);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct libevdev_uinput *uinput = benchmark_create_mouse();
+	if (!uinput) {
+		fprintf(stderr, "Failed to create uinput device, skipping\n");
+		return 77;
+	}
+
+	struct replay_data replay = { 0 };
+	struct libinput *li = libinput_path_create_context(&benchmark_interface, NULL);
+	/* Registered before the internal plugins, in this order */
+	add_plugin(li, "replay", &replay_interface, &replay);
+	add_plugin(li, "double", &double_interface, NULL);
+	libinput_plugin_system_load_plugins(li, LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+
+	if (!libinput_path_add_device(li, libevdev_uinput_get_devnode(uinput))) {
+		fprintf(stderr, "Failed to add device, skipping\n");
+		libinput_unref(li);
+		libevdev_uinput_destroy(uinput);
+		return 77;
+	}
+
+	for (int i = 0; i < NFRAMES; i++) {
+		libevdev_uinput_write_event(uinput, EV_REL, REL_X, 1);
+		libevdev_uinput_write_event(uinput, EV_SYN, SYN_REPORT, 0);
+	}
+	libinput_dispatch(li);
+
+	int nmotion = 0;
+	int rc = 0;
+	struct libinput_event *event;
+	while ((event = libinput_get_event(li))) {
+		if (libinput_event_get_type(event) == LIBINPUT_EVENT_POINTER_MOTION) {
+			struct libinput_event_pointer *p =
+				libinput_event_get_pointer_event(event);
+			double dx = libinput_event_pointer_get_dx_unaccelerated(p);
+
+			if (dx != 2.0) {
+				fprintf(stderr, "motion %d: dx %.1f, expected 2.0\n",
+					nmotion,
+					dx);
+				rc = 1;
+			}
+			nmotion++;
+		}
+		libinput_event_destroy(event);
+	}
+
+	if (nmotion != NFRAMES) {
+		fprintf(stderr, "%d motion events, expected %d\n", nmotion, NFRAMES);
+		rc = 1;
+	}
+
+	libinput_unref(li);
+	libevdev_uinput_destroy(uinput);
+
+	return rc;
+}
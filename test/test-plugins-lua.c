@@ -547,14 +547,14 @@ START_TEST(lua_frame_handler)
 		_destroy_(litest_device) *device = litest_add_device(li, LITEST_MOUSE);
 		litest_drain_events(li);
 
-		uint64_t before, after;
-		now_in_us(&before);
+		/* litest skips the debounce timeouts in libinput's clock */
+		uint64_t before = libinput_clock_now(li);
 		msleep(1);
 		litest_button_click_debounced(device, li, BTN_LEFT, 1);
 		litest_button_click_debounced(device, li, BTN_LEFT, 0);
 		litest_assert_logcapture_no_errors(capture);
 		msleep(1);
-		now_in_us(&after);
+		uint64_t after = libinput_clock_now(li);
 
 		/* EV_KEY << 16 | BTN_LEFT -> 65808 */
 
@@ -586,6 +586,292 @@ START_TEST(lua_frame_handler)
 }
 END_TEST
 
+START_TEST(lua_disconnect_frame_handler)
+{
+	_destroy_(tmpdir) *tmpdir = tmpdir_create(NULL);
+	const char *lua =
+		"libinput:register({1})\n"
+		"function frame_handler(device, _, _)\n"
+		"  libinput:log_info(\"frame handler called\")\n"
+		"  device:disconnect(\"evdev-frame\")\n"
+		"end\n"
+		"libinput:connect(\"new-evdev-device\", function(device) device:connect(\"evdev-frame\", frame_handler) end)\n";
+
+	_autofree_ char *path = litest_write_plugin(tmpdir->path, lua);
+	_litest_context_destroy_ struct libinput *li =
+		litest_create_context_with_plugindir(tmpdir->path);
+	if (libinput_log_get_priority(li) > LIBINPUT_LOG_PRIORITY_INFO)
+		libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_INFO);
+
+	litest_with_logcapture(li, capture) {
+		libinput_plugin_system_load_plugins(li,
+						    LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+		litest_drain_events(li);
+
+		_destroy_(litest_device) *device = litest_add_device(li, LITEST_MOUSE);
+		litest_drain_events(li);
+
+		/* The first frame disconnects the handler mid-frame, the
+		 * remaining plugins must still see both frames */
+		for (int i = 0; i < 2; i++) {
+			litest_event(device, EV_REL, REL_X, 1);
+			litest_event(device, EV_SYN, SYN_REPORT, 0);
+			litest_dispatch(li);
+		}
+
+		for (int i = 0; i < 2; i++) {
+			_destroy_(libinput_event) *ev = libinput_get_event(li);
+			litest_is_motion_event(ev);
+		}
+		litest_assert_empty_queue(li);
+
+		size_t ncalls = 0;
+		for (char **info = capture->infos; info && *info; info++) {
+			if (strstr(*info, "frame handler called"))
+				ncalls++;
+		}
+		litest_assert_int_eq(ncalls, 1U);
+		litest_assert_logcapture_no_errors(capture);
+	}
+}
+END_TEST
+
+START_TEST(lua_frame_view)
+{
+	_destroy_(tmpdir) *tmpdir = tmpdir_create(NULL);
+	const char *lua =
+		"libinput:register({1})\n"
+		"function frame_handler(device, frame, timestamp)\n"
+		"  for i = 1, #frame do\n"
+		"    if frame:usage(i) == evdev.BTN_LEFT then\n"
+		"      frame:clear()\n"
+		"      return\n"
+		"    end\n"
+		"    if frame:usage(i) == evdev.REL_X then\n"
+		"      frame:set_value(i, frame:value(i) * 3)\n"
+		"    end\n"
+		"  end\n"
+		"  frame:append(evdev.REL_Y, 2)\n"
+		"  frame:append(evdev.ABS_X, 10)\n" /* not supported by the device */
+		"end\n"
+		"libinput:connect(\"new-evdev-device\", function(device) device:connect(\"evdev-frame-view\", frame_handler) end)\n";
+
+	_autofree_ char *path = litest_write_plugin(tmpdir->path, lua);
+	_litest_context_destroy_ struct libinput *li =
+		litest_create_context_with_plugindir(tmpdir->path);
+
+	litest_with_logcapture(li, capture) {
+		libinput_plugin_system_load_plugins(li,
+						    LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+		litest_drain_events(li);
+
+		_destroy_(litest_device) *device = litest_add_device(li, LITEST_MOUSE);
+		litest_drain_events(li);
+
+		litest_event(device, EV_REL, REL_X, 2);
+		litest_event(device, EV_SYN, SYN_REPORT, 0);
+		litest_dispatch(li);
+
+		_destroy_(libinput_event) *ev = libinput_get_event(li);
+		struct libinput_event_pointer *pev = litest_is_motion_event(ev);
+		double dx = libinput_event_pointer_get_dx_unaccelerated(pev);
+		double dy = libinput_event_pointer_get_dy_unaccelerated(pev);
+		litest_assert_double_eq(dx, 6.0);
+		litest_assert_double_eq(dy, 2.0);
+
+		/* Button frames are dropped */
+		litest_event(device, EV_KEY, BTN_LEFT, 1);
+		litest_event(device, EV_SYN, SYN_REPORT, 0);
+		litest_event(device, EV_KEY, BTN_LEFT, 0);
+		litest_event(device, EV_SYN, SYN_REPORT, 0);
+		litest_dispatch(li);
+		litest_timeout_debounce(li);
+		litest_dispatch(li);
+		litest_assert_empty_queue(li);
+
+		litest_assert_logcapture_no_errors(capture);
+	}
+}
+END_TEST
+
+START_TEST(lua_frame_view_outside_callback)
+{
+	_destroy_(tmpdir) *tmpdir = tmpdir_create(NULL);
+	const char *lua =
+		"libinput:register({1})\n"
+		"stored = nil\n"
+		"function frame_handler(device, frame, timestamp)\n"
+		"  stored = frame\n"
+		"  libinput:timer_set_relative(1000)\n"
+		"end\n"
+		"function timer_expired(t)\n"
+		"  libinput:log_info(\"count: \" .. #stored)\n"
+		"end\n"
+		"libinput:connect(\"timer-expired\", timer_expired)\n"
+		"libinput:connect(\"new-evdev-device\", function(device) device:connect(\"evdev-frame-view\", frame_handler) end)\n";
+
+	_autofree_ char *path = litest_write_plugin(tmpdir->path, lua);
+	_litest_context_destroy_ struct libinput *li =
+		litest_create_context_with_plugindir(tmpdir->path);
+
+	litest_with_logcapture(li, capture) {
+		libinput_plugin_system_load_plugins(li,
+						    LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+		litest_drain_events(li);
+
+		_destroy_(litest_device) *device = litest_add_device(li, LITEST_MOUSE);
+		litest_drain_events(li);
+
+		litest_event(device, EV_REL, REL_X, 1);
+		litest_event(device, EV_SYN, SYN_REPORT, 0);
+		litest_dispatch(li);
+		msleep(10); /* trigger the timer */
+		litest_dispatch(li);
+
+		litest_assert_strv_substring(capture->errors,
+					     "EvdevFrame used outside its "
+					     "evdev-frame-view callback");
+		litest_assert(!strv_find_substring(capture->infos, "count: ", NULL));
+	}
+}
+END_TEST
+
+static ssize_t
+find_plugin_index(struct libinput *li, const char *name)
+{
+	const char *n;
+	for (size_t i = 0; (n = libinput_plugin_system_get_plugin_name(li, i)); i++) {
+		if (strstr(n, name))
+			return i;
+	}
+	return -1;
+}
+
+START_TEST(lua_cpu_budget)
+{
+	_destroy_(tmpdir) *tmpdir = tmpdir_create(NULL);
+	const char *lua =
+		"libinput:register({1})\n"
+		"function frame_handler(device, frame, timestamp)\n"
+		"  while true do end\n"
+		"end\n"
+		"libinput:connect(\"new-evdev-device\", function(device) device:connect(\"evdev-frame\", frame_handler) end)\n";
+
+	_autofree_ char *path = litest_write_plugin(tmpdir->path, lua);
+	_litest_context_destroy_ struct libinput *li =
+		litest_create_context_with_plugindir(tmpdir->path);
+
+	litest_with_logcapture(li, capture) {
+		libinput_plugin_system_load_plugins(li,
+						    LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+		litest_drain_events(li);
+
+		_destroy_(litest_device) *device = litest_add_device(li, LITEST_MOUSE);
+		litest_drain_events(li);
+
+		ssize_t index = find_plugin_index(li, "lua_cpu_budget");
+		litest_assert_int_ge(index, 0);
+
+		/* The first overruns abort the call but keep the plugin */
+		for (int i = 1; i < 3; i++) {
+			litest_event(device, EV_REL, REL_X, 1);
+			litest_event(device, EV_SYN, SYN_REPORT, 0);
+			litest_dispatch(li);
+
+			uint64_t overruns = libinput_plugin_system_get_plugin_stat(
+				li,
+				index,
+				LIBINPUT_PLUGIN_STAT_BUDGET_OVERRUNS);
+			litest_assert_int_eq(overruns, (uint64_t)i);
+			uint64_t max = libinput_plugin_system_get_plugin_stat(
+				li,
+				index,
+				LIBINPUT_PLUGIN_STAT_TIME_MAX_US);
+			litest_assert_int_ge(max, ms2us(5));
+		}
+		litest_assert_strv_substring(capture->errors, "exceeded its CPU budget");
+		litest_assert(!strv_find_substring(capture->errors,
+						   "unloading after error",
+						   NULL));
+
+		/* The third one unloads the plugin */
+		litest_event(device, EV_REL, REL_X, 1);
+		litest_event(device, EV_SYN, SYN_REPORT, 0);
+		litest_dispatch(li);
+
+		litest_assert_strv_substring(capture->errors, "unloading after error");
+		litest_assert_int_eq(find_plugin_index(li, "lua_cpu_budget"), -1);
+	}
+}
+END_TEST
+
+START_TEST(lua_cpu_budget_toplevel)
+{
+	_destroy_(tmpdir) *tmpdir = tmpdir_create(NULL);
+	const char *lua =
+		"libinput:register({1})\n"
+		"while true do end\n";
+
+	_autofree_ char *path = litest_write_plugin(tmpdir->path, lua);
+	_litest_context_destroy_ struct libinput *li =
+		litest_create_context_with_plugindir(tmpdir->path);
+
+	litest_with_logcapture(li, capture) {
+		libinput_plugin_system_load_plugins(li,
+						    LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+		litest_drain_events(li);
+
+		/* A single overrun in the top-level chunk unloads the plugin */
+		litest_assert_strv_substring(capture->errors, "exceeded its CPU budget");
+		litest_assert_int_eq(find_plugin_index(li, "lua_cpu_budget_toplevel"),
+				     -1);
+	}
+}
+END_TEST
+
+START_TEST(lua_bytecode_cache)
+{
+	_destroy_(tmpdir) *tmpdir = tmpdir_create(NULL);
+	_destroy_(tmpdir) *cachedir = tmpdir_create(NULL);
+	_autofree_ char *path = litest_write_plugin(
+		tmpdir->path,
+		"libinput:register({1})\nlibinput:log_info(\"plugin version 1\")\n");
+
+	/* The second context must use the chunk cached by the first one,
+	 * the third one sees the updated plugin */
+	for (int i = 0; i < 3; i++) {
+		if (i == 2) {
+			const char *lua =
+				"libinput:register({1})\n"
+				"libinput:log_info(\"plugin version two\")\n";
+			_autoclose_ int fd = open(path, O_WRONLY | O_TRUNC);
+			litest_assert_errno_success(fd);
+			write(fd, lua, strlen(lua));
+			fsync(fd);
+		}
+
+		_litest_context_destroy_ struct libinput *li =
+			litest_create_context_with_plugindir(tmpdir->path);
+		libinput_plugin_system_set_cache_directory(li, cachedir->path);
+		libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_DEBUG);
+
+		litest_with_logcapture(li, capture) {
+			libinput_plugin_system_load_plugins(
+				li,
+				LIBINPUT_PLUGIN_SYSTEM_FLAG_NONE);
+
+			litest_assert_logcapture_no_errors(capture);
+			litest_assert_strv_substring(capture->infos,
+						     i < 2 ? "plugin version 1"
+							   : "plugin version two");
+			litest_assert_strv_substring(capture->debugs,
+						     i == 1 ? "loaded from cache"
+							    : "stored in cache");
+		}
+	}
+}
+END_TEST
+
 START_TEST(lua_device_info)
 {
 	_destroy_(tmpdir) *tmpdir = tmpdir_create(NULL);
@@ -1093,6 +1379,12 @@ TEST_COLLECTION(lua)
 	litest_add_no_device(lua_disallowed_functions);
 
 	litest_add_no_device(lua_frame_handler);
+	litest_add_no_device(lua_disconnect_frame_handler);
+	litest_add_no_device(lua_frame_view);
+	litest_add_no_device(lua_frame_view_outside_callback);
+	litest_add_no_device(lua_bytecode_cache);
+	litest_add_no_device(lua_cpu_budget);
+	litest_add_no_device(lua_cpu_budget_toplevel);
 	litest_add_no_device(lua_device_info);
 	litest_add_no_device(lua_set_absinfo);
 	litest_add_no_device(lua_enable_disable_evdev_usage);
@@ -1105,6 +1105,7 @@ START_TEST(quirks_parse_uint_attr)
 		QUIRK_ATTR_PALM_SIZE_THRESHOLD,
 		QUIRK_ATTR_PALM_PRESSURE_THRESHOLD,
 		QUIRK_ATTR_THUMB_PRESSURE_THRESHOLD,
+		QUIRK_ATTR_TOUCHPAD_HISTORY_LENGTH,
 	};
 	/* clang-format off */
 	struct qtest_uint test_values[] = {
@@ -53,6 +53,45 @@ START_TEST(touchpad_1fg_tap)
 }
 END_TEST
 
+START_TEST(touchpad_1fg_tap_stats)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	litest_enable_tap(dev->libinput_device);
+	litest_disable_hold_gestures(dev->libinput_device);
+	litest_drain_events(li);
+
+	uint64_t taps = libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAPS);
+	uint64_t timeouts = libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAP_TIMEOUTS);
+	uint64_t cancels = libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAP_CANCELS);
+
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_up(dev, 0);
+	litest_dispatch(li);
+	litest_timeout_tap(li);
+	litest_drain_events(li);
+
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAPS),
+			     taps + 1);
+	litest_assert_int_gt(libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAP_TIMEOUTS),
+			     timeouts);
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAP_CANCELS),
+			     cancels);
+
+	/* Motion turns the touch into a pointer move, not a tap */
+	litest_touch_down(dev, 0, 50, 50);
+	litest_touch_move_to(dev, 0, 50, 50, 80, 80, 10);
+	litest_touch_up(dev, 0);
+	litest_drain_events(li);
+
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAPS),
+			     taps + 1);
+	litest_assert_int_eq(libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TAP_CANCELS),
+			     cancels + 1);
+}
+END_TEST
+
 START_TEST(touchpad_doubletap)
 {
 	struct litest_device *dev = litest_current_device();
@@ -5391,6 +5430,7 @@ TEST_COLLECTION(touchpad_tap)
 {
 	/* clang-format off */
 	litest_add(touchpad_1fg_tap, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add(touchpad_1fg_tap_stats, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_with_parameters(params, "fingers_1st", 'i', 3, 1, 2, 3,
 				       "fingers_2nd", 'i', 3, 1, 2, 3) {
 		litest_add_parametrized(touchpad_doubletap, LITEST_TOUCHPAD, LITEST_ANY, params);
@@ -111,6 +111,38 @@ START_TEST(touchpad_2fg_no_motion)
 }
 END_TEST
 
+START_TEST(touchpad_2fg_dirty_touches_skipped)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	libinput_device_config_tap_set_enabled(dev->libinput_device,
+					       LIBINPUT_CONFIG_TAP_DISABLED);
+
+	litest_touch_down(dev, 0, 20, 20);
+	litest_touch_down(dev, 1, 70, 20);
+	litest_drain_events(li);
+
+	uint64_t visits = libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TOUCH_VISITS);
+	uint64_t skips = libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TOUCH_SKIPS);
+
+	/* Only the first finger moves, the second one must be skipped */
+	litest_touch_move_to(dev, 0, 20, 20, 30, 30, 10);
+	litest_dispatch(li);
+
+	uint64_t nvisits =
+		libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TOUCH_VISITS) - visits;
+	uint64_t nskips =
+		libinput_get_stat(li, LIBINPUT_STAT_TOUCHPAD_TOUCH_SKIPS) - skips;
+	litest_assert_int_gt(nvisits, 0U);
+	litest_assert_int_gt(nskips, nvisits);
+
+	litest_touch_up(dev, 1);
+	litest_touch_up(dev, 0);
+	litest_drain_events(li);
+}
+END_TEST
+
 static void
 test_2fg_scroll(struct litest_device *dev, double dx, double dy, bool want_sleep)
 {
@@ -6647,6 +6679,68 @@ START_TEST(touchpad_speed_ignore_hovering_finger)
 }
 END_TEST
 
+START_TEST(touchpad_speed_fitted_speed)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput *li = dev->libinput;
+
+	if (!has_thumb_detect(dev))
+		return LITEST_NOT_APPLICABLE;
+
+	if (litest_has_clickfinger(dev))
+		litest_enable_clickfinger(dev);
+
+	libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_DEBUG);
+	litest_drain_events(li);
+
+	/* About 5mm/s, the second finger must not be a speed-based thumb */
+	litest_with_logcapture(li, capture) {
+		litest_touch_down(dev, 0, 50, 20);
+		litest_touch_move_to(dev, 0, 50, 20, 51, 20, 20);
+		litest_touch_down(dev, 1, 50, 80);
+		litest_dispatch(li);
+
+		litest_assert_strv_no_substring(capture->debugs, "speed-based thumb");
+
+		litest_touch_up(dev, 1);
+		litest_touch_up(dev, 0);
+		litest_dispatch(li);
+	}
+	litest_drain_events(li);
+
+	/* Several hundred mm/s, well above the threshold */
+	litest_with_logcapture(li, capture) {
+		litest_touch_down(dev, 0, 20, 20);
+		litest_touch_move_to(dev, 0, 20, 20, 85, 20, 20);
+		litest_touch_down(dev, 1, 20, 80);
+		litest_dispatch(li);
+
+		litest_assert_strv_substring(capture->debugs, "speed-based thumb");
+
+		litest_touch_up(dev, 1);
+		litest_touch_up(dev, 0);
+		litest_dispatch(li);
+	}
+	litest_drain_events(li);
+}
+END_TEST
+
+START_TEST(touchpad_history_length_quirk)
+{
+	_litest_context_destroy_ struct libinput *li = litest_create_context();
+	libinput_log_set_priority(li, LIBINPUT_LOG_PRIORITY_DEBUG);
+
+	litest_with_logcapture(li, capture) {
+		struct litest_device *dev =
+			litest_add_device(li, LITEST_TOUCHPAD_HISTORY_LENGTH);
+
+		litest_assert_strv_substring(capture->debugs,
+					     "using a motion history of 8 events");
+		litest_device_destroy(dev);
+	}
+}
+END_TEST
+
 enum suspend {
 	SUSPEND_EXT_MOUSE = 1,
 	SUSPEND_SENDEVENTS,
@@ -7022,11 +7116,100 @@ START_TEST(touchpad_fuzz)
 }
 END_TEST
 
+START_TEST(touchpad_pointer_prediction_config)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	enum libinput_config_status status;
+	enum libinput_config_pointer_prediction_state state;
+
+	litest_assert(libinput_device_config_pointer_prediction_is_available(device));
+	state = libinput_device_config_pointer_prediction_get_enabled(device);
+	litest_assert_enum_eq(state, LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED);
+	state = libinput_device_config_pointer_prediction_get_default_enabled(device);
+	litest_assert_enum_eq(state, LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED);
+
+	status = libinput_device_config_pointer_prediction_set_enabled(
+		device,
+		LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED);
+	litest_assert_enum_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	state = libinput_device_config_pointer_prediction_get_enabled(device);
+	litest_assert_enum_eq(state, LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED);
+
+	status = libinput_device_config_pointer_prediction_set_enabled(
+		device,
+		LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED);
+	litest_assert_enum_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+
+	status = libinput_device_config_pointer_prediction_set_enabled(device, 3);
+	litest_assert_enum_eq(status, LIBINPUT_CONFIG_STATUS_INVALID);
+}
+END_TEST
+
+static void
+touchpad_sum_motion(struct litest_device *dev, double *dx, double *dy)
+{
+	struct libinput *li = dev->libinput;
+	struct libinput_event *event;
+
+	*dx = 0.0;
+	*dy = 0.0;
+
+	litest_touch_down(dev, 0, 20, 50);
+	litest_touch_move_to(dev, 0, 20, 50, 70, 60, 20);
+	litest_touch_up(dev, 0);
+	litest_dispatch(li);
+
+	while ((event = libinput_get_event(li))) {
+		if (libinput_event_get_type(event) == LIBINPUT_EVENT_POINTER_MOTION) {
+			struct libinput_event_pointer *p =
+				libinput_event_get_pointer_event(event);
+			*dx += libinput_event_pointer_get_dx(p);
+			*dy += libinput_event_pointer_get_dy(p);
+		}
+		libinput_event_destroy(event);
+	}
+}
+
+START_TEST(touchpad_pointer_prediction_no_drift)
+{
+	struct litest_device *dev = litest_current_device();
+	struct libinput_device *device = dev->libinput_device;
+	struct libinput *li = dev->libinput;
+	double dx, dy, predicted_dx, predicted_dy;
+	enum libinput_config_status status;
+
+	/* With a flat profile the deltas don't depend on the timing, so
+	 * once the finger is up the pointer must have ended up in exactly
+	 * the same place with and without prediction */
+	litest_disable_tap(device);
+	status = libinput_device_config_accel_set_profile(
+		device,
+		LIBINPUT_CONFIG_ACCEL_PROFILE_FLAT);
+	litest_assert_enum_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+	litest_drain_events(li);
+
+	touchpad_sum_motion(dev, &dx, &dy);
+
+	status = libinput_device_config_pointer_prediction_set_enabled(
+		device,
+		LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED);
+	litest_assert_enum_eq(status, LIBINPUT_CONFIG_STATUS_SUCCESS);
+
+	touchpad_sum_motion(dev, &predicted_dx, &predicted_dy);
+
+	litest_assert_double_gt(dx, 0.0);
+	litest_assert_double_eq_epsilon(predicted_dx, dx, LITEST_DEFAULT_EPSILON);
+	litest_assert_double_eq_epsilon(predicted_dy, dy, LITEST_DEFAULT_EPSILON);
+}
+END_TEST
+
 TEST_COLLECTION(touchpad)
 {
 	/* clang-format off */
 	litest_add(touchpad_1fg_motion, LITEST_TOUCHPAD, LITEST_ANY);
 	litest_add(touchpad_2fg_no_motion, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
+	litest_add(touchpad_2fg_dirty_touches_skipped, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH);
 
 	litest_add(touchpad_2fg_scroll, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
 	litest_add(touchpad_2fg_scroll_initially_diagonal, LITEST_TOUCHPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
@@ -7140,6 +7323,10 @@ TEST_COLLECTION(touchpad)
 	litest_add(touchpad_speed_allow_nearby_finger, LITEST_CLICKPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
 	litest_add(touchpad_speed_ignore_finger_edgescroll, LITEST_CLICKPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
 	litest_add_for_device(touchpad_speed_ignore_hovering_finger, LITEST_BCM5974);
+	litest_add(touchpad_speed_fitted_speed, LITEST_CLICKPAD, LITEST_SINGLE_TOUCH|LITEST_SEMI_MT);
+	litest_add_for_device(touchpad_speed_fitted_speed, LITEST_TOUCHPAD_HISTORY_LENGTH);
+	litest_add_for_device(touchpad_speed_fitted_speed, LITEST_TOUCHPAD_HISTORY_LENGTH_SHORT);
+	litest_add_no_device(touchpad_history_length_quirk);
 
 	litest_with_parameters(params, "mode", 'I', 4, litest_named_i32(SUSPEND_EXT_MOUSE, "external_mouse"),
 						       litest_named_i32(SUSPEND_SENDEVENTS, "sendevents"),
@@ -7154,6 +7341,9 @@ TEST_COLLECTION(touchpad)
 	litest_add_for_device(touchpad_end_start_touch, LITEST_WACOM_INTUOS5_FINGER);
 
 	litest_add(touchpad_fuzz, LITEST_TOUCHPAD, LITEST_ANY);
+
+	litest_add(touchpad_pointer_prediction_config, LITEST_TOUCHPAD, LITEST_ANY);
+	litest_add(touchpad_pointer_prediction_no_drift, LITEST_TOUCHPAD, LITEST_ANY);
 	/* clang-format on */
 }
 
@@ -39,6 +39,7 @@
 #include "util-prop-parsers.h"
 #include "util-range.h"
 #include "util-ratelimit.h"
+#include "util-spsc.h"
 #include "util-stringbuf.h"
 #include "util-strings.h"
 #include "util-time.h"
@@ -636,6 +637,45 @@ START_TEST(ratelimit_helpers)
 }
 END_TEST
 
+START_TEST(spsc_queue_test)
+{
+	struct spsc_queue queue;
+	int values[10];
+
+	litest_assert(!spsc_queue_init(&queue, 0));
+	litest_assert(!spsc_queue_init(&queue, 6));
+	litest_assert(spsc_queue_init(&queue, 8));
+
+	litest_assert_ptr_null(spsc_queue_peek(&queue));
+	litest_assert_ptr_null(spsc_queue_pop(&queue));
+
+	/* Several rounds so head and tail wrap around the slots */
+	for (int round = 0; round < 5; round++) {
+		for (size_t i = 0; i < 8; i++)
+			litest_assert(spsc_queue_push(&queue, &values[i]));
+		litest_assert(!spsc_queue_push(&queue, &values[8]));
+
+		litest_assert_ptr_eq(spsc_queue_peek(&queue), &values[0]);
+		litest_assert_ptr_eq(spsc_queue_pop(&queue), &values[0]);
+		litest_assert(spsc_queue_push(&queue, &values[8]));
+		litest_assert(!spsc_queue_push(&queue, &values[9]));
+
+		for (size_t i = 1; i < 9; i++)
+			litest_assert_ptr_eq(spsc_queue_pop(&queue), &values[i]);
+		litest_assert_ptr_null(spsc_queue_peek(&queue));
+		litest_assert_ptr_null(spsc_queue_pop(&queue));
+
+		/* leave the queue at a different offset for the next round */
+		for (int i = 0; i <= round; i++) {
+			litest_assert(spsc_queue_push(&queue, &values[i]));
+			litest_assert_ptr_eq(spsc_queue_pop(&queue), &values[i]);
+		}
+	}
+
+	spsc_queue_fini(&queue);
+}
+END_TEST
+
 struct parser_test {
 	char *tag;
 	int expected_value;
@@ -3054,6 +3094,42 @@ START_TEST(evdev_frames)
 				     ARRAY_LENGTH(events));
 		litest_assert_int_eq(frame->max_size, ARRAY_LENGTH(events));
 	}
+	{
+		struct evdev_frame *scratch = NULL;
+
+		struct evdev_frame *frame = evdev_frame_reuse(&scratch, 3);
+		litest_assert_ptr_eq(frame, scratch);
+		litest_assert_int_eq(frame->max_size, 3U);
+
+		evdev_frame_append_one(frame, U(EVDEV_ABS_X), 1);
+		evdev_frame_append_one(frame, U(EVDEV_ABS_Y), 2);
+		evdev_frame_set_time(frame, 1234);
+
+		/* Large enough, so we get the same frame back, reset */
+		frame = evdev_frame_reuse(&scratch, 2);
+		litest_assert_ptr_eq(frame, scratch);
+		litest_assert_int_eq(evdev_frame_get_count(frame), 1U);
+		litest_assert_int_eq(evdev_frame_get_time(frame), 0U);
+
+		size_t nevents;
+		struct evdev_event *events = evdev_frame_get_events(frame, &nevents);
+		struct evdev_event zero[3] = { 0 };
+		litest_assert_int_eq(memcmp(events, zero, sizeof(zero)), 0);
+
+		/* Too small, replaced by a new frame */
+		frame = evdev_frame_reuse(&scratch, 8);
+		litest_assert_ptr_eq(frame, scratch);
+		litest_assert_int_eq(frame->max_size, 8U);
+
+		/* Referenced elsewhere, replaced by a new frame */
+		struct evdev_frame *ref = evdev_frame_ref(scratch);
+		frame = evdev_frame_reuse(&scratch, 8);
+		litest_assert_ptr_ne(frame, ref);
+		litest_assert_int_eq(ref->refcount, 1);
+		evdev_frame_unref(ref);
+
+		evdev_frame_unref(scratch);
+	}
 }
 END_TEST
 
@@ -3198,6 +3274,56 @@ START_TEST(evdev_mask_test)
 }
 END_TEST
 
+START_TEST(evdev_mask_frame_test)
+{
+	_destroy_(evdev_mask) *mask = evdev_mask_new();
+	_unref_(evdev_frame) *frame = evdev_frame_new(64);
+
+	evdev_mask_set_enum(mask, EVDEV_BTN_TOOL_RUBBER);
+	evdev_mask_set_enum(mask, EVDEV_SW_TABLET_MODE);
+
+	/* Empty frame never matches */
+	litest_assert(!evdev_mask_matches_frame(mask, frame));
+
+	/* Same code, different types */
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_X), 1);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_REL_Y), 1);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_SW_LID), 1);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_BTN_TOOL_PEN), 1);
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_MSC_SERIAL), 1);
+	litest_assert(!evdev_mask_matches_frame(mask, frame));
+
+	for (int slot = 0; slot < 10; slot++) {
+		evdev_frame_append_one(frame, evdev_usage_from(EVDEV_ABS_MT_SLOT), slot);
+		evdev_frame_append_one(frame,
+				       evdev_usage_from(EVDEV_ABS_MT_POSITION_X),
+				       slot);
+	}
+	litest_assert(!evdev_mask_matches_frame(mask, frame));
+
+	evdev_frame_append_one(frame, evdev_usage_from(EVDEV_SW_TABLET_MODE), 1);
+	litest_assert(evdev_mask_matches_frame(mask, frame));
+
+	/* Reset clears the frame's usages */
+	evdev_frame_reset(frame);
+	litest_assert(!evdev_mask_matches_frame(mask, frame));
+
+	struct evdev_event events[] = {
+		{ .usage = evdev_usage_from(EVDEV_ABS_Y), .value = 1 },
+		{ .usage = evdev_usage_from(EVDEV_BTN_TOOL_RUBBER), .value = 1 },
+		{ .usage = evdev_usage_from(EVDEV_SYN_REPORT), .value = 0 },
+	};
+	evdev_frame_set(frame, events, ARRAY_LENGTH(events));
+	litest_assert(evdev_mask_matches_frame(mask, frame));
+
+	/* Events after the SYN_REPORT are not appended */
+	evdev_frame_reset(frame);
+	struct evdev_event syn_first[] = { events[2], events[1] };
+	evdev_frame_append(frame, syn_first, ARRAY_LENGTH(syn_first));
+	litest_assert(!evdev_mask_matches_frame(mask, frame));
+}
+END_TEST
+
 int
 main(void)
 {
@@ -3226,6 +3352,7 @@ main(void)
 	ADD_TEST(bitmask_test);
 	ADD_TEST(matrix_helpers);
 	ADD_TEST(ratelimit_helpers);
+	ADD_TEST(spsc_queue_test);
 	ADD_TEST(dpi_parser);
 	ADD_TEST(wheel_click_parser);
 	ADD_TEST(wheel_click_count_parser);
@@ -3287,6 +3414,7 @@ main(void)
 	ADD_TEST(infmask_test);
 
 	ADD_TEST(evdev_mask_test);
+	ADD_TEST(evdev_mask_frame_test);
 
 	enum litest_runner_result result = litest_runner_run_tests(runner);
 	litest_runner_destroy(runner);
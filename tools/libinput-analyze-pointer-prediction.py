@@ -0,0 +1,304 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8
+# vim: set expandtab shiftwidth=4:
+# -*- Mode: python; coding: utf-8; indent-tabs-mode: nil -*- */
+#
+# Copyright © 2026 Red Hat, Inc.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the 'Software'),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED 'AS IS', WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+#
+#
+# Replays the single-finger motion of a touchpad recording through the
+# alpha-beta filter used for touchpad pointer prediction and compares the
+# predicted positions against where the finger actually was at that time.
+#
+# Input is a libinput record yaml file
+
+from dataclasses import dataclass
+
+import argparse
+import bisect
+import math
+import sys
+import yaml
+import libevdev
+
+# Keep in sync with evdev-mt-touchpad-prediction.c
+PREDICTION_ALPHA = 0.5
+PREDICTION_BETA = 0.15
+PREDICTION_MAX_LEAD = 12  # ms
+PREDICTION_TIMEOUT = 50  # ms
+
+
+@dataclass
+class Point:
+    x: float = 0.0
+    y: float = 0.0
+
+
+@dataclass
+class Sample:
+    time: int  # us
+    position: Point
+
+
+class Predictor:
+    def __init__(self, alpha, beta, max_lead, timeout):
+        self.alpha = alpha
+        self.beta = beta
+        self.max_lead = max_lead
+        self.timeout = timeout
+        self.reset()
+
+    def reset(self):
+        self.time = None
+        self.estimate = Point()
+        self.velocity = Point()
+
+    def feed(self, time, position):
+        """
+        Feed the next real position, returns the (time, position) tuple of
+        the prediction or None if there is no prediction for this sample
+        """
+        tdelta = time - self.time if self.time is not None else 0
+        self.time = time
+
+        if tdelta == 0 or tdelta > self.timeout:
+            self.estimate = Point(position.x, position.y)
+            self.velocity = Point()
+            return None
+
+        predicted = Point(
+            self.estimate.x + self.velocity.x * tdelta,
+            self.estimate.y + self.velocity.y * tdelta,
+        )
+        residual = Point(position.x - predicted.x, position.y - predicted.y)
+        self.estimate = Point(
+            predicted.x + self.alpha * residual.x,
+            predicted.y + self.alpha * residual.y,
+        )
+        self.velocity = Point(
+            self.velocity.x + self.beta * residual.x / tdelta,
+            self.velocity.y + self.beta * residual.y / tdelta,
+        )
+
+        lead = min(tdelta, self.max_lead)
+        return (
+            time + lead,
+            Point(
+                self.estimate.x + self.velocity.x * lead,
+                self.estimate.y + self.velocity.y * lead,
+            ),
+        )
+
+
+def interpolate(samples, times, time):
+    """
+    Returns the position at the given time, linearly interpolated between
+    the two surrounding samples or None if the time is after the last sample
+    """
+    idx = bisect.bisect_left(times, time)
+    if idx == 0 or idx >= len(samples):
+        return None
+
+    prev, next = samples[idx - 1], samples[idx]
+    f = (time - prev.time) / (next.time - prev.time)
+    return Point(
+        prev.position.x + f * (next.position.x - prev.position.x),
+        prev.position.y + f * (next.position.y - prev.position.y),
+    )
+
+
+def distance(a, b):
+    return math.hypot(a.x - b.x, a.y - b.y)
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def read_sequences(device, use_st):
+    """
+    Returns a list of touch sequences, each a list of Samples. Only
+    motion while exactly one finger is down is used since that is the
+    only case where libinput predicts the pointer.
+    """
+    sequences = []
+    current = []
+    ntouches = 0
+    position = Point()
+    dirty = False
+    slot = 0
+
+    if use_st:
+        axes = (libevdev.EV_ABS.ABS_X, libevdev.EV_ABS.ABS_Y)
+    else:
+        axes = (libevdev.EV_ABS.ABS_MT_POSITION_X, libevdev.EV_ABS.ABS_MT_POSITION_Y)
+
+    active_slots = set()
+
+    for event in device["events"]:
+        for evdev in event["evdev"]:
+            e = libevdev.InputEvent(
+                code=libevdev.evbit(evdev[2], evdev[3]),
+                value=evdev[4],
+                sec=evdev[0],
+                usec=evdev[1],
+            )
+
+            if use_st:
+                if e.code == libevdev.EV_KEY.BTN_TOUCH:
+                    if e.value:
+                        active_slots.add(0)
+                    else:
+                        active_slots.discard(0)
+                elif e.code == libevdev.EV_KEY.BTN_TOOL_DOUBLETAP and e.value:
+                    active_slots.add(1)
+                elif e.code == libevdev.EV_KEY.BTN_TOOL_DOUBLETAP:
+                    active_slots.discard(1)
+            elif e.code == libevdev.EV_ABS.ABS_MT_SLOT:
+                slot = e.value
+            elif e.code == libevdev.EV_ABS.ABS_MT_TRACKING_ID:
+                if e.value == -1:
+                    active_slots.discard(slot)
+                else:
+                    active_slots.add(slot)
+
+            if e.code in axes and (use_st or slot == min(active_slots, default=-1)):
+                if e.code == axes[0]:
+                    position.x = e.value
+                else:
+                    position.y = e.value
+                dirty = True
+
+            if e.code == libevdev.EV_SYN.SYN_REPORT:
+                if len(active_slots) != 1 or len(active_slots) != ntouches:
+                    if len(current) > 1:
+                        sequences.append(current)
+                    current = []
+                elif dirty:
+                    time = e.sec * 1000000 + e.usec
+                    current.append(Sample(time, Point(position.x, position.y)))
+                ntouches = len(active_slots)
+                dirty = False
+
+    if len(current) > 1:
+        sequences.append(current)
+
+    return sequences
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(
+        description="Evaluate touchpad pointer prediction against a recording"
+    )
+    parser.add_argument(
+        "path", metavar="recording", nargs=1, help="Path to libinput-record YAML file"
+    )
+    parser.add_argument(
+        "--use-st",
+        action="store_true",
+        help="Use ABS_X/ABS_Y instead of ABS_MT_POSITION_X/Y",
+    )
+    parser.add_argument(
+        "--alpha",
+        type=float,
+        default=PREDICTION_ALPHA,
+        help=f"Position gain of the filter (default {PREDICTION_ALPHA})",
+    )
+    parser.add_argument(
+        "--beta",
+        type=float,
+        default=PREDICTION_BETA,
+        help=f"Velocity gain of the filter (default {PREDICTION_BETA})",
+    )
+    parser.add_argument(
+        "--max-lead",
+        type=int,
+        default=PREDICTION_MAX_LEAD,
+        help=f"Maximum prediction in ms (default {PREDICTION_MAX_LEAD})",
+    )
+    args = parser.parse_args()
+
+    yml = yaml.safe_load(open(args.path[0]))
+    device = yml["devices"][0]
+    absinfo = device["evdev"]["absinfo"]
+    if libevdev.EV_ABS.ABS_MT_SLOT.value not in absinfo:
+        args.use_st = True
+
+    xres = absinfo[libevdev.EV_ABS.ABS_X.value][4]
+    yres = absinfo[libevdev.EV_ABS.ABS_Y.value][4]
+    if xres and yres:
+        unit = "mm"
+    else:
+        xres, yres = 1, 1
+        unit = "units"
+
+    sequences = read_sequences(device, args.use_st)
+    if not sequences:
+        print("No single-finger motion found in this recording")
+        return 1
+
+    errors = []
+    baseline_errors = []
+    for samples in sequences:
+        samples = [
+            Sample(s.time, Point(s.position.x / xres, s.position.y / yres))
+            for s in samples
+        ]
+        times = [s.time for s in samples]
+        predictor = Predictor(
+            args.alpha, args.beta, args.max_lead * 1000, PREDICTION_TIMEOUT * 1000
+        )
+        for sample in samples:
+            prediction = predictor.feed(sample.time, sample.position)
+            if prediction is None:
+                continue
+
+            time, predicted = prediction
+            actual = interpolate(samples, times, time)
+            if actual is None:
+                continue
+
+            errors.append(distance(predicted, actual))
+            baseline_errors.append(distance(sample.position, actual))
+
+    if not errors:
+        print("Not enough motion to evaluate the prediction")
+        return 1
+
+    print(f"Touch sequences: {len(sequences)}, predictions: {len(errors)}")
+    print(f"Filter: alpha {args.alpha}, beta {args.beta}, lead ≤ {args.max_lead}ms")
+    print(f"{'':15s} {'mean':>8s} {'p95':>8s} {'max':>8s}   ({unit})")
+    for name, values in (("no prediction", baseline_errors), ("prediction", errors)):
+        print(
+            f"{name:15s} {sum(values) / len(values):8.3f} "
+            f"{percentile(values, 95):8.3f} {max(values):8.3f}"
+        )
+
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main(sys.argv))
+    except KeyboardInterrupt:
+        pass
@@ -50,6 +50,12 @@ static volatile sig_atomic_t stop = 0;
 static bool be_quiet = false;
 static bool compress_motion_events = false;
 static bool is_tty = false;
+static bool show_latency = false;
+static bool show_plugin_stats = false;
+
+/* Devices seen so far, for printing latency stats on exit */
+static struct libinput_device **devices;
+static size_t ndevices_seen;
 
 #define printq(...) ({ if (!be_quiet)  printf(__VA_ARGS__); })
 
@@ -101,13 +107,30 @@ handle_and_print_events(struct libinput *li, const struct libinput_print_options
 		}
 
 		if (type != LIBINPUT_EVENT_TOUCH_FRAME || !compress_motion_events) {
-			_autofree_ char *event_str =
-				libinput_event_to_str(ev, event_repeat_count + 1, opts);
+			char event_buf[1024];
+			_autofree_ char *event_alloc = NULL;
+
+			/* Format now, applying the config below changes the
+			 * device options we print */
+			const char *event_str =
+				libinput_event_format_fallback(ev,
+							       event_repeat_count + 1,
+							       opts,
+							       event_buf,
+							       sizeof(event_buf),
+							       &event_alloc);
 
 			switch (type) {
 			case LIBINPUT_EVENT_DEVICE_ADDED:
 				tools_device_apply_config(libinput_event_get_device(ev),
 							  &options);
+				if (show_latency) {
+					devices = realloc(devices,
+							  (ndevices_seen + 1) *
+								  sizeof(*devices));
+					devices[ndevices_seen++] =
+						libinput_device_ref(device);
+				}
 				break;
 			case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY: {
 				struct libinput_event_tablet_tool *tev =
@@ -138,6 +161,105 @@ handle_and_print_events(struct libinput *li, const struct libinput_print_options
 	return rc;
 }
 
+static void
+print_latency_histogram(struct libinput_device *device,
+			enum libinput_latency_stage stage,
+			const char *name)
+{
+	uint64_t buckets[32] = { 0 };
+	size_t nbuckets =
+		libinput_device_get_latency_histogram(device,
+						      stage,
+						      buckets,
+						      ARRAY_LENGTH(buckets));
+	nbuckets = min(nbuckets, ARRAY_LENGTH(buckets));
+
+	printf("  %-22s", name);
+	for (size_t i = 0; i < nbuckets; i++) {
+		if (buckets[i] == 0)
+			continue;
+
+		if (i == 0)
+			printf(" 0us: %" PRIu64, buckets[i]);
+		else if (i == nbuckets - 1)
+			printf(" >=%" PRIu64 "us: %" PRIu64,
+			       (uint64_t)1 << (i - 1),
+			       buckets[i]);
+		else
+			printf(" %" PRIu64 "-%" PRIu64 "us: %" PRIu64,
+			       (uint64_t)1 << (i - 1),
+			       ((uint64_t)1 << i) - 1,
+			       buckets[i]);
+	}
+	printf("\n");
+}
+
+static void
+print_latency_stats(void)
+{
+	for (size_t i = 0; i < ndevices_seen; i++) {
+		struct libinput_device *device = devices[i];
+
+		printf("%-7s %s latency:\n",
+		       libinput_device_get_sysname(device),
+		       libinput_device_get_name(device));
+		print_latency_histogram(device,
+					LIBINPUT_LATENCY_STAGE_KERNEL_TO_READ,
+					"kernel to read:");
+		print_latency_histogram(device,
+					LIBINPUT_LATENCY_STAGE_READ_TO_PLUGIN_EXIT,
+					"read to plugin exit:");
+		print_latency_histogram(device,
+					LIBINPUT_LATENCY_STAGE_PLUGIN_EXIT_TO_QUEUE,
+					"plugin exit to queue:");
+		print_latency_histogram(device,
+					LIBINPUT_LATENCY_STAGE_QUEUE_TO_GET_EVENT,
+					"queue to get_event:");
+		libinput_device_unref(device);
+	}
+	free(devices);
+	devices = NULL;
+	ndevices_seen = 0;
+}
+
+static void
+print_plugin_stats(struct libinput *li)
+{
+	const char *name;
+
+	printf("Plugin statistics:\n");
+	for (size_t i = 0; (name = libinput_plugin_system_get_plugin_name(li, i)); i++) {
+		uint64_t calls =
+			libinput_plugin_system_get_plugin_stat(li,
+							       i,
+							       LIBINPUT_PLUGIN_STAT_CALLS);
+		/* Built-in plugins are not accounted */
+		if (calls == 0)
+			continue;
+
+		uint64_t total = libinput_plugin_system_get_plugin_stat(
+			li,
+			i,
+			LIBINPUT_PLUGIN_STAT_TIME_TOTAL_US);
+		uint64_t max = libinput_plugin_system_get_plugin_stat(
+			li,
+			i,
+			LIBINPUT_PLUGIN_STAT_TIME_MAX_US);
+		uint64_t overruns = libinput_plugin_system_get_plugin_stat(
+			li,
+			i,
+			LIBINPUT_PLUGIN_STAT_BUDGET_OVERRUNS);
+
+		printf("  %s: %" PRIu64 " calls, %.1fus avg, %" PRIu64
+		       "us max, %" PRIu64 " budget overruns\n",
+		       name,
+		       calls,
+		       (double)total / calls,
+		       max,
+		       overruns);
+	}
+}
+
 static void
 sighandler(int signal, siginfo_t *siginfo, void *userdata)
 {
@@ -215,6 +337,8 @@ main(int argc, char **argv)
 			OPT_SHOW_KEYCODES,
 			OPT_QUIET,
 			OPT_COMPRESS_MOTION_EVENTS,
+			OPT_SHOW_LATENCY,
+			OPT_SHOW_PLUGIN_STATS,
 		};
 		/* clang-format off */
 		static struct option opts[] = {
@@ -227,6 +351,8 @@ main(int argc, char **argv)
 			{ "verbose",                   no_argument,       0, OPT_VERBOSE },
 			{ "quiet",                     no_argument,       0, OPT_QUIET },
 			{ "compress-motion-events",    no_argument,       0, OPT_COMPRESS_MOTION_EVENTS },
+			{ "show-latency",              no_argument,       0, OPT_SHOW_LATENCY },
+			{ "show-plugin-stats",         no_argument,       0, OPT_SHOW_PLUGIN_STATS },
 			{ 0, 0, 0, 0},
 		};
 		/* clang-format on */
@@ -278,6 +404,12 @@ main(int argc, char **argv)
 			/* We compress by using ansi escape sequences */
 			compress_motion_events = is_tty;
 			break;
+		case OPT_SHOW_LATENCY:
+			show_latency = true;
+			break;
+		case OPT_SHOW_PLUGIN_STATS:
+			show_plugin_stats = true;
+			break;
 		default:
 			if (tools_parse_option(c, optarg, &options) != 0) {
 				usage(NULL);
@@ -329,8 +461,15 @@ main(int argc, char **argv)
 	if (!li)
 		return EXIT_FAILURE;
 
+	libinput_set_latency_stats_enabled(li, show_latency);
+
 	mainloop(li);
 
+	if (show_latency)
+		print_latency_stats();
+	if (show_plugin_stats)
+		print_plugin_stats(li);
+
 	libinput_unref(li);
 
 	return EXIT_SUCCESS;
@@ -312,6 +312,18 @@ dwtp_default(struct libinput_device *device)
 	return "disabled";
 }
 
+static const char *
+pointer_prediction_default(struct libinput_device *device)
+{
+	if (!libinput_device_config_pointer_prediction_is_available(device))
+		return "n/a";
+
+	if (libinput_device_config_pointer_prediction_get_default_enabled(device))
+		return "enabled";
+
+	return "disabled";
+}
+
 static char *
 rotation_default(struct libinput_device *device)
 {
@@ -532,6 +544,7 @@ print_device_notify(struct libinput_event *ev)
 
 	print_aligned("Disable-w-typing", "%s", dwt_default(dev));
 	print_aligned("Disable-w-trackpointing", "%s", dwtp_default(dev));
+	print_aligned("Pointer prediction", "%s", pointer_prediction_default(dev));
 
 	str = accel_profiles(dev);
 	print_aligned("Accel profiles", "%s", str);
@@ -33,6 +33,7 @@
 #include <linux/input.h>
 #include <poll.h>
 #include <signal.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <string.h>
 #include <sys/epoll.h>
@@ -793,31 +794,37 @@ print_gesture_event(struct record_device *dev, struct libinput_event *e)
 	}
 }
 
-static char *
-buffer_tablet_axes(struct libinput_event_tablet_tool *t)
+LIBINPUT_ATTRIBUTE_PRINTF(3, 4)
+static void
+buffer_append(char *buf, size_t size, const char *format, ...)
+{
+	size_t len = strlen(buf);
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(buf + len, size - len, format, args);
+	va_end(args);
+}
+
+/* Write the axes as comma-separated list into buf, truncated to size */
+static void
+buffer_tablet_axes(struct libinput_event_tablet_tool *t,
+		   char *buf,
+		   size_t size)
 {
-	const int MAX_AXES = 10;
 	struct libinput_tablet_tool *tool;
-	int idx = 0;
-	int len;
 	double x, y;
 
 	tool = libinput_event_tablet_tool_get_tool(t);
 
-	_autostrvfree_ char **strv = zalloc(MAX_AXES * sizeof *strv);
-
 	x = libinput_event_tablet_tool_get_x(t);
 	y = libinput_event_tablet_tool_get_y(t);
-	len = xasprintf(&strv[idx++], "point: [%.2f, %.2f]", x, y);
-	if (len <= 0)
-		return NULL;
+	snprintf(buf, size, "point: [%.2f, %.2f]", x, y);
 
 	if (libinput_tablet_tool_has_tilt(tool)) {
 		x = libinput_event_tablet_tool_get_tilt_x(t);
 		y = libinput_event_tablet_tool_get_tilt_y(t);
-		len = xasprintf(&strv[idx++], "tilt: [%.2f, %.2f]", x, y);
-		if (len <= 0)
-			return NULL;
+		buffer_append(buf, size, ", tilt: [%.2f, %.2f]", x, y);
 	}
 
 	if (libinput_tablet_tool_has_distance(tool) ||
@@ -827,29 +834,23 @@ buffer_tablet_axes(struct libinput_event_tablet_tool *t)
 		dist = libinput_event_tablet_tool_get_distance(t);
 		pressure = libinput_event_tablet_tool_get_pressure(t);
 		if (dist)
-			len = xasprintf(&strv[idx++], "distance: %.2f", dist);
+			buffer_append(buf, size, ", distance: %.2f", dist);
 		else
-			len = xasprintf(&strv[idx++], "pressure: %.2f", pressure);
-		if (len <= 0)
-			return NULL;
+			buffer_append(buf, size, ", pressure: %.2f", pressure);
 	}
 
 	if (libinput_tablet_tool_has_rotation(tool)) {
 		double rotation;
 
 		rotation = libinput_event_tablet_tool_get_rotation(t);
-		len = xasprintf(&strv[idx++], "rotation: %.2f", rotation);
-		if (len <= 0)
-			return NULL;
+		buffer_append(buf, size, ", rotation: %.2f", rotation);
 	}
 
 	if (libinput_tablet_tool_has_slider(tool)) {
 		double slider;
 
 		slider = libinput_event_tablet_tool_get_slider_position(t);
-		len = xasprintf(&strv[idx++], "slider: %.2f", slider);
-		if (len <= 0)
-			return NULL;
+		buffer_append(buf, size, ", slider: %.2f", slider);
 	}
 
 	if (libinput_tablet_tool_has_wheel(tool)) {
@@ -857,19 +858,11 @@ buffer_tablet_axes(struct libinput_event_tablet_tool *t)
 		int delta;
 
 		wheel = libinput_event_tablet_tool_get_wheel_delta(t);
-		len = xasprintf(&strv[idx++], "wheel: %.2f", wheel);
-		if (len <= 0)
-			return NULL;
+		buffer_append(buf, size, ", wheel: %.2f", wheel);
 
 		delta = libinput_event_tablet_tool_get_wheel_delta_discrete(t);
-		len = xasprintf(&strv[idx++], "wheel-discrete: %d", delta);
-		if (len <= 0)
-			return NULL;
+		buffer_append(buf, size, ", wheel-discrete: %d", delta);
 	}
-
-	assert(idx < MAX_AXES);
-
-	return strv_join(strv, ", ");
 }
 
 static void
@@ -920,7 +913,9 @@ print_tablet_tool_proximity_event(struct record_device *dev, struct libinput_eve
 
 	prox = libinput_event_tablet_tool_get_proximity_state(t);
 	time = time_offset(dev->ctx, libinput_event_tablet_tool_get_time_usec(t));
-	_autofree_ char *axes = buffer_tablet_axes(t);
+	char axes[256];
+
+	buffer_tablet_axes(t, axes, sizeof(axes));
 
 	idx = 0;
 	if (libinput_tablet_tool_has_pressure(tool))
@@ -1020,7 +1015,9 @@ print_tablet_tool_event(struct record_device *dev, struct libinput_event *e)
 
 	tip = libinput_event_tablet_tool_get_tip_state(t);
 	time = time_offset(dev->ctx, libinput_event_tablet_tool_get_time_usec(t));
-	_autofree_ char *axes = buffer_tablet_axes(t);
+	char axes[256];
+
+	buffer_tablet_axes(t, axes, sizeof(axes));
 
 	iprintf(dev->fp,
 		I_EVENT,
@@ -124,6 +124,7 @@ tools_init_options(struct tools_options *options)
 	options->middlebutton = -1;
 	options->dwt = -1;
 	options->dwtp = -1;
+	options->pointer_prediction = -1;
 	options->click_method = -1;
 	options->scroll_method = -1;
 	options->scroll_button = -1;
@@ -235,6 +236,14 @@ tools_parse_option(int option, const char *optarg, struct tools_options *options
 	case OPT_DWTP_DISABLE:
 		options->dwtp = LIBINPUT_CONFIG_DWTP_DISABLED;
 		break;
+	case OPT_POINTER_PREDICTION_ENABLE:
+		options->pointer_prediction =
+			LIBINPUT_CONFIG_POINTER_PREDICTION_ENABLED;
+		break;
+	case OPT_POINTER_PREDICTION_DISABLE:
+		options->pointer_prediction =
+			LIBINPUT_CONFIG_POINTER_PREDICTION_DISABLED;
+		break;
 	case OPT_CLICK_METHOD:
 		if (!optarg)
 			return 1;
@@ -699,6 +708,11 @@ tools_device_apply_config(struct libinput_device *device, struct tools_options *
 	if (options->dwtp != -1)
 		libinput_device_config_dwtp_set_enabled(device, options->dwtp);
 
+	if (options->pointer_prediction != -1)
+		libinput_device_config_pointer_prediction_set_enabled(
+			device,
+			options->pointer_prediction);
+
 	if (options->click_method != (enum libinput_config_click_method) - 1)
 		libinput_device_config_click_set_method(device, options->click_method);
 
@@ -1015,6 +1029,7 @@ tools_list_device_quirks(struct quirks_context *ctx,
 			case QUIRK_ATTR_PALM_PRESSURE_THRESHOLD:
 			case QUIRK_ATTR_THUMB_PRESSURE_THRESHOLD:
 			case QUIRK_ATTR_THUMB_SIZE_THRESHOLD:
+			case QUIRK_ATTR_TOUCHPAD_HISTORY_LENGTH:
 				quirks_get_uint32(quirks, q, &v);
 				snprintf(buf, sizeof(buf), "%s=%u", name, v);
 				callback(userdata, buf);
@@ -56,6 +56,8 @@ enum configuration_options {
 	OPT_DWT_DISABLE,
 	OPT_DWTP_ENABLE,
 	OPT_DWTP_DISABLE,
+	OPT_POINTER_PREDICTION_ENABLE,
+	OPT_POINTER_PREDICTION_DISABLE,
 	OPT_CLICK_METHOD,
 	OPT_CLICKFINGER_MAP,
 	OPT_SCROLL_METHOD,
@@ -102,6 +104,8 @@ enum configuration_options {
 	{ "disable-dwt",               no_argument,       0, OPT_DWT_DISABLE }, \
 	{ "enable-dwtp",               no_argument,       0, OPT_DWTP_ENABLE }, \
 	{ "disable-dwtp",              no_argument,       0, OPT_DWTP_DISABLE }, \
+	{ "enable-pointer-prediction", no_argument,       0, OPT_POINTER_PREDICTION_ENABLE }, \
+	{ "disable-pointer-prediction",no_argument,       0, OPT_POINTER_PREDICTION_DISABLE }, \
 	{ "enable-scroll-button-lock", no_argument,       0, OPT_SCROLL_BUTTON_LOCK_ENABLE }, \
 	{ "disable-scroll-button-lock",no_argument,       0, OPT_SCROLL_BUTTON_LOCK_DISABLE }, \
 	{ "enable-3fg-drag",           required_argument, 0, OPT_3FG_DRAG }, \
@@ -168,6 +172,7 @@ struct tools_options {
 	double speed;
 	int dwt;
 	int dwtp;
+	int pointer_prediction;
 	enum libinput_config_accel_profile profile;
 	char disable_pattern[64];
 	enum libinput_config_accel_type custom_type;
@@ -211,6 +211,7 @@ options = {
         "left-handed",
         "dwt",
         "dwtp",
+        "pointer-prediction",
     ],
     # options with distinct values
     "enums": {